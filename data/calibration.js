@@ -75,6 +75,54 @@ WSManager.on('onRawMessage', function(data) {
     } else if (data.startsWith('CALIBRATION_COMPLETE')) {
         stopCalibration();
         updateStatus('Calibration complete!');
+    } else if (data.startsWith('CALIBRATION_FIT:')) {
+        // kind,mapping,degree,points,rms,max,r2,coeffs... or kind,mapping,failed
+        const parts = data.substring(16).split(',');
+        if (parts[2] === 'failed') {
+            updateStatus(`On-device ${parts[0]} ${parts[1]} fit failed`);
+        } else {
+            const coeffs = parts.slice(7).map(parseFloat);
+            console.log(`On-device ${parts[0]} ${parts[1]} fit (degree ${parts[2]}, ${parts[3]} points):`, coeffs);
+            updateStatus(`${parts[0]} ${parts[1]} fit: degree ${parts[2]}, RMS ${parts[4]}, R² ${parts[6]}`);
+        }
+    } else if (data.startsWith('AUTOTUNE_PROGRESS:')) {
+        const parts = data.substring(18).split(',');
+        updateAutotuneStatus(`Relay ${parts[0]}: cycle ${parts[1]}/${parts[2]}`);
+    } else if (data.startsWith('AUTOTUNE_RESULT:')) {
+        // wheel,ok|failed,Ku,Tu,amplitude,kp,ki,kd
+        const parts = data.substring(16).split(',');
+        console.log(`Relay auto-tune ${parts[0]} (${parts[1]}): Ku=${parts[2]} Tu=${parts[3]}s a=${parts[4]} cm/s`);
+    } else if (data.startsWith('AUTOTUNE_COMPLETE:')) {
+        const parts = data.substring(18).split(',');
+        autotuneData.kp = parseFloat(parts[1]);
+        autotuneData.ki = parseFloat(parts[2]);
+        autotuneData.kd = parseFloat(parts[3]);
+        finishRelayAutotune(`Relay auto-tune complete (${parts[0]})`);
+        document.getElementById('autotuneResultsContent').innerHTML =
+            `Rule: ${parts[0]}<br>Kp: ${autotuneData.kp.toFixed(3)}<br>` +
+            `Ki: ${autotuneData.ki.toFixed(3)}<br>Kd: ${autotuneData.kd.toFixed(4)}`;
+        document.getElementById('autotuneResults').style.display = 'block';
+    } else if (data.startsWith('AUTOTUNE_FAILED')) {
+        finishRelayAutotune('Relay auto-tune failed: no clean limit cycle (try a larger amplitude or hysteresis)');
+    } else if (data.startsWith('SYSID_PROGRESS:')) {
+        const parts = data.substring(15).split(',');
+        updateSysIdStatus(`Capturing... ${parts[0]}/${parts[1]} samples`);
+    } else if (data.startsWith('SYSID_FIT:')) {
+        // wheel,ok,gain,tau,deadTime,offset,fitPercent or wheel,failed
+        const parts = data.substring(10).split(',');
+        const line = parts[1] === 'ok'
+            ? `${parts[0]}: K=${parts[2]} cm/s per PWM, tau=${(parseFloat(parts[3]) * 1000).toFixed(1)} ms, ` +
+              `L=${(parseFloat(parts[4]) * 1000).toFixed(1)} ms, fit ${parts[6]}%`
+            : `${parts[0]}: fit failed`;
+        document.getElementById('sysidResults').innerHTML += line + '<br>';
+    } else if (data.startsWith('SYSID_CAPTURE:')) {
+        const parts = data.substring(14).split(',');
+        sysIdCapture = {samples: new Array(parseInt(parts[0])), chunks: parseInt(parts[1]), received: 0,
+                        rateHz: parseFloat(parts[2])};
+        updateSysIdStatus(`Receiving ${parts[0]} samples...`);
+    } else if (data.startsWith('SYSID_COMPLETE')) {
+        finishSystemId(`Capture complete (${sysIdCapture ? sysIdCapture.received : 0} chunks)`);
+        document.getElementById('downloadSysId').disabled = !sysIdCapture;
     } else if (data.startsWith('CALIBRATION_PROGRESS:')) {
         const progress = data.substring(21);
         updateStatus(`Calibrating... ${progress}`);
@@ -293,6 +341,109 @@ function stopPIDAutotune() {
     updateAutotuneStatus('Autotuning stopped');
 }
 
+function startRelayAutotune() {
+    const targetVel = parseFloat(document.getElementById('autotune-velocity').value);
+    const motor = document.getElementById('autotune-motor').value;
+    const amplitude = parseFloat(document.getElementById('relay-amplitude').value);
+    const hysteresis = parseFloat(document.getElementById('relay-hysteresis').value) || 0;
+    const rule = document.getElementById('relay-rule').value;
+    const autoSave = document.getElementById('relay-autosave').checked;
+    
+    document.getElementById('startRelayTune').disabled = true;
+    document.getElementById('stopRelayTune').disabled = false;
+    document.getElementById('autotuneResults').style.display = 'none';
+    updateAutotuneStatus('Starting relay auto-tune...');
+    
+    WSManager.send(`START_AUTOTUNE:${motor},${targetVel},${amplitude},${hysteresis},6,${rule},${autoSave}`);
+}
+
+function stopRelayAutotune() {
+    WSManager.send('STOP_AUTOTUNE');
+    finishRelayAutotune('Relay auto-tune stopped');
+}
+
+function finishRelayAutotune(message) {
+    document.getElementById('startRelayTune').disabled = false;
+    document.getElementById('stopRelayTune').disabled = true;
+    updateAutotuneStatus(message);
+}
+
+// System identification capture: "SYID" chunks of {timeUs u32, leftPWM i16, rightPWM i16, leftVel i16, rightVel i16}
+let sysIdCapture = null;
+
+WSManager.on('onBinaryMessage', function(buffer) {
+    const view = new DataView(buffer);
+    if (!sysIdCapture || buffer.byteLength < 14 ||
+        String.fromCharCode(view.getUint8(0), view.getUint8(1), view.getUint8(2), view.getUint8(3)) !== 'SYID') {
+        return;
+    }
+    
+    const firstSample = view.getUint32(8, true);
+    const sampleCount = view.getUint16(12, true);
+    for (let i = 0; i < sampleCount; i++) {
+        const offset = 14 + i * 12;
+        sysIdCapture.samples[firstSample + i] = {
+            timeUs: view.getUint32(offset, true),
+            leftPWM: view.getInt16(offset + 4, true),
+            rightPWM: view.getInt16(offset + 6, true),
+            leftVel: view.getInt16(offset + 8, true) / 100,
+            rightVel: view.getInt16(offset + 10, true) / 100
+        };
+    }
+    sysIdCapture.received++;
+    updateSysIdStatus(`Receiving... chunk ${sysIdCapture.received}/${sysIdCapture.chunks}`);
+});
+
+function startSystemId() {
+    const motor = document.getElementById('sysid-motor').value;
+    const type = document.getElementById('sysid-type').value;
+    const bias = parseInt(document.getElementById('sysid-bias').value);
+    const amplitude = parseInt(document.getElementById('sysid-amplitude').value);
+    const duration = parseFloat(document.getElementById('sysid-duration').value);
+    
+    sysIdCapture = null;
+    document.getElementById('sysidResults').innerHTML = '';
+    document.getElementById('startSysId').disabled = true;
+    document.getElementById('stopSysId').disabled = false;
+    document.getElementById('downloadSysId').disabled = true;
+    updateSysIdStatus('Lead-in at bias PWM...');
+    
+    WSManager.send(`START_SYSID:${motor},${type},${bias},${amplitude},${duration}`);
+}
+
+function stopSystemId() {
+    WSManager.send('STOP_SYSID');
+    finishSystemId('Stopped');
+}
+
+function finishSystemId(message) {
+    document.getElementById('startSysId').disabled = false;
+    document.getElementById('stopSysId').disabled = true;
+    updateSysIdStatus(message);
+}
+
+function updateSysIdStatus(message) {
+    document.getElementById('sysidStatus').textContent = 'Status: ' + message;
+}
+
+function downloadSystemId() {
+    if (!sysIdCapture) return;
+    
+    let csv = 'time_s,left_pwm,right_pwm,left_velocity,right_velocity\n';
+    sysIdCapture.samples.forEach(sample => {
+        if (!sample) return;
+        csv += `${(sample.timeUs / 1e6).toFixed(6)},${sample.leftPWM},${sample.rightPWM},${sample.leftVel},${sample.rightVel}\n`;
+    });
+    
+    const blob = new Blob([csv], {type: 'text/csv'});
+    const url = URL.createObjectURL(blob);
+    const link = document.createElement('a');
+    link.href = url;
+    link.download = 'sysid_capture.csv';
+    link.click();
+    URL.revokeObjectURL(url);
+}
+
 function updateAutotuneStatus(message) {
     document.getElementById('autotuneStatus').textContent = 'Status: ' + message;
 }
@@ -491,6 +642,9 @@ function startCalibration(motor) {
     const endPWM = parseInt(document.getElementById('endPWM').value);
     const stepSize = parseInt(document.getElementById('stepSize').value);
     const holdTime = parseInt(document.getElementById('holdTime').value);
+    const minHoldTime = parseInt(document.getElementById('minHoldTime').value) || 0;
+    const steadyTolerance = parseFloat(document.getElementById('steadyTolerance').value) || 0;
+    const bidirectional = document.getElementById('bidirectional').checked;
     
     calibrationRunning = true;
     currentMotor = motor;
@@ -509,7 +663,7 @@ function startCalibration(motor) {
     updateStatus(`Starting ${motor} motor calibration...`);
     
     // Send start command
-    WSManager.send(`START_CALIBRATION:${motor},${startPWM},${endPWM},${stepSize},${holdTime}`);
+    WSManager.send(`START_CALIBRATION:${motor},${startPWM},${endPWM},${stepSize},${holdTime},0,false,${minHoldTime},${steadyTolerance},${bidirectional}`);
 }
 
 function stopCalibration() {
@@ -821,7 +975,10 @@ function saveConfigToRobot() {
         pidKp: parseFloat(document.getElementById('config_pidKp').value) || 0.0,
         pidKi: parseFloat(document.getElementById('config_pidKi').value) || 0.0,
         pidKd: parseFloat(document.getElementById('config_pidKd').value) || 0.0,
+        voltageCompensationEnabled: document.getElementById('config_voltageCompensationEnabled').checked,
+        nominalVoltage: parseFloat(document.getElementById('config_nominalVoltage').value) || 11.1,
         polynomialEnabled: document.getElementById('config_polynomialEnabled').checked,
+        lookupTableEnabled: document.getElementById('config_lookupTableEnabled').checked,
         vel2pwm_a0: parseFloat(document.getElementById('config_vel2pwm_a0').value) || 0.0,
         vel2pwm_a1: parseFloat(document.getElementById('config_vel2pwm_a1').value) || 1.0,
         vel2pwm_a2: parseFloat(document.getElementById('config_vel2pwm_a2').value) || 0.0,
@@ -864,7 +1021,10 @@ function populateConfigForm(config) {
     document.getElementById('config_pidKp').value = config.pidKp || 0.0;
     document.getElementById('config_pidKi').value = config.pidKi || 0.0;
     document.getElementById('config_pidKd').value = config.pidKd || 0.0;
+    document.getElementById('config_voltageCompensationEnabled').checked = config.voltageCompensationEnabled || false;
+    document.getElementById('config_nominalVoltage').value = config.nominalVoltage || 11.1;
     document.getElementById('config_polynomialEnabled').checked = config.polynomialEnabled || false;
+    document.getElementById('config_lookupTableEnabled').checked = config.lookupTableEnabled || false;
     document.getElementById('config_vel2pwm_a0').value = config.vel2pwm_a0 || 0.0;
     document.getElementById('config_vel2pwm_a1').value = config.vel2pwm_a1 || 1.0;
     document.getElementById('config_vel2pwm_a2').value = config.vel2pwm_a2 || 0.0;
@@ -14,14 +14,17 @@ const WSManager = (function() {
         onControlChange: [],
         onEncoderData: [],
         onBatteryData: [],
+        onBatteryStatus: [],
         onMotorData: [],
         onStatusChange: [],
-        onRawMessage: []
+        onRawMessage: [],
+        onBinaryMessage: []
     };
     
     function connect() {
         const wsUrl = 'ws://' + window.location.hostname + '/ws';
         ws = new WebSocket(wsUrl);
+        ws.binaryType = 'arraybuffer';
         
         ws.onopen = function() {
             console.log('WebSocket connected');
@@ -32,6 +35,11 @@ const WSManager = (function() {
         ws.onmessage = function(event) {
             const rawData = event.data;
             
+            if (rawData instanceof ArrayBuffer) {
+                notifyBinaryMessage(rawData);
+                return;
+            }
+            
             // Try JSON first
             try {
                 const data = JSON.parse(rawData);
@@ -43,6 +51,9 @@ const WSManager = (function() {
                 else if (data.type === 'control') {
                     updateControlStatus(data.controllingClientId);
                 }
+                else if (data.type === 'battery') {
+                    notifyBatteryStatus(data.low, data.voltage, data.soc);
+                }
                 else if (data.type === 'log') {
                     addLogToConsole(data.message, data.logType);
                     saveLogToStorage(data.message);
@@ -50,7 +61,7 @@ const WSManager = (function() {
                 else if (data.left && data.right) {
                     notifyEncoderData(data);
                     if (data.battery !== undefined) {
-                        notifyBatteryData(data.battery);
+                        notifyBatteryData(data.battery, data.batterySoc);
                     }
                     if (data.motorLeft !== undefined || data.motorRight !== undefined) {
                         notifyMotorData(data.motorLeft, data.motorRight);
@@ -144,8 +155,12 @@ const WSManager = (function() {
         callbacks.onEncoderData.forEach(cb => cb(data));
     }
     
-    function notifyBatteryData(voltage) {
-        callbacks.onBatteryData.forEach(cb => cb(voltage));
+    function notifyBatteryData(voltage, soc) {
+        callbacks.onBatteryData.forEach(cb => cb(voltage, soc));
+    }
+    
+    function notifyBatteryStatus(low, voltage, soc) {
+        callbacks.onBatteryStatus.forEach(cb => cb(low, voltage, soc));
     }
     
     function notifyMotorData(left, right) {
@@ -160,6 +175,10 @@ const WSManager = (function() {
         callbacks.onRawMessage.forEach(cb => cb(message));
     }
     
+    function notifyBinaryMessage(buffer) {
+        callbacks.onBinaryMessage.forEach(cb => cb(buffer));
+    }
+    
     // Public API
     return {
         connect: connect,
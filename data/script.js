@@ -26,12 +26,30 @@ WSManager.on('onEncoderData', function(data) {
     document.getElementById('right-dist').textContent = data.right.distance + ' cm';
     document.getElementById('right-vel').textContent = data.right.velocity + ' cm/s';
     document.getElementById('right-rpm').textContent = data.right.rpm;
+    
+    if (data.pose) {
+        document.getElementById('pose-xy').textContent = `${data.pose.x.toFixed(2)}, ${data.pose.y.toFixed(2)} cm`;
+        document.getElementById('pose-theta').textContent = (data.pose.theta * 180 / Math.PI).toFixed(1) + '°';
+        document.getElementById('pose-twist').textContent = `${data.pose.v.toFixed(2)} cm/s, ${data.pose.omega.toFixed(2)} rad/s`;
+        document.getElementById('pose-sigma').textContent = Math.sqrt(data.pose.varX + data.pose.varY).toFixed(2) + ' cm';
+        document.getElementById('pose-bias').textContent = data.pose.gyro
+            ? `${(data.pose.gyroBias * 180 / Math.PI).toFixed(3)} °/s (${data.pose.slips} slips)`
+            : 'no gyro';
+    }
+    if (data.odometry) {
+        document.getElementById('odometry-pose').textContent =
+            `${data.odometry.x.toFixed(2)}, ${data.odometry.y.toFixed(2)} cm, ${(data.odometry.theta * 180 / Math.PI).toFixed(1)}° ` +
+            `(±${Math.sqrt(data.odometry.varX + data.odometry.varY).toFixed(2)} cm)`;
+    }
 });
 
-WSManager.on('onBatteryData', function(voltage) {
+WSManager.on('onBatteryData', function(voltage, soc) {
     const batteryVoltage = voltage.toFixed(2);
     const batteryElement = document.getElementById('battery-voltage');
     batteryElement.textContent = batteryVoltage + ' V';
+    if (soc !== undefined) {
+        document.getElementById('battery-soc').textContent = '(' + Math.round(soc) + '%)';
+    }
     
     // Color code based on voltage (assuming 3S LiPo: 9V-12.6V)
     if (voltage >= 11.1) {
@@ -43,6 +61,13 @@ WSManager.on('onBatteryData', function(voltage) {
     }
 });
 
+WSManager.on('onBatteryStatus', function(low, voltage, soc) {
+    document.getElementById('battery-soc').style.color = low ? '#f44336' : '';
+    if (low) {
+        console.warn(`Battery low: ${voltage.toFixed(2)} V (${Math.round(soc)}%)`);
+    }
+});
+
 WSManager.on('onMotorData', function(left, right) {
     if (left !== undefined) {
         document.getElementById('motor-left').textContent = left;
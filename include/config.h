@@ -15,8 +15,64 @@
 #define RIGHT_ENCODER_A 4
 #define RIGHT_ENCODER_B 5
 
+#define ENCODER_COUNT 2          // encoder ISR slots; one trampoline is generated per slot
+#define LEFT_ENCODER_INDEX 0
+#define RIGHT_ENCODER_INDEX 1
+
 #define ENCODER_PPR 960  // 240 PPR × 4 (quadrature) = 960 counts per revolution
 #define WHEEL_DIAMETER 5 // in cm
+#define TRACK_WIDTH 13.0f // cm, between the wheel contact centres
+#define ODOMETRY_WHEEL_NOISE 0.01f  // cm^2 of variance per cm travelled by each wheel
+
+// Encoder + gyro pose EKF
+#define POSE_UPDATE_MS 10
+#define POSE_WHEEL_NOISE 0.001f            // cm^2 per cm per wheel; turning scrub is carried by the track width term
+#define POSE_TRACK_WIDTH_UNCERTAINTY 0.5f  // scrub is systematic, so well above the real track width error
+#define POSE_GYRO_NOISE 1e-7f              // rad^2/s
+#define POSE_GYRO_BIAS_DRIFT 1e-7f         // (rad/s)^2/s
+#define POSE_GYRO_BIAS_SIGMA 0.02f         // rad/s left after the startup calibration
+#define POSE_YAW_GATE 9.0f                 // 3 sigma on the encoder yaw innovation
+#define IMU_YAW_SIGN 1.0f                  // -1 if the MPU6050 is mounted upside down (flipped about its X axis)
+
+#define ENCODER_USE_PCNT 0       // 1 = hardware pulse counter (PCNT), 0 = GPIO edge interrupts
+#define ENCODER_PCNT_FILTER 100  // PCNT glitch filter in APB cycles (12.5 ns each, max 1023)
+#define ENCODER_EDGE_TIMED_VELOCITY 1  // 1 = edge-timestamp velocity every update, 0 = 100 ms count window
+#define ENCODER_EDGE_BUFFER_SIZE 256   // ISR edge records per encoder (power of two)
+
+// Control loop (network, OTA and web UI stay on core 0)
+#define CONTROL_LOOP_RATE_HZ 500
+#define CONTROL_TASK_CORE 1
+#define CONTROL_TASK_PRIORITY 10
+#define VELOCITY_LUT_MAX 100.0f  // cm/s, upper end of the velocity->PWM lookup table
+
+// Motion profiles for autonomous distances and turns (jerk 0 = trapezoid)
+#define MOTION_MAX_ACCELERATION 40.0f           // cm/s^2
+#define MOTION_MAX_JERK 200.0f                  // cm/s^3
+#define MOTION_MAX_ANGULAR_ACCELERATION 180.0f  // deg/s^2
+#define MOTION_MAX_ANGULAR_JERK 900.0f          // deg/s^3
+#define MOTION_POSITION_GAIN 4.0f               // 1/s, profile position error to velocity
+#define MOTION_CATCH_UP_MARGIN 1.2f             // command limit over the profile's peak velocity
+#define MOTION_DISTANCE_TOLERANCE 0.5f          // cm
+#define MOTION_ANGLE_TOLERANCE 1.0f             // deg
+#define MOTION_SETTLE_TIMEOUT_MS 1000           // after the profile ends, then the step finishes regardless
+
+// Battery voltage compensation of the velocity feedforward
+#define VOLTAGE_COMP_NOMINAL 11.1f       // V the feedforward maps were calibrated at (3S LiPo)
+#define VOLTAGE_COMP_SAMPLE_MS 100       // supply sample period, taken outside the control task
+#define VOLTAGE_COMP_MIN_VOLTAGE 5.0f    // below this no pack is assumed (USB power) and no scaling is applied
+#define VOLTAGE_COMP_MAX_SCALE 1.5f
+
+// Online PWM->velocity identification (per wheel, recursive least squares)
+#define ONLINE_ID_DEFAULT_ENABLED false
+#define ONLINE_ID_FORGETTING_FACTOR 0.998f  // per sample (10 Hz), ~50 s memory
+#define ONLINE_ID_MIN_SAMPLES 100
+#define ONLINE_ID_MAX_COVARIANCE 5.0f       // trace of the RLS covariance in centred-PWM units
+#define ONLINE_ID_MAX_RESIDUAL 3.0f         // cm/s RMS prediction error
+
+// System identification capture (SystemIdCommand)
+#define SYSTEM_ID_MAX_SAMPLES 8000      // 12 bytes each, 16 s at the control rate
+#define SYSTEM_ID_LEAD_IN_MS 1000       // held at the bias PWM before capture starts
+#define SYSTEM_ID_MAX_DELAY_MS 100      // longest dead time the FOPDT fit searches
 
 // Motor Driver Configuration (L298N)
 // Left Motor
@@ -36,10 +92,58 @@
 
 #define IMU_SCL 41
 #define IMU_SDA 40
+#define IMU_I2C_CLOCK_HZ 400000
+#define IMU_INT 16     // MPU6050 INT (data ready)
+
+#define IMU_TASK_CORE 0
+#define IMU_TASK_PRIORITY 2
+#define IMU_DATA_READY_TIMEOUT_MS 20  // the task polls at this period if no data-ready edge arrives
+
+// IMU sampling: the MPU6050 fills its FIFO at a fixed rate and update() reads it in bursts
+#define IMU_SAMPLE_RATE_HZ 200               // 1 kHz / (1 + divider) with the DLPF on
+#define IMU_FIFO_BURST_SAMPLES 10            // 12 bytes each; one I2C read fits the 128 byte Wire buffer
+#define IMU_DRAIN_SAMPLES 4                  // data-ready edges per FIFO drain; adds up to 3 sample periods of latency
+#define IMU_RATE_ESTIMATE_MIN_US 2000000     // FIFO time before the measured sample period replaces the nominal one
+
+// IMU calibration (counted in FIFO samples)
+#define IMU_CALIBRATION_SAMPLES 500
+#define IMU_CALIBRATION_PATH "/imu_cal.json"
+#define IMU_CALIBRATION_TEMP_TOLERANCE 3.0f  // °C between the stored and current die temperature
+#define IMU_STILL_WINDOW 50                  // samples per stillness check
+#define IMU_STILL_GYRO_RANGE 1.0f            // °/s peak-to-peak within a still window
+#define IMU_STILL_ACCEL_RANGE 0.3f           // m/s^2 peak-to-peak per axis within a still window
+#define IMU_STILL_WHEEL_VELOCITY 0.5f        // cm/s; faster wheels void the window
+#define IMU_BIAS_FORGETTING 0.998f           // per still window in the gyro bias vs. temperature fit
+#define IMU_BIAS_SLOPE_PRIOR 50.0f           // still windows x °C^2 of spread before the fitted slope moves off the stored one
+#define IMU_BIAS_SLOPE_LIMIT 0.25f           // °/s per °C
+#define IMU_BIAS_SAVE_DELTA 0.05f            // °/s of bias change before the refined bias is stored again
+#define IMU_BIAS_SAVE_INTERVAL_MS 60000
+#define IMU_TEMPERATURE_INTERVAL_MS 1000
+
+// IMU attitude (Mahony filter)
+#define IMU_ATTITUDE_KP 1.0f                 // rad/s per unit gravity direction error
+#define IMU_ATTITUDE_KI 0.02f
+#define IMU_ATTITUDE_INTEGRAL_LIMIT 0.05f    // rad/s
+#define IMU_ATTITUDE_ACCEL_TOLERANCE 0.15f   // g; the accelerometer only corrects tilt within 1 +/- this
+
+// Tip-over cutoff: tilt beyond IMU_TIP_ANGLE for IMU_TIP_HOLD_MS inhibits the motors until back within IMU_TIP_RECOVER_ANGLE
+#define IMU_TIP_CUTOFF_ENABLED true
+#define IMU_TIP_ANGLE 60.0f                  // degrees from upright
+#define IMU_TIP_RECOVER_ANGLE 30.0f
+#define IMU_TIP_HOLD_MS 200
 
 // Battery Voltage Reader
 #define BATTERY_VOLTAGE_PIN 9    // ADC1 pin (GPIO 1-10 work with WiFi on ESP32-S3)
 #define BATTERY_VOLTAGE_MULTIPLIER 6.1  // 6.1/1 voltage divider ratio
+#define BATTERY_CELL_COUNT 3
+#define BATTERY_ADC_SAMPLE_HZ 20000     // continuous ADC conversion rate
+#define BATTERY_OVERSAMPLE 64           // conversions per median block (~312 blocks/s)
+#define BATTERY_FILTER_TIME_CONSTANT 0.5f  // s, IIR on the block medians
+#define BATTERY_PRESENT_VOLTAGE 5.0f    // below this the board is assumed to be on USB power
+#define BATTERY_LOW_CELL_VOLTAGE 3.5f
+#define BATTERY_LOW_HYSTERESIS 0.1f     // V per cell
+#define BATTERY_TASK_CORE 0
+#define BATTERY_TASK_PRIORITY 2
 
 #define WEB_SERVER_PORT 80
 
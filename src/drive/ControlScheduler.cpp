@@ -0,0 +1,100 @@
+#include "ControlScheduler.h"
+#include "../network/Telemetry.h"
+
+ControlScheduler::ControlScheduler(uint32_t rateHz, int core, UBaseType_t priority)
+    : periodUs(1000000UL / rateHz), core(core), priority(priority),
+      tickCallback(nullptr), startCallback(nullptr),
+      taskHandle(nullptr), startedSemaphore(nullptr), running(false),
+      stats(), resetRequested(false) {
+    stats.rateHz = rateHz;
+    published.write(stats);
+}
+
+bool ControlScheduler::begin(TickCallback onTick, StartCallback onStart) {
+    if (running || !onTick) return false;
+
+    if (periodUs % (portTICK_PERIOD_MS * 1000UL) != 0) {
+        TELEM_LOGF_ERROR("Control period %u us is not a whole number of %u ms RTOS ticks", periodUs, portTICK_PERIOD_MS);
+        return false;
+    }
+
+    tickCallback = onTick;
+    startCallback = onStart;
+
+    startedSemaphore = xSemaphoreCreateBinary();
+    if (xTaskCreatePinnedToCore(taskEntry, "control", 4096, this, priority, &taskHandle, core) != pdPASS) {
+        TELEM_LOG_ERROR("Control task creation failed");
+        return false;
+    }
+
+    xSemaphoreTake(startedSemaphore, portMAX_DELAY);
+    vSemaphoreDelete(startedSemaphore);
+    startedSemaphore = nullptr;
+
+    TELEM_LOGF_SUCCESS("Control loop running at %u Hz on core %d", stats.rateHz, core);
+    return true;
+}
+
+void ControlScheduler::resetStats() {
+    resetRequested = true;
+}
+
+void ControlScheduler::taskEntry(void* arg) {
+    static_cast<ControlScheduler*>(arg)->run();
+}
+
+void ControlScheduler::run() {
+    if (startCallback) {
+        startCallback();
+    }
+
+    running = true;
+    xSemaphoreGive(startedSemaphore);
+
+    const TickType_t periodTicks = pdMS_TO_TICKS(periodUs / 1000);
+    TickType_t wakeTick = xTaskGetTickCount();
+    uint32_t lastWakeUs = micros();
+
+    for (;;) {
+        uint32_t pendingTicks = 1;
+        if (xTaskDelayUntil(&wakeTick, periodTicks) == pdFALSE) {
+            // The deadline passed while the previous tick ran; count the missed periods and resync instead of catching up
+            TickType_t now = xTaskGetTickCount();
+            pendingTicks += (now - wakeTick) / periodTicks;
+            wakeTick = now;
+        }
+        uint32_t wakeUs = micros();
+
+        tickCallback((wakeUs - lastWakeUs) * 1e-6f);
+
+        recordTick(wakeUs, lastWakeUs, micros() - wakeUs, pendingTicks);
+        lastWakeUs = wakeUs;
+    }
+}
+
+void ControlScheduler::recordTick(uint32_t wakeUs, uint32_t lastWakeUs, uint32_t execUs, uint32_t pendingTicks) {
+    if (resetRequested) {
+        uint32_t rateHz = stats.rateHz;
+        stats = Stats();
+        stats.rateHz = rateHz;
+        resetRequested = false;
+    }
+
+    stats.ticks++;
+    stats.lastExecUs = execUs;
+    if (execUs > stats.maxExecUs) stats.maxExecUs = execUs;
+
+    // More than one pending period means a deadline passed while the previous tick was still running
+    if (pendingTicks > 1) {
+        stats.overruns += pendingTicks - 1;
+    }
+
+    if (stats.ticks > 1) {
+        uint32_t actualUs = wakeUs - lastWakeUs;
+        uint32_t jitterUs = actualUs > periodUs ? actualUs - periodUs : periodUs - actualUs;
+        if (jitterUs > stats.maxJitterUs) stats.maxJitterUs = jitterUs;
+        stats.avgJitterUs += JITTER_AVG_ALPHA * (jitterUs - stats.avgJitterUs);
+    }
+
+    published.write(stats);
+}
@@ -0,0 +1,66 @@
+#ifndef CONTROLSCHEDULER_H
+#define CONTROLSCHEDULER_H
+
+#include <Arduino.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include <freertos/semphr.h>
+#include <functional>
+#include "../utils/SeqLock.h"
+
+/**
+ * Fixed-rate control loop
+ * A FreeRTOS task pinned to the control core paces itself with xTaskDelayUntil and runs the tick callback, so no other
+ * core or timer task sits between the tick interrupt and the loop. The period must be a whole number of RTOS ticks.
+ * Jitter is measured against the nominal period; every period missed while a tick was still running counts as an overrun
+ */
+class ControlScheduler {
+public:
+    using TickCallback = std::function<void(float dt)>;
+    using StartCallback = std::function<void()>;
+
+    struct Stats {
+        uint32_t rateHz;
+        uint32_t ticks;
+        uint32_t overruns;
+        uint32_t lastExecUs;
+        uint32_t maxExecUs;
+        uint32_t maxJitterUs;
+        float avgJitterUs;
+    };
+
+    ControlScheduler(uint32_t rateHz, int core, UBaseType_t priority);
+
+    // onStart runs once inside the control task before the first tick, so interrupts it attaches land on the control core.
+    // Blocks until onStart has finished.
+    bool begin(TickCallback onTick, StartCallback onStart = nullptr);
+
+    // Coherent copy of the stats the control task last published; safe from any core
+    Stats getStats() const { return published.read(); }
+    void resetStats();
+    bool isRunning() const { return running; }
+
+private:
+    static constexpr float JITTER_AVG_ALPHA = 0.01f;
+
+    uint32_t periodUs;
+    int core;
+    UBaseType_t priority;
+
+    TickCallback tickCallback;
+    StartCallback startCallback;
+
+    TaskHandle_t taskHandle;
+    SemaphoreHandle_t startedSemaphore;
+    volatile bool running;
+
+    Stats stats;  // control task only
+    SeqLock<Stats> published;
+    volatile bool resetRequested;
+
+    static void taskEntry(void* arg);
+    void run();
+    void recordTick(uint32_t wakeUs, uint32_t lastWakeUs, uint32_t execUs, uint32_t pendingTicks);
+};
+
+#endif
@@ -0,0 +1,16 @@
+#ifndef CONTROLTICKHOOK_H
+#define CONTROLTICKHOOK_H
+
+#include "../hardware/Encoder.h"
+
+/**
+ * Replaces the velocity loop for experiments that must run at the control rate
+ * Called from the control task with the tick's encoder sample; writes signed motor PWM (-255 to 255)
+ */
+class ControlTickHook {
+public:
+    virtual ~ControlTickHook() = default;
+    virtual void onControlTick(const EncoderSnapshot& snapshot, float dt, float& leftPWM, float& rightPWM) = 0;
+};
+
+#endif
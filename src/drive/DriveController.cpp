@@ -61,20 +61,26 @@ void DriveController::setRightMotorPower(float power) {
     }
 }
 
-void DriveController::setPowerControl(float forward, float turn) {
+void DriveController::mix(float forward, float turn, float& leftPower, float& rightPower) {
     // Differential drive with forward (-1 to 1) and turn (-1 to 1)
     // forward: -1.0 (backward) to 1.0 (forward)
     // turn: -1.0 (left) to 1.0 (right)
     
     // Basic differential steering formula
-    float leftSpeed = forward + turn;
-    float rightSpeed = forward - turn;
+    leftPower = forward + turn;
+    rightPower = forward - turn;
     
-    float maxSpeed = max(abs(leftSpeed), abs(rightSpeed));
-    if (maxSpeed > 1.0) {
-        leftSpeed /= maxSpeed;
-        rightSpeed /= maxSpeed;
+    float maxPower = max(abs(leftPower), abs(rightPower));
+    if (maxPower > 1.0) {
+        leftPower /= maxPower;
+        rightPower /= maxPower;
     }
+}
+
+void DriveController::setPowerControl(float forward, float turn) {
+    float leftSpeed;
+    float rightSpeed;
+    mix(forward, turn, leftSpeed, rightSpeed);
     
     setLeftMotorPower(leftSpeed);
     setRightMotorPower(rightSpeed);
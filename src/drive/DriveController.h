@@ -8,6 +8,8 @@ public:
     DriveController();
     void begin();
     void setPowerControl(float forward, float turn);
+    // Differential mix of forward/turn (-1.0 to 1.0) into left/right power, normalized to +/-1.0
+    static void mix(float forward, float turn, float& leftPower, float& rightPower);
     void setLeftMotorPower(float power);   // -1.0 to 1.0
     void setRightMotorPower(float power);  // -1.0 to 1.0
     int getLastLeftPWM() const { return lastLeftPWM; }
@@ -0,0 +1,95 @@
+#include "Localizer.h"
+#include <math.h>
+
+namespace {
+    const float PI_F = 3.14159265f;
+
+    // sin(h) / h, with the series near zero where the quotient loses precision
+    float sinc(float h) {
+        if (fabsf(h) < 1e-3f) return 1.0f - h * h / 6.0f;
+        return sinf(h) / h;
+    }
+}
+
+Localizer::Localizer(float trackWidth, float wheelNoise)
+    : trackWidth(trackWidth), wheelNoise(wheelNoise), initialized(false),
+      lastLeftDistance(0), lastRightDistance(0), state(), resetRequested(false) {}
+
+float Localizer::wrapAngle(float angle) {
+    while (angle > PI_F) angle -= 2 * PI_F;
+    while (angle < -PI_F) angle += 2 * PI_F;
+    return angle;
+}
+
+void Localizer::integrateArc(Pose2D& pose, float dl, float dr, float trackWidth) {
+    advance(pose, 0.5f * (dl + dr), (dr - dl) / trackWidth);
+}
+
+void Localizer::advance(Pose2D& pose, float ds, float dtheta) {
+    // Chord of the arc: length ds * sinc(dtheta / 2), pointing along the mid-step heading
+    float chord = ds * sinc(0.5f * dtheta);
+    float thetaMid = pose.theta + 0.5f * dtheta;
+    pose.x += chord * cosf(thetaMid);
+    pose.y += chord * sinf(thetaMid);
+    pose.theta = wrapAngle(pose.theta + dtheta);
+}
+
+void Localizer::update(float leftDistance, float rightDistance, float leftVelocity, float rightVelocity) {
+    if (!initialized || resetRequested.exchange(false, std::memory_order_acq_rel)) {
+        resetState(leftDistance, rightDistance);
+        initialized = true;
+    }
+
+    float dl = leftDistance - lastLeftDistance;
+    float dr = rightDistance - lastRightDistance;
+    lastLeftDistance = leftDistance;
+    lastRightDistance = rightDistance;
+
+    float thetaMid = state.pose.theta + 0.5f * (dr - dl) / trackWidth;
+    propagateCovariance(thetaMid, 0.5f * (dl + dr), dl, dr);
+    integrateArc(state.pose, dl, dr, trackWidth);
+
+    state.twist.linear = 0.5f * (leftVelocity + rightVelocity);
+    state.twist.angular = (rightVelocity - leftVelocity) / trackWidth;
+    state.updates++;
+
+    published.write(state);
+}
+
+void Localizer::resetState(float leftDistance, float rightDistance) {
+    lastLeftDistance = leftDistance;
+    lastRightDistance = rightDistance;
+    state = LocalizerState();
+    published.write(state);
+}
+
+// P = Fx P Fx^T + Fu Q Fu^T with Q = wheelNoise * diag(|dl|, |dr|), Jacobians taken at the mid-step heading
+void Localizer::propagateCovariance(float thetaMid, float ds, float dl, float dr) {
+    float c = cosf(thetaMid);
+    float s = sinf(thetaMid);
+    float* p = state.covariance;
+    float pxx = p[0], pxy = p[1], pxt = p[2], pyy = p[3], pyt = p[4], ptt = p[5];
+
+    // Fx = [1 0 -ds*s; 0 1 ds*c; 0 0 1]
+    float a = -ds * s;
+    float b = ds * c;
+    float nxt = pxt + a * ptt;
+    float nyt = pyt + b * ptt;
+    float nxx = pxx + 2 * a * pxt + a * a * ptt;
+    float nxy = pxy + a * pyt + b * pxt + a * b * ptt;
+    float nyy = pyy + 2 * b * pyt + b * b * ptt;
+
+    // Columns of Fu for dl and dr
+    float k = ds / (2 * trackWidth);
+    float lx = 0.5f * c + k * s, ly = 0.5f * s - k * c, lt = -1.0f / trackWidth;
+    float rx = 0.5f * c - k * s, ry = 0.5f * s + k * c, rt = 1.0f / trackWidth;
+    float ql = wheelNoise * fabsf(dl);
+    float qr = wheelNoise * fabsf(dr);
+
+    p[0] = nxx + ql * lx * lx + qr * rx * rx;
+    p[1] = nxy + ql * lx * ly + qr * rx * ry;
+    p[2] = nxt + ql * lx * lt + qr * rx * rt;
+    p[3] = nyy + ql * ly * ly + qr * ry * ry;
+    p[4] = nyt + ql * ly * lt + qr * ry * rt;
+    p[5] = ptt + ql * lt * lt + qr * rt * rt;
+}
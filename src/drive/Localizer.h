@@ -0,0 +1,68 @@
+#ifndef LOCALIZER_H
+#define LOCALIZER_H
+
+#include <stdint.h>
+#include <atomic>
+#include "../utils/SeqLock.h"
+
+struct Pose2D {
+    float x;      // cm
+    float y;      // cm
+    float theta;  // rad, wrapped to [-pi, pi]
+};
+
+struct Twist2D {
+    float linear;   // cm/s
+    float angular;  // rad/s
+};
+
+struct LocalizerState {
+    Pose2D pose;
+    Twist2D twist;
+    float covariance[6];  // upper triangle of the (x, y, theta) covariance: xx, xy, xt, yy, yt, tt
+    uint32_t updates;
+};
+
+/**
+ * Differential-drive odometry
+ * Each update integrates the wheel distance deltas along the circular arc they describe, which is exact
+ * for constant wheel speeds over the step. The covariance grows with the distance each wheel travels.
+ * Hardware-free: update() runs in the control task, readers take a consistent copy from any task.
+ */
+class Localizer {
+public:
+    // wheelNoise is the variance added per cm travelled by each wheel, in cm^2/cm
+    Localizer(float trackWidth, float wheelNoise);
+
+    // Cumulative wheel distances (cm) and velocities (cm/s)
+    void update(float leftDistance, float rightDistance, float leftVelocity, float rightVelocity);
+
+    // Zeroes the pose on the next update, taking that update's distances as the new origin
+    void requestReset() { resetRequested.store(true, std::memory_order_release); }
+
+    LocalizerState getState() const { return published.read(); }
+    float getTrackWidth() const { return trackWidth; }
+
+    // Pose change for wheel distance deltas dl, dr, integrated along the arc
+    static void integrateArc(Pose2D& pose, float dl, float dr, float trackWidth);
+    // Moves the pose ds along an arc that turns it by dtheta
+    static void advance(Pose2D& pose, float ds, float dtheta);
+    static float wrapAngle(float angle);
+
+private:
+    float trackWidth;
+    float wheelNoise;
+
+    bool initialized;
+    float lastLeftDistance;
+    float lastRightDistance;
+    LocalizerState state;
+
+    std::atomic<bool> resetRequested;
+    SeqLock<LocalizerState> published;
+
+    void resetState(float leftDistance, float rightDistance);
+    void propagateCovariance(float thetaMid, float ds, float dl, float dr);
+};
+
+#endif
@@ -0,0 +1,107 @@
+#include "MotionProfile.h"
+#include <math.h>
+
+MotionProfile::MotionProfile()
+    : distance(0), direction(1), jerk(0), peakAcceleration(0), peakVelocity(0),
+      jerkTime(0), accelerationTime(0), cruiseTime(0), duration(0) {}
+
+bool MotionProfile::plan(float distance, const Limits& limits) {
+    this->distance = distance;
+    direction = distance < 0 ? -1.0f : 1.0f;
+    jerkTime = accelerationTime = cruiseTime = duration = 0;
+    peakAcceleration = peakVelocity = 0;
+    jerk = 0;
+
+    if (limits.maxVelocity <= 0 || limits.maxAcceleration <= 0) return false;
+
+    float d = fabsf(distance);
+    if (d == 0) return true;
+
+    float v = limits.maxVelocity;
+    float a = limits.maxAcceleration;
+    float j = limits.maxJerk;
+
+    // A ramp to v: the acceleration limit is only reached if v leaves room for both jerk segments
+    if (j > 0) {
+        if (v * j >= a * a) {
+            jerkTime = a / j;
+            accelerationTime = jerkTime + v / a;
+        } else {
+            jerkTime = sqrtf(v / j);
+            accelerationTime = 2 * jerkTime;
+        }
+    } else {
+        accelerationTime = v / a;
+    }
+
+    // Each ramp covers v * Ta / 2
+    cruiseTime = d / v - accelerationTime;
+    if (cruiseTime < 0) {
+        cruiseTime = 0;
+        if (j > 0 && d < 2 * a * a * a / (j * j)) {
+            // Neither limit is reached: d = 2 j Tj^3
+            jerkTime = cbrtf(d / (2 * j));
+            accelerationTime = 2 * jerkTime;
+        } else {
+            // Acceleration limited, no cruise: d = a (Ta - Tj) Ta
+            jerkTime = j > 0 ? a / j : 0;
+            accelerationTime = 0.5f * (jerkTime + sqrtf(jerkTime * jerkTime + 4 * d / a));
+        }
+    }
+
+    jerk = j > 0 ? j : 0;
+    peakAcceleration = j > 0 ? j * jerkTime : a;
+    if (j > 0 && peakAcceleration > a) peakAcceleration = a;
+    peakVelocity = peakAcceleration * (accelerationTime - jerkTime);
+    // The cruise makes up the distance the ramps leave, so rounding in the peak cannot miss the target
+    cruiseTime = peakVelocity > 0 ? fmaxf(d / peakVelocity - accelerationTime, 0.0f) : 0;
+    duration = 2 * accelerationTime + cruiseTime;
+    return true;
+}
+
+MotionProfile::State MotionProfile::ramp(float tau) const {
+    float a = peakAcceleration;
+    float tj = jerkTime;
+    float ta = accelerationTime;
+
+    if (tj <= 0) {
+        return {0.5f * a * tau * tau, a * tau, a};
+    }
+    if (tau < tj) {
+        return {jerk * tau * tau * tau / 6, 0.5f * jerk * tau * tau, jerk * tau};
+    }
+    if (tau < ta - tj) {
+        float v1 = 0.5f * a * tj;
+        float s1 = a * tj * tj / 6;
+        float u = tau - tj;
+        return {s1 + v1 * u + 0.5f * a * u * u, v1 + a * u, a};
+    }
+    // Mirror of the first jerk segment about the end of the ramp
+    float u = ta - tau;
+    float s = 0.5f * peakVelocity * ta - (peakVelocity * u - jerk * u * u * u / 6);
+    return {s, peakVelocity - 0.5f * jerk * u * u, jerk * u};
+}
+
+MotionProfile::State MotionProfile::sample(float t) const {
+    State state;
+    float d = fabsf(distance);
+
+    if (t <= 0 || duration <= 0) {
+        state = {0, 0, 0};
+    } else if (t >= duration) {
+        state = {d, 0, 0};
+    } else if (t < accelerationTime) {
+        state = ramp(t);
+    } else if (t < accelerationTime + cruiseTime) {
+        float rampDistance = 0.5f * peakVelocity * accelerationTime;
+        state = {rampDistance + peakVelocity * (t - accelerationTime), peakVelocity, 0};
+    } else {
+        State mirrored = ramp(duration - t);
+        state = {d - mirrored.position, mirrored.velocity, -mirrored.acceleration};
+    }
+
+    state.position *= direction;
+    state.velocity *= direction;
+    state.acceleration *= direction;
+    return state;
+}
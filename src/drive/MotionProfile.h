@@ -0,0 +1,48 @@
+#ifndef MOTIONPROFILE_H
+#define MOTIONPROFILE_H
+
+/**
+ * Rest-to-rest point-to-point motion profile
+ * With a jerk limit it is the symmetric double-S (seven segments: jerk, constant acceleration, jerk, cruise and
+ * the mirror image); without one it is a trapezoid. Short moves that cannot reach the velocity or acceleration
+ * limit get the largest peak the distance allows, so the profile always ends exactly on the distance.
+ */
+class MotionProfile {
+public:
+    struct Limits {
+        float maxVelocity;      // units/s
+        float maxAcceleration;  // units/s^2
+        float maxJerk;          // units/s^3; 0 for a trapezoid
+    };
+
+    struct State {
+        float position;
+        float velocity;
+        float acceleration;
+    };
+
+    MotionProfile();
+
+    // distance may be negative; returns false for non-positive velocity or acceleration limits
+    bool plan(float distance, const Limits& limits);
+    State sample(float t) const;
+
+    float getDistance() const { return distance; }
+    float getDuration() const { return duration; }
+    float getPeakVelocity() const { return peakVelocity; }
+
+private:
+    float distance;
+    float direction;
+    float jerk;
+    float peakAcceleration;
+    float peakVelocity;
+    float jerkTime;          // Tj, each jerk segment
+    float accelerationTime;  // Ta, whole ramp up (and down)
+    float cruiseTime;
+    float duration;
+
+    State ramp(float tau) const;  // acceleration phase, tau in [0, Ta], distance taken as positive
+};
+
+#endif
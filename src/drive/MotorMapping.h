@@ -0,0 +1,52 @@
+#ifndef MOTORMAPPING_H
+#define MOTORMAPPING_H
+
+#include <stdint.h>
+#include <string.h>
+
+/**
+ * Identifies one wheel/direction pair; each has its own velocity<->PWM polynomial
+ */
+enum class MotorMapping : uint8_t {
+    LeftForward,
+    LeftReverse,
+    RightForward,
+    RightReverse
+};
+
+static constexpr int MOTOR_MAPPING_COUNT = 4;
+
+inline MotorMapping motorMappingFor(bool left, bool reverse) {
+    if (left) return reverse ? MotorMapping::LeftReverse : MotorMapping::LeftForward;
+    return reverse ? MotorMapping::RightReverse : MotorMapping::RightForward;
+}
+
+inline bool isLeftMapping(MotorMapping mapping) {
+    return mapping == MotorMapping::LeftForward || mapping == MotorMapping::LeftReverse;
+}
+
+inline bool isReverseMapping(MotorMapping mapping) {
+    return mapping == MotorMapping::LeftReverse || mapping == MotorMapping::RightReverse;
+}
+
+inline const char* motorMappingName(MotorMapping mapping) {
+    switch (mapping) {
+        case MotorMapping::LeftForward: return "left_fwd";
+        case MotorMapping::LeftReverse: return "left_rev";
+        case MotorMapping::RightForward: return "right_fwd";
+        case MotorMapping::RightReverse: return "right_rev";
+    }
+    return "";
+}
+
+inline bool parseMotorMapping(const char* name, MotorMapping& mapping) {
+    for (int i = 0; i < MOTOR_MAPPING_COUNT; i++) {
+        if (strcmp(name, motorMappingName((MotorMapping)i)) == 0) {
+            mapping = (MotorMapping)i;
+            return true;
+        }
+    }
+    return false;
+}
+
+#endif
@@ -0,0 +1,95 @@
+#include "MotorModelEstimator.h"
+#include "config.h"
+#include <Arduino.h>
+
+namespace {
+constexpr float PWM_MAX = 255.0f;
+
+float centredPWM(float pwm) {
+    return 2.0f * pwm / PWM_MAX - 1.0f;
+}
+}
+
+MotorModelEstimator::MotorModelEstimator(MotorMapping mapping)
+    : mapping(mapping), reverse(isReverseMapping(mapping)), rls(ONLINE_ID_FORGETTING_FACTOR), polynomial(),
+      heldPWM(0), heldTime(0), sinceSample(0), lastSpeed(0), residualMeanSquare(0),
+      samplesSinceRefresh(0), confident(false) {}
+
+void MotorModelEstimator::reset() {
+    rls.reset();
+    heldTime = 0;
+    sinceSample = 0;
+    residualMeanSquare = 0;
+    samplesSinceRefresh = 0;
+    confident = false;
+}
+
+void MotorModelEstimator::observe(float pwm, float velocity, float dt) {
+    // Mirrored so this mapping's own direction is positive
+    float drive = reverse ? -pwm : pwm;
+    float speed = reverse ? -velocity : velocity;
+    float acceleration = (dt > 0) ? (speed - lastSpeed) / dt : 0;
+    lastSpeed = speed;
+
+    if (abs(drive - heldPWM) > PWM_TOLERANCE) {
+        heldPWM = drive;
+        heldTime = 0;
+        return;
+    }
+    heldTime += dt;
+    sinceSample += dt;
+
+    // Steady state, driven in this direction, and not pushed backwards by something else
+    bool steady = heldTime >= SETTLE_TIME && abs(acceleration) <= MAX_ACCELERATION;
+    if (!steady || sinceSample < SAMPLE_INTERVAL || drive <= 0 || speed < 0) {
+        return;
+    }
+    sinceSample = 0;
+
+    float u = centredPWM(drive);
+    float phi[DEGREE + 1] = {1.0f, u, u * u, u * u * u};
+    float error = rls.update(phi, speed);
+
+    float alpha = 1.0f - ONLINE_ID_FORGETTING_FACTOR;
+    residualMeanSquare += alpha * (error * error - residualMeanSquare);
+
+    if (++samplesSinceRefresh >= REFRESH_SAMPLES) {
+        samplesSinceRefresh = 0;
+        refresh();
+    }
+}
+
+void MotorModelEstimator::refresh() {
+    // Expand theta(2p/255 - 1) into coefficients of p: c <- c * (a*p + b) + theta_k
+    const float* theta = rls.getParameters();
+    const float a = 2.0f / PWM_MAX;
+    const float b = -1.0f;
+
+    float coeffs[DEGREE + 1] = {theta[DEGREE]};
+    int degree = 0;
+    for (int k = DEGREE - 1; k >= 0; k--) {
+        coeffs[degree + 1] = 0;
+        for (int i = degree + 1; i > 0; i--) {
+            coeffs[i] = b * coeffs[i] + a * coeffs[i - 1];
+        }
+        coeffs[0] = b * coeffs[0] + theta[k];
+        degree++;
+    }
+    polynomial.setCoefficients(coeffs, DEGREE);
+
+    inverseTable.build([this](float pwm) {
+        return max(polynomial.evaluate(pwm), 0.0f);
+    }, 0.0f, PWM_MAX);
+
+    confident = rls.getSampleCount() >= ONLINE_ID_MIN_SAMPLES &&
+                rls.getCovarianceTrace() <= ONLINE_ID_MAX_COVARIANCE &&
+                getResidualRMS() <= ONLINE_ID_MAX_RESIDUAL;
+}
+
+float MotorModelEstimator::pwmForVelocity(float velocity) const {
+    return inverseTable.inverse(abs(velocity));
+}
+
+float MotorModelEstimator::getResidualRMS() const {
+    return sqrtf(residualMeanSquare);
+}
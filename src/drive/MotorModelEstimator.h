@@ -0,0 +1,59 @@
+#ifndef MOTORMODELESTIMATOR_H
+#define MOTORMODELESTIMATOR_H
+
+#include "../utils/RecursiveLeastSquares.h"
+#include "../utils/Polynomial.h"
+#include "../utils/LookupTable.h"
+#include "MotorMapping.h"
+
+/**
+ * Online identification of one wheel/direction's steady-state PWM -> velocity curve
+ * Fed every control tick with the wheel's signed PWM and velocity; samples are taken only while driven in
+ * its own direction, once the PWM has held and the wheel stopped accelerating,
+ * then fitted by RLS as a cubic in PWM magnitude centred on [-1, 1] for conditioning
+ */
+class MotorModelEstimator {
+public:
+    static constexpr int DEGREE = 3;
+
+    explicit MotorModelEstimator(MotorMapping mapping);
+
+    void reset();
+    void observe(float pwm, float velocity, float dt);
+
+    MotorMapping getMapping() const { return mapping; }
+    
+    // Fitted curve in raw PWM magnitude, and its inverse through a lookup table
+    const Polynomial& getPolynomial() const { return polynomial; }
+    float pwmForVelocity(float velocity) const;
+
+    bool isConfident() const { return confident; }
+    uint32_t getSampleCount() const { return rls.getSampleCount(); }
+    float getResidualRMS() const;
+    float getCovarianceTrace() const { return rls.getCovarianceTrace(); }
+
+private:
+    static constexpr float SETTLE_TIME = 0.15f;       // s the PWM must hold before sampling
+    static constexpr float PWM_TOLERANCE = 3.0f;      // PWM counts still considered the same step
+    static constexpr float MAX_ACCELERATION = 40.0f;  // cm/s^2, above this the wheel is not steady
+    static constexpr float SAMPLE_INTERVAL = 0.1f;    // s between samples at one operating point
+    static constexpr int REFRESH_SAMPLES = 10;        // samples between polynomial/table rebuilds
+
+    MotorMapping mapping;
+    bool reverse;
+    RecursiveLeastSquares<DEGREE + 1> rls;
+    Polynomial polynomial;
+    LookupTable inverseTable;
+
+    float heldPWM;
+    float heldTime;
+    float sinceSample;
+    float lastSpeed;
+    float residualMeanSquare;
+    int samplesSinceRefresh;
+    bool confident;
+
+    void refresh();
+};
+
+#endif
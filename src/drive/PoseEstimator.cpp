@@ -0,0 +1,187 @@
+#include "PoseEstimator.h"
+#include <math.h>
+
+namespace {
+    enum { X, Y, THETA, BIAS, N };
+}
+
+PoseEstimator::PoseEstimator(const Config& config)
+    : config(config), initialized(false), lastLeftDistance(0), lastRightDistance(0),
+      state(), P(), midCos(1), midSin(0), estimate(), resetRequested(false) {
+    resetState();
+}
+
+void PoseEstimator::resetState() {
+    for (int i = 0; i < N; i++) {
+        state[i] = 0;
+        for (int j = 0; j < N; j++) {
+            P[i][j] = 0;
+        }
+    }
+    P[BIAS][BIAS] = config.initialBiasSigma * config.initialBiasSigma;
+    estimate = PoseEstimate();
+}
+
+void PoseEstimator::beginStep(float leftDistance, float rightDistance, float& dl, float& dr) {
+    if (!initialized || resetRequested.exchange(false, std::memory_order_acq_rel)) {
+        // The bias is a property of the sensor, not of the origin, so it survives a reset
+        float bias = state[BIAS];
+        float biasVariance = initialized ? P[BIAS][BIAS] : config.initialBiasSigma * config.initialBiasSigma;
+        resetState();
+        state[BIAS] = bias;
+        P[BIAS][BIAS] = biasVariance;
+
+        lastLeftDistance = leftDistance;
+        lastRightDistance = rightDistance;
+        initialized = true;
+    }
+
+    dl = leftDistance - lastLeftDistance;
+    dr = rightDistance - lastRightDistance;
+    lastLeftDistance = leftDistance;
+    lastRightDistance = rightDistance;
+}
+
+void PoseEstimator::update(float leftDistance, float rightDistance, float gyroRate, float dt) {
+    float dl, dr;
+    beginStep(leftDistance, rightDistance, dl, dr);
+    if (dt <= 0) return;
+
+    float ds = 0.5f * (dl + dr);
+    float wheelVariance = config.wheelNoise * (fabsf(dl) + fabsf(dr));
+    float quantization = config.encoderResolution * config.encoderResolution / 6.0f;  // two wheels, uniform error
+
+    float dtheta = (gyroRate - state[BIAS]) * dt;
+    float gyroVariance = config.gyroNoise * dt;
+    predict(ds, dtheta, 0.25f * wheelVariance, gyroVariance, dt);
+
+    float encoderDtheta = (dr - dl) / config.trackWidth;
+    // Scrub and contact patch shifts make the effective track width uncertain while turning
+    float scrub = config.trackWidthUncertainty * dtheta;
+    float encoderVariance = (wheelVariance + quantization) / (config.trackWidth * config.trackWidth) + scrub * scrub;
+    if (!updateYaw(encoderDtheta, dtheta, ds, dt, gyroVariance, encoderVariance)) {
+        // The rejected yaw difference times half the track width is how far a wheel slipped; the distance is that uncertain too
+        estimate.slipEvents++;
+        float slip = 0.5f * (encoderDtheta - dtheta) * config.trackWidth;
+        P[X][X] += slip * slip;
+        P[Y][Y] += slip * slip;
+    }
+
+    publish(ds, (gyroRate - state[BIAS]) * dt, dt, true);
+}
+
+void PoseEstimator::updateOdometryOnly(float leftDistance, float rightDistance, float dt) {
+    float dl, dr;
+    beginStep(leftDistance, rightDistance, dl, dr);
+    if (dt <= 0) return;
+
+    float ds = 0.5f * (dl + dr);
+    float dtheta = (dr - dl) / config.trackWidth;
+    float wheelVariance = config.wheelNoise * (fabsf(dl) + fabsf(dr));
+    predict(ds, dtheta, 0.25f * wheelVariance, wheelVariance / (config.trackWidth * config.trackWidth), 0);
+
+    publish(ds, dtheta, dt, false);
+}
+
+// P = F P F^T + Q with F the Jacobian of the arc step at the mid-step heading.
+// dt scales the bias coupling; 0 when the heading does not come from the gyro.
+void PoseEstimator::predict(float ds, float dtheta, float dsVariance, float dthetaVariance, float dt) {
+    Pose2D pose = {state[X], state[Y], state[THETA]};
+    Localizer::advance(pose, ds, dtheta);
+    state[X] = pose.x;
+    state[Y] = pose.y;
+    state[THETA] = pose.theta;
+
+    float thetaMid = pose.theta - 0.5f * dtheta;
+    float c = cosf(thetaMid);
+    float s = sinf(thetaMid);
+    midCos = c;
+    midSin = s;
+
+    // Non-identity entries of F: x and y depend on theta and (through dtheta) on the bias
+    float fxt = -ds * s;
+    float fyt = ds * c;
+    float fxb = 0.5f * ds * s * dt;
+    float fyb = -0.5f * ds * c * dt;
+    float ftb = -dt;
+
+    // A = F P, rows X, Y and THETA change; the BIAS row is untouched
+    float A[N][N];
+    for (int j = 0; j < N; j++) {
+        A[X][j] = P[X][j] + fxt * P[THETA][j] + fxb * P[BIAS][j];
+        A[Y][j] = P[Y][j] + fyt * P[THETA][j] + fyb * P[BIAS][j];
+        A[THETA][j] = P[THETA][j] + ftb * P[BIAS][j];
+        A[BIAS][j] = P[BIAS][j];
+    }
+
+    // P = A F^T, kept symmetric
+    for (int i = 0; i < N; i++) {
+        float px = A[i][X] + A[i][THETA] * fxt + A[i][BIAS] * fxb;
+        float py = A[i][Y] + A[i][THETA] * fyt + A[i][BIAS] * fyb;
+        float pt = A[i][THETA] + A[i][BIAS] * ftb;
+        P[i][X] = px;
+        P[i][Y] = py;
+        P[i][THETA] = pt;
+        P[i][BIAS] = A[i][BIAS];
+    }
+
+    // Q = G_ds q_ds G_ds^T + G_dtheta q_dtheta G_dtheta^T + bias drift
+    float gdx = c, gdy = s;
+    float gtx = -0.5f * ds * s, gty = 0.5f * ds * c;
+    P[X][X] += dsVariance * gdx * gdx + dthetaVariance * gtx * gtx;
+    P[X][Y] += dsVariance * gdx * gdy + dthetaVariance * gtx * gty;
+    P[Y][Y] += dsVariance * gdy * gdy + dthetaVariance * gty * gty;
+    P[X][THETA] += dthetaVariance * gtx;
+    P[Y][THETA] += dthetaVariance * gty;
+    P[THETA][THETA] += dthetaVariance;
+    P[BIAS][BIAS] += config.gyroBiasDrift * dt;
+
+    P[Y][X] = P[X][Y];
+    P[THETA][X] = P[X][THETA];
+    P[THETA][Y] = P[Y][THETA];
+    for (int i = 0; i < BIAS; i++) {
+        P[BIAS][i] = P[i][BIAS];
+    }
+}
+
+// z = encoder yaw increment, predicted by the bias-corrected gyro increment.
+// The innovation depends on the bias error and on this step's gyro noise, which the prediction has just
+// added to the pose, so the update uses the cross-covariance c = cov(error, innovation) directly:
+// K = -c / S, P -= c c^T / S
+bool PoseEstimator::updateYaw(float measuredDtheta, float predictedDtheta, float ds, float dt,
+                              float gyroVariance, float encoderVariance) {
+    float innovation = measuredDtheta - predictedDtheta;
+    float S = dt * dt * P[BIAS][BIAS] + gyroVariance + encoderVariance;
+    if (innovation * innovation > config.yawGate * S) {
+        return false;
+    }
+
+    float G[N] = {-0.5f * ds * midSin, 0.5f * ds * midCos, 1.0f, 0};
+    float c[N];
+    for (int i = 0; i < N; i++) {
+        c[i] = dt * P[i][BIAS] - G[i] * gyroVariance;
+    }
+
+    for (int i = 0; i < N; i++) {
+        state[i] -= c[i] / S * innovation;
+        for (int j = i; j < N; j++) {
+            P[i][j] -= c[i] * c[j] / S;
+            P[j][i] = P[i][j];
+        }
+    }
+    state[THETA] = Localizer::wrapAngle(state[THETA]);
+    return true;
+}
+
+void PoseEstimator::publish(float ds, float dtheta, float dt, bool gyroActive) {
+    estimate.pose = {state[X], state[Y], state[THETA]};
+    estimate.twist.linear = ds / dt;
+    estimate.twist.angular = dtheta / dt;
+    estimate.gyroBias = state[BIAS];
+    for (int i = 0; i < N; i++) {
+        estimate.variance[i] = P[i][i];
+    }
+    estimate.gyroActive = gyroActive;
+    estimate.updates++;
+    published.write(estimate);
+}
@@ -0,0 +1,72 @@
+#ifndef POSEESTIMATOR_H
+#define POSEESTIMATOR_H
+
+#include <stdint.h>
+#include <atomic>
+#include "Localizer.h"
+#include "../utils/SeqLock.h"
+
+struct PoseEstimate {
+    Pose2D pose;
+    Twist2D twist;
+    float gyroBias;      // rad/s
+    float variance[4];   // diagonal of the covariance: x, y, theta, gyro bias
+    uint32_t updates;
+    uint32_t slipEvents; // steps whose encoder yaw was rejected by the gate
+    bool gyroActive;
+};
+
+/**
+ * Extended Kalman filter fusing wheel odometry with the gyro yaw rate
+ * State is (x, y, theta, gyro bias). The gyro drives the heading in the prediction, the encoders the distance.
+ * The encoder yaw increment of each step is then a measurement of the bias-corrected gyro rate;
+ * increments outside the chi-square gate are taken as wheel slip and rejected, inflating the position variance instead.
+ * Hardware-free: fed from one task, readers take a consistent copy from any task.
+ */
+class PoseEstimator {
+public:
+    struct Config {
+        float trackWidth;          // cm
+        float trackWidthUncertainty;  // relative error of the encoder yaw while turning (scrub), 1 sigma
+        float wheelNoise;          // cm^2 of variance per cm travelled by each wheel
+        float encoderResolution;   // cm per count
+        float gyroNoise;           // rad^2/s, rate noise density
+        float gyroBiasDrift;       // (rad/s)^2/s, bias random walk
+        float initialBiasSigma;    // rad/s
+        float yawGate;             // chi-square threshold on the normalised yaw innovation
+    };
+
+    explicit PoseEstimator(const Config& config);
+
+    // Cumulative wheel distances (cm), gyro yaw rate (rad/s, counter-clockwise positive) and step length (s)
+    void update(float leftDistance, float rightDistance, float gyroRate, float dt);
+    // Without a gyro the heading follows the encoders and the bias is held
+    void updateOdometryOnly(float leftDistance, float rightDistance, float dt);
+
+    void requestReset() { resetRequested.store(true, std::memory_order_release); }
+    PoseEstimate getState() const { return published.read(); }
+
+private:
+    Config config;
+    bool initialized;
+    float lastLeftDistance;
+    float lastRightDistance;
+
+    float state[4];
+    float P[4][4];
+    float midCos;  // heading of the last predicted step, reused by the update
+    float midSin;
+    PoseEstimate estimate;
+
+    std::atomic<bool> resetRequested;
+    SeqLock<PoseEstimate> published;
+
+    void beginStep(float leftDistance, float rightDistance, float& dl, float& dr);
+    void resetState();
+    void predict(float ds, float dtheta, float dsVariance, float dthetaVariance, float dt);
+    bool updateYaw(float measuredDtheta, float predictedDtheta, float ds, float dt,
+                   float gyroVariance, float encoderVariance);
+    void publish(float ds, float dtheta, float dt, bool gyroActive);
+};
+
+#endif
@@ -0,0 +1,28 @@
+#include "ProfileFollower.h"
+#include <math.h>
+
+ProfileFollower::ProfileFollower(const Config& config)
+    : config(config), profile(), tolerance(0), done(true), endpointError(0) {}
+
+bool ProfileFollower::start(float distance, const MotionProfile::Limits& limits, float endTolerance) {
+    tolerance = endTolerance;
+    done = !profile.plan(distance, limits);
+    return !done;
+}
+
+float ProfileFollower::update(float t, float progress) {
+    if (done) return 0;
+
+    MotionProfile::State reference = profile.sample(t);
+    float error = reference.position - progress;
+    float limit = config.catchUpMargin * profile.getPeakVelocity();
+    float command = fminf(fmaxf(reference.velocity + config.positionGain * error, -limit), limit);
+
+    if (t >= profile.getDuration() &&
+        (fabsf(error) <= tolerance || t - profile.getDuration() >= config.settleTimeout)) {
+        endpointError = error;
+        done = true;
+        return 0;
+    }
+    return command;
+}
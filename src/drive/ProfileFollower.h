@@ -0,0 +1,40 @@
+#ifndef PROFILEFOLLOWER_H
+#define PROFILEFOLLOWER_H
+
+#include "MotionProfile.h"
+
+/**
+ * Tracks a MotionProfile from measured progress
+ * The command is the profile velocity plus a proportional correction on the position error, limited to a margin
+ * over the profile's peak so a stalled wheel does not wind up a sprint. The move ends once the profile has run out
+ * and the error is within tolerance, or the settle timeout has passed; the command is zero from then on.
+ * Hardware-free: the caller supplies the time and the progress in the profile's units (cm or rad).
+ */
+class ProfileFollower {
+public:
+    struct Config {
+        float positionGain;   // 1/s, position error to velocity
+        float catchUpMargin;  // command limit over the profile's peak velocity
+        float settleTimeout;  // s after the profile ends, then the move finishes regardless
+    };
+
+    explicit ProfileFollower(const Config& config);
+
+    // False if the limits give no profile, in which case the move is already done
+    bool start(float distance, const MotionProfile::Limits& limits, float tolerance);
+    // Velocity command for t seconds after the start
+    float update(float t, float progress);
+
+    bool isDone() const { return done; }
+    float getEndpointError() const { return endpointError; }  // of the last finished move
+    const MotionProfile& getProfile() const { return profile; }
+
+private:
+    Config config;
+    MotionProfile profile;
+    float tolerance;
+    volatile bool done;
+    volatile float endpointError;
+};
+
+#endif
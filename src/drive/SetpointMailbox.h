@@ -0,0 +1,90 @@
+#ifndef SETPOINTMAILBOX_H
+#define SETPOINTMAILBOX_H
+
+#include <stdint.h>
+#include <atomic>
+
+struct Setpoint {
+    enum class Mode : uint8_t {
+        Idle,      // motors stopped and not driven
+        Velocity,  // left/right in cm/s, closed loop
+        Power      // left/right in -1.0 to 1.0, open loop
+    };
+
+    Mode mode;
+    float left;
+    float right;
+    uint32_t seq;          // 0 = nothing published yet
+    uint32_t timestampUs;
+};
+
+/**
+ * Latest-value-wins setpoint mailbox between command producers and the control loop
+ * Lock-free for any number of producers: each publish claims a sequence number and its own slot,
+ * then advances the published sequence. The reader retries if a slot is rewritten mid-copy.
+ * A slot is only reused after SLOTS newer publishes, so a producer can be preempted mid-write without blocking anyone.
+ */
+class SetpointMailbox {
+public:
+    SetpointMailbox() : nextSeq(0), latestSeq(0) {
+        for (Slot& slot : slots) {
+            slot.stamp.store(0, std::memory_order_relaxed);
+            slot.value = Setpoint{Setpoint::Mode::Idle, 0, 0, 0, 0};
+        }
+    }
+
+    uint32_t publish(Setpoint::Mode mode, float left, float right, uint32_t timestampUs) {
+        uint32_t seq = nextSeq.fetch_add(1, std::memory_order_relaxed) + 1;
+        Slot& slot = slots[seq & MASK];
+
+        slot.stamp.store(0, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        slot.value = Setpoint{mode, left, right, seq, timestampUs};
+        std::atomic_thread_fence(std::memory_order_release);
+        slot.stamp.store(seq, std::memory_order_relaxed);
+
+        // Advance to seq unless a newer publish already landed
+        uint32_t current = latestSeq.load(std::memory_order_relaxed);
+        while ((int32_t)(seq - current) > 0 &&
+               !latestSeq.compare_exchange_weak(current, seq, std::memory_order_release, std::memory_order_relaxed)) {
+        }
+        return seq;
+    }
+
+    // Latest complete setpoint; seq == 0 if nothing has been published
+    Setpoint read() const {
+        for (;;) {
+            uint32_t seq = latestSeq.load(std::memory_order_acquire);
+            if (seq == 0) {
+                return Setpoint{Setpoint::Mode::Idle, 0, 0, 0, 0};
+            }
+
+            const Slot& slot = slots[seq & MASK];
+            uint32_t before = slot.stamp.load(std::memory_order_acquire);
+            Setpoint copy = slot.value;
+            std::atomic_thread_fence(std::memory_order_acquire);
+            uint32_t after = slot.stamp.load(std::memory_order_relaxed);
+
+            if (before == seq && after == seq) {
+                return copy;
+            }
+        }
+    }
+
+    uint32_t getLatestSeq() const { return latestSeq.load(std::memory_order_acquire); }
+
+private:
+    static constexpr uint32_t SLOTS = 8;
+    static constexpr uint32_t MASK = SLOTS - 1;
+
+    struct Slot {
+        std::atomic<uint32_t> stamp;  // seq of the value held, 0 while being written
+        Setpoint value;
+    };
+
+    Slot slots[SLOTS];
+    std::atomic<uint32_t> nextSeq;
+    std::atomic<uint32_t> latestSeq;
+};
+
+#endif
@@ -1,23 +1,38 @@
 #include "VelocityController.h"
+#include "config.h"
 #include "./DriveController.h"
 #include "../network/Telemetry.h"
 
 extern DriveController driveController;
 
 VelocityController::VelocityController() 
-    : leftEncoder(nullptr), rightEncoder(nullptr),
+    : leftEncoder(nullptr), rightEncoder(nullptr), snapshot(), publishedSnapshot(),
+      appliedSeq(0), activeMode(Setpoint::Mode::Idle), motorsInhibited(false),
       targetLeftVel(0), targetRightVel(0),
       feedforwardGain(3),
       deadzonePWM(60),
-      pwmToVelocityPoly(),
-      velocityToPWMPoly(),
+      mappingReadSeq(0),
       usePolynomialMapping(false),
+      voltageCompensationEnabled(false), nominalVoltage(VOLTAGE_COMP_NOMINAL),
+      supplyVoltage(0), voltageScale(1.0f),
+      useLookupTable(false),
+      onlineModels{
+          MotorModelEstimator(MotorMapping::LeftForward), MotorModelEstimator(MotorMapping::LeftReverse),
+          MotorModelEstimator(MotorMapping::RightForward), MotorModelEstimator(MotorMapping::RightReverse)
+      },
+      onlineIdEnabled(ONLINE_ID_DEFAULT_ENABLED), onlineIdResetRequested(false),
+      tickHook(nullptr), setpointSource(nullptr), tickHookRunning(false), setpointSourceActive(false),
       leftPID(0, 0, 0), rightPID(0, 0, 0), pidEnabled(false),
       leftPWM(0), rightPWM(0),
       leftVelError(0), rightVelError(0) {
 
-    leftPID.setOutputLimits(-100, 100);
-    rightPID.setOutputLimits(-100, 100);
+    leftPID.setOutputLimits(-PID_CORRECTION_LIMIT, PID_CORRECTION_LIMIT);
+    rightPID.setOutputLimits(-PID_CORRECTION_LIMIT, PID_CORRECTION_LIMIT);
+    
+    for (int i = 0; i < MOTOR_MAPPING_COUNT; i++) {
+        activeModel[i].store(0);
+        rebuildLookupTable(mappingModels[i][0]);
+    }
 }
 
 void VelocityController::begin() {
@@ -32,8 +47,70 @@ void VelocityController::attachEncoders(Encoder* left, Encoder* right) {
 }
 
 void VelocityController::setVelocity(float leftVel, float rightVel) {
-    targetLeftVel = leftVel;
-    targetRightVel = rightVel;
+    setpoints.publish(Setpoint::Mode::Velocity, leftVel, rightVel, micros());
+}
+
+void VelocityController::setPower(float leftPower, float rightPower) {
+    setpoints.publish(Setpoint::Mode::Power, leftPower, rightPower, micros());
+}
+
+void VelocityController::release() {
+    setpoints.publish(Setpoint::Mode::Idle, 0, 0, micros());
+}
+
+void VelocityController::attachTickHook(ControlTickHook* hook) {
+    tickHook.store(hook);
+}
+
+void VelocityController::detachTickHook() {
+    tickHook.store(nullptr);
+    // The control task flags the tick before loading the hook, so once the flag clears it holds no stale pointer
+    while (tickHookRunning.load()) {
+        yield();
+    }
+}
+
+void VelocityController::attachSetpointSource(VelocitySetpointSource* source) {
+    setpointSource.store(source);
+}
+
+void VelocityController::detachSetpointSource() {
+    setpointSource.store(nullptr);
+    while (tickHookRunning.load()) {
+        yield();
+    }
+}
+
+void VelocityController::applySetpoint(const Setpoint& setpoint) {
+    switch (setpoint.mode) {
+        case Setpoint::Mode::Velocity:
+            if (activeMode != Setpoint::Mode::Velocity) {
+                leftPID.reset();
+                rightPID.reset();
+            }
+            targetLeftVel = setpoint.left;
+            targetRightVel = setpoint.right;
+            break;
+            
+        case Setpoint::Mode::Power:
+            targetLeftVel = 0;
+            targetRightVel = 0;
+            leftPWM = constrain(setpoint.left, -1.0, 1.0) * 255.0;
+            rightPWM = constrain(setpoint.right, -1.0, 1.0) * 255.0;
+            driveController.setLeftMotorPower(setpoint.left);
+            driveController.setRightMotorPower(setpoint.right);
+            break;
+            
+        case Setpoint::Mode::Idle:
+            targetLeftVel = 0;
+            targetRightVel = 0;
+            leftPWM = 0;
+            rightPWM = 0;
+            driveController.setLeftMotorPower(0);
+            driveController.setRightMotorPower(0);
+            break;
+    }
+    activeMode = setpoint.mode;
 }
 
 void VelocityController::setFeedforwardGain(float gain) {
@@ -53,21 +130,108 @@ void VelocityController::setPIDGains(float kp, float ki, float kd) {
 }
 
 void VelocityController::setPWMToVelocityPolynomial(const float* coeffs, int degree) {
-    pwmToVelocityPoly.setCoefficients(coeffs, degree);
-    TELEM_LOG("PWM->Velocity polynomial updated");
+    for (int i = 0; i < MOTOR_MAPPING_COUNT; i++) {
+        spareMapping((MotorMapping)i).pwmToVelocity.setCoefficients(coeffs, degree);
+        publishMapping((MotorMapping)i);
+    }
+    TELEM_LOG("PWM->Velocity polynomial updated (all mappings)");
     for (int i = 0; i <= degree && i <= 5; i++) {
         TELEM_LOGF("  a%d = %.6f", i, coeffs[i]);
     }
 }
 
 void VelocityController::setVelocityToPWMPolynomial(const float* coeffs, int degree) {
-    velocityToPWMPoly.setCoefficients(coeffs, degree);
-    TELEM_LOG("Velocity->PWM polynomial updated");
+    TELEM_LOG("Velocity->PWM polynomial updated (all mappings)");
+    for (int i = 0; i <= degree && i <= 5; i++) {
+        TELEM_LOGF("  a%d = %.6f", i, coeffs[i]);
+    }
+    
+    for (int i = 0; i < MOTOR_MAPPING_COUNT; i++) {
+        MappingModel& model = spareMapping((MotorMapping)i);
+        model.velocityToPWM.setCoefficients(coeffs, degree);
+        float maxError = rebuildLookupTable(model);
+        publishMapping((MotorMapping)i);
+        TELEM_LOGF("Velocity->PWM lookup table %s rebuilt: max error %.3f PWM, %d non-monotonic samples",
+                   motorMappingName((MotorMapping)i), maxError, model.velocityToPWMTable.getMonotonicFixes());
+    }
+}
+
+void VelocityController::setPWMToVelocityPolynomial(MotorMapping mapping, const float* coeffs, int degree) {
+    spareMapping(mapping).pwmToVelocity.setCoefficients(coeffs, degree);
+    publishMapping(mapping);
+    TELEM_LOGF("PWM->Velocity polynomial updated (%s)", motorMappingName(mapping));
     for (int i = 0; i <= degree && i <= 5; i++) {
         TELEM_LOGF("  a%d = %.6f", i, coeffs[i]);
     }
 }
 
+void VelocityController::setVelocityToPWMPolynomial(MotorMapping mapping, const float* coeffs, int degree) {
+    TELEM_LOGF("Velocity->PWM polynomial updated (%s)", motorMappingName(mapping));
+    for (int i = 0; i <= degree && i <= 5; i++) {
+        TELEM_LOGF("  a%d = %.6f", i, coeffs[i]);
+    }
+    
+    MappingModel& model = spareMapping(mapping);
+    model.velocityToPWM.setCoefficients(coeffs, degree);
+    float maxError = rebuildLookupTable(model);
+    publishMapping(mapping);
+    TELEM_LOGF("Velocity->PWM lookup table %s rebuilt: max error %.3f PWM, %d non-monotonic samples",
+               motorMappingName(mapping), maxError, model.velocityToPWMTable.getMonotonicFixes());
+}
+
+void VelocityController::enableLookupTable(bool enable) {
+    useLookupTable = enable;
+    TELEM_LOGF("Velocity->PWM lookup table %s", enable ? "enabled" : "disabled");
+}
+
+// Setters run on the loop task and edit a copy of the live model while the control tick keeps reading the other one
+VelocityController::MappingModel& VelocityController::spareMapping(MotorMapping mapping) {
+    int index = (int)mapping;
+    MappingModel& spare = mappingModels[index][1 - activeModel[index].load(std::memory_order_relaxed)];
+    spare = activeMapping(mapping);
+    return spare;
+}
+
+void VelocityController::publishMapping(MotorMapping mapping) {
+    int index = (int)mapping;
+    activeModel[index].store(1 - activeModel[index].load(std::memory_order_relaxed), std::memory_order_seq_cst);
+    
+    // A tick that loaded the old index before the swap may still be reading it; the next spareMapping()
+    // overwrites that buffer, so wait for the tick in progress (if any) to end
+    uint32_t seq = mappingReadSeq.load();
+    if (seq & 1) {
+        while (mappingReadSeq.load() == seq) {
+            yield();
+        }
+    }
+}
+
+float VelocityController::rebuildLookupTable(MappingModel& model) {
+    const Polynomial& poly = model.velocityToPWM;
+    return model.velocityToPWMTable.build([&poly](float velocity) {
+        return constrain(poly.evaluate(velocity), 0.0f, 255.0f);
+    }, 0.0f, VELOCITY_LUT_MAX);
+}
+
+void VelocityController::enableVoltageCompensation(bool enable) {
+    voltageCompensationEnabled = enable;
+    TELEM_LOGF("Voltage compensation %s (nominal %.2f V)", enable ? "enabled" : "disabled", nominalVoltage);
+}
+
+void VelocityController::setNominalVoltage(float volts) {
+    nominalVoltage = constrain(volts, VOLTAGE_COMP_MIN_VOLTAGE, 30.0f);
+}
+
+void VelocityController::updateSupplyVoltage(float volts) {
+    // BatteryMonitor already low-passes the reading; a second filter here would only add lag
+    supplyVoltage = volts;
+    if (volts < VOLTAGE_COMP_MIN_VOLTAGE) {
+        voltageScale = 1.0f;
+        return;
+    }
+    voltageScale = constrain(nominalVoltage / volts, 1.0f / VOLTAGE_COMP_MAX_SCALE, VOLTAGE_COMP_MAX_SCALE);
+}
+
 void VelocityController::enablePID(bool enable) {
     if (enable && !pidEnabled) {
         leftPID.reset();
@@ -83,19 +247,33 @@ void VelocityController::getPIDGains(float& kp, float& ki, float& kd) const {
     kd = leftPID.getKd();
 }
 
-float VelocityController::velocityToPWM(float velocity) {
+void VelocityController::enableOnlineIdentification(bool enable) {
+    onlineIdEnabled = enable;
+    TELEM_LOGF("Online motor identification %s", enable ? "enabled" : "disabled");
+}
+
+float VelocityController::velocityToPWM(float velocity, bool left) {
     if (abs(velocity) < 0.5) {
         return 0.0; 
     }
     
     float sign = (velocity >= 0) ? 1.0 : -1.0;
     float absVelocity = abs(velocity);
+    MotorMapping which = motorMappingFor(left, velocity < 0);
+    const MappingModel& mapping = activeMapping(which);
+    const MotorModelEstimator& model = onlineModels[(int)which];
     float pwm;
     
-    if (usePolynomialMapping) {
-        pwm = velocityToPWMPoly.evaluate(absVelocity);
+    // The online model is learned at the present voltage, so only the static maps are rescaled.
+    // Both static maps hold their value past the end of the table, so switching between them never changes the clamp.
+    if (onlineIdEnabled && model.isConfident()) {
+        pwm = model.pwmForVelocity(absVelocity);
+    } else if (usePolynomialMapping && useLookupTable) {
+        pwm = mapping.velocityToPWMTable.evaluate(absVelocity) * getVoltageScale();
+    } else if (usePolynomialMapping) {
+        pwm = mapping.velocityToPWM.evaluate(fminf(absVelocity, VELOCITY_LUT_MAX)) * getVoltageScale();
     } else {
-        pwm = deadzonePWM + feedforwardGain * absVelocity;
+        pwm = (deadzonePWM + feedforwardGain * absVelocity) * getVoltageScale();
     }
     
     pwm = constrain(pwm, 0.0, 255.0);
@@ -103,13 +281,101 @@ float VelocityController::velocityToPWM(float velocity) {
     return sign * pwm;
 }
 
+float VelocityController::pwmToVelocity(float pwm, bool left) const {
+    float sign = (pwm >= 0) ? 1.0 : -1.0;
+    float absPWM = abs(pwm) / getVoltageScale();
+    const MappingModel& mapping = activeMapping(motorMappingFor(left, pwm < 0));
+    float velocity;
+    
+    if (usePolynomialMapping && useLookupTable) {
+        velocity = mapping.velocityToPWMTable.inverse(absPWM);
+    } else if (usePolynomialMapping) {
+        velocity = fminf(mapping.pwmToVelocity.evaluate(absPWM), VELOCITY_LUT_MAX);
+    } else {
+        velocity = (absPWM > deadzonePWM) ? (absPWM - deadzonePWM) / feedforwardGain : 0.0;
+    }
+    
+    return sign * velocity;
+}
+
 void VelocityController::update() {
-    leftPWM = velocityToPWM(targetLeftVel);
-    rightPWM = velocityToPWM(targetRightVel);
+    bool haveEncoders = leftEncoder && rightEncoder;
+    float dt = 0;
+    if (haveEncoders) {
+        uint32_t previousUs = snapshot.timestampUs;
+        snapshot = Encoder::capture(*leftEncoder, *rightEncoder);
+        publishedSnapshot.write(snapshot);
+        dt = (snapshot.timestampUs - previousUs) * 1e-6f;
+    }
+    
+    Setpoint setpoint = setpoints.read();
+    if (motorsInhibited) {
+        appliedSeq = setpoint.seq;
+        if (activeMode != Setpoint::Mode::Idle || leftPWM != 0 || rightPWM != 0) {
+            applySetpoint(Setpoint{Setpoint::Mode::Idle, 0, 0, setpoint.seq, setpoint.timestampUs});
+        }
+        return;
+    }
+    if (setpoint.seq != appliedSeq) {
+        applySetpoint(setpoint);
+        appliedSeq = setpoint.seq;
+    }
+    
+    tickHookRunning.store(true);
+    mappingReadSeq.fetch_add(1);
+    ControlTickHook* hook = tickHook.load();
+    VelocitySetpointSource* source = setpointSource.load();
+    if (source && !setpointSourceActive) {
+        leftPID.reset();
+        rightPID.reset();
+        setpointSourceActive = true;
+    } else if (!source && setpointSourceActive) {
+        applySetpoint(setpoint);
+        setpointSourceActive = false;
+    }
     
-    if (pidEnabled && leftEncoder && rightEncoder) {
-        float leftCorrection = leftPID.compute(targetLeftVel, leftEncoder->getVelocity());
-        float rightCorrection = rightPID.compute(targetRightVel, rightEncoder->getVelocity());
+    if (hook) {
+        hook->onControlTick(snapshot, dt, leftPWM, rightPWM);
+        leftPWM = constrain(leftPWM, -255.0, 255.0);
+        rightPWM = constrain(rightPWM, -255.0, 255.0);
+        driveController.setLeftMotorPower(leftPWM / 255.0);
+        driveController.setRightMotorPower(rightPWM / 255.0);
+    } else if (source) {
+        source->nextSetpoint(snapshot, dt, targetLeftVel, targetRightVel);
+        runVelocityLoop(haveEncoders, dt);
+    } else if (activeMode == Setpoint::Mode::Velocity) {
+        runVelocityLoop(haveEncoders, dt);
+    }
+    mappingReadSeq.fetch_add(1);
+    tickHookRunning.store(false);
+    
+    if (onlineIdResetRequested) {
+        for (MotorModelEstimator& model : onlineModels) {
+            model.reset();
+        }
+        onlineIdResetRequested = false;
+    }
+    
+    if (onlineIdEnabled && haveEncoders) {
+        // Each wheel's estimators see every tick but only sample their own direction
+        for (MotorModelEstimator& model : onlineModels) {
+            bool left = isLeftMapping(model.getMapping());
+            model.observe(left ? leftPWM : rightPWM, left ? snapshot.leftVelocity : snapshot.rightVelocity, dt);
+        }
+    }
+}
+
+void VelocityController::runVelocityLoop(bool haveEncoders, float dt) {
+    leftPWM = velocityToPWM(targetLeftVel, true);
+    rightPWM = velocityToPWM(targetRightVel, false);
+    
+    if (pidEnabled && haveEncoders) {
+        // The motor saturates on feedforward plus correction, so the integral has to stop winding there
+        leftPID.setOutputLimits(fmaxf(-PID_CORRECTION_LIMIT, -255.0f - leftPWM), fminf(PID_CORRECTION_LIMIT, 255.0f - leftPWM));
+        rightPID.setOutputLimits(fmaxf(-PID_CORRECTION_LIMIT, -255.0f - rightPWM), fminf(PID_CORRECTION_LIMIT, 255.0f - rightPWM));
+        
+        float leftCorrection = leftPID.compute(targetLeftVel, snapshot.leftVelocity, dt);
+        float rightCorrection = rightPID.compute(targetRightVel, snapshot.rightVelocity, dt);
         
         leftPWM += leftCorrection;
         rightPWM += rightCorrection;
@@ -121,8 +387,8 @@ void VelocityController::update() {
     driveController.setLeftMotorPower(leftPWM / 255.0);
     driveController.setRightMotorPower(rightPWM / 255.0);
     
-    if (leftEncoder && rightEncoder) {
-        leftVelError = targetLeftVel - leftEncoder->getVelocity();
-        rightVelError = targetRightVel - rightEncoder->getVelocity();
+    if (haveEncoders) {
+        leftVelError = targetLeftVel - snapshot.leftVelocity;
+        rightVelError = targetRightVel - snapshot.rightVelocity;
     }
 }
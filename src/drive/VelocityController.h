@@ -5,29 +5,82 @@
 #include "../hardware/Encoder.h"
 #include "../utils/PIDController.h"
 #include "../utils/Polynomial.h"
+#include "../utils/LookupTable.h"
+#include "../utils/SeqLock.h"
+#include "SetpointMailbox.h"
+#include "MotorModelEstimator.h"
+#include "MotorMapping.h"
+#include "ControlTickHook.h"
+#include "VelocitySetpointSource.h"
+#include <atomic>
 
 class VelocityController {
 public:
     VelocityController();
     
     void begin();
+    // Runs once per control tick and applies the latest published setpoint
     void update();
     
+    // Setpoint producers; safe to call from any task, the control tick picks up the latest one
     void setVelocity(float leftVel, float rightVel);
+    void setPower(float leftPower, float rightPower);  // open loop, -1.0 to 1.0
+    void release();                                    // stop the motors
+    Setpoint::Mode getMode() const { return activeMode; }
+    
+    // Holds the motors off, hooks included; setpoints published meanwhile are dropped so nothing resumes on release
+    void setMotorInhibit(bool inhibit) { motorsInhibited = inhibit; }
+    bool isMotorInhibited() const { return motorsInhibited; }
 
     void setFeedforwardGain(float gain);
     void setDeadzone(float deadzone);
     float getFeedforwardGain() const { return feedforwardGain; }
     float getDeadzone() const { return deadzonePWM; }
     
+    // Without a mapping the polynomial is applied to every wheel and direction
     void setPWMToVelocityPolynomial(const float* coeffs, int degree);
     void setVelocityToPWMPolynomial(const float* coeffs, int degree);
-    Polynomial& getPWMToVelocityPolynomial() { return pwmToVelocityPoly; }
-    Polynomial& getVelocityToPWMPolynomial() { return velocityToPWMPoly; }
+    void setPWMToVelocityPolynomial(MotorMapping mapping, const float* coeffs, int degree);
+    void setVelocityToPWMPolynomial(MotorMapping mapping, const float* coeffs, int degree);
+    const Polynomial& getPWMToVelocityPolynomial(MotorMapping mapping = MotorMapping::LeftForward) const { return activeMapping(mapping).pwmToVelocity; }
+    const Polynomial& getVelocityToPWMPolynomial(MotorMapping mapping = MotorMapping::LeftForward) const { return activeMapping(mapping).velocityToPWM; }
     
     void enablePolynomialMapping(bool enable) { usePolynomialMapping = enable; }
     bool isPolynomialMappingEnabled() const { return usePolynomialMapping; }
     
+    // Velocity->PWM polynomial compiled into a lookup table; pwmToVelocity then inverts the same table
+    void enableLookupTable(bool enable);
+    bool isLookupTableEnabled() const { return useLookupTable; }
+    float pwmToVelocity(float pwm, bool left) const;
+    
+    // Feedforward PWM scaled by nominal / supply voltage; the caller feeds BatteryMonitor's filtered reading at a low rate
+    void enableVoltageCompensation(bool enable);
+    bool isVoltageCompensationEnabled() const { return voltageCompensationEnabled; }
+    void setNominalVoltage(float volts);
+    float getNominalVoltage() const { return nominalVoltage; }
+    void updateSupplyVoltage(float volts);
+    float getSupplyVoltage() const { return supplyVoltage; }
+    float getVoltageScale() const { return voltageCompensationEnabled ? voltageScale : 1.0f; }
+    
+    // PWM->velocity fit per wheel and direction learned while driving; once confident it replaces that mapping's feedforward
+    void enableOnlineIdentification(bool enable);
+    bool isOnlineIdentificationEnabled() const { return onlineIdEnabled; }
+    void resetOnlineIdentification() { onlineIdResetRequested = true; }
+    const MotorModelEstimator& getOnlineModel(MotorMapping mapping) const { return onlineModels[(int)mapping]; }
+    
+    // Open-loop PWM the velocity loop would command for this wheel, before PID correction
+    float feedforwardPWM(float velocity, bool left) { return velocityToPWM(velocity, left); }
+    
+    // While attached the hook drives the motors every tick instead of the current setpoint.
+    // detachTickHook() returns once the hook can no longer be running, so its owner may then be destroyed.
+    void attachTickHook(ControlTickHook* hook);
+    void detachTickHook();
+    
+    // While attached the source sets the velocity loop's targets every tick, overriding published setpoints.
+    // On detach the latest published setpoint applies again; detach returns once the source can no longer be running.
+    void attachSetpointSource(VelocitySetpointSource* source);
+    void detachSetpointSource();
+    
     void setPIDGains(float kp, float ki, float kd);
     void enablePID(bool enable);
     bool isPIDEnabled() const { return pidEnabled; }
@@ -41,9 +94,21 @@ public:
     float getLeftVelocityError() const { return leftVelError; }
     float getRightVelocityError() const { return rightVelError; }
     
+    // Encoder sample taken by the last control tick; safe to read from any core
+    EncoderSnapshot getSnapshot() const { return publishedSnapshot.read(); }
+    
 private:
+    static constexpr float PID_CORRECTION_LIMIT = 100.0f;  // PWM the PID may add to or take from the feedforward
+    
     Encoder* leftEncoder;
     Encoder* rightEncoder;
+    EncoderSnapshot snapshot;
+    SeqLock<EncoderSnapshot> publishedSnapshot;
+    
+    SetpointMailbox setpoints;
+    uint32_t appliedSeq;
+    volatile Setpoint::Mode activeMode;
+    volatile bool motorsInhibited;
 
     float targetLeftVel;
     float targetRightVel;
@@ -51,10 +116,35 @@ private:
     float feedforwardGain;
     float deadzonePWM;
     
-    Polynomial pwmToVelocityPoly;
-    Polynomial velocityToPWMPoly;
+    // Everything the tick reads for one wheel and direction, edited off to the side and then swapped in whole
+    struct MappingModel {
+        Polynomial pwmToVelocity;
+        Polynomial velocityToPWM;
+        LookupTable velocityToPWMTable;
+    };
+    
+    // Indexed by MotorMapping
+    MappingModel mappingModels[MOTOR_MAPPING_COUNT][2];
+    std::atomic<int> activeModel[MOTOR_MAPPING_COUNT];
+    std::atomic<uint32_t> mappingReadSeq;  // odd while the tick may be reading a mapping
     bool usePolynomialMapping;
     
+    volatile bool voltageCompensationEnabled;
+    float nominalVoltage;
+    float supplyVoltage;
+    volatile float voltageScale;
+    
+    bool useLookupTable;
+    
+    MotorModelEstimator onlineModels[MOTOR_MAPPING_COUNT];  // indexed by MotorMapping
+    volatile bool onlineIdEnabled;
+    volatile bool onlineIdResetRequested;
+    
+    std::atomic<ControlTickHook*> tickHook;
+    std::atomic<VelocitySetpointSource*> setpointSource;
+    std::atomic<bool> tickHookRunning;  // covers the setpoint source too
+    bool setpointSourceActive;          // control task
+    
     PIDController leftPID;
     PIDController rightPID;
     bool pidEnabled;
@@ -65,7 +155,15 @@ private:
     float leftVelError;
     float rightVelError;
     
-    float velocityToPWM(float velocity);
+    float velocityToPWM(float velocity, bool left);
+    void runVelocityLoop(bool haveEncoders, float dt);
+    const MappingModel& activeMapping(MotorMapping mapping) const {
+        return mappingModels[(int)mapping][activeModel[(int)mapping].load(std::memory_order_acquire)];
+    }
+    MappingModel& spareMapping(MotorMapping mapping);
+    void publishMapping(MotorMapping mapping);
+    static float rebuildLookupTable(MappingModel& model);
+    void applySetpoint(const Setpoint& setpoint);
 };
 
 #endif
@@ -0,0 +1,16 @@
+#ifndef VELOCITYSETPOINTSOURCE_H
+#define VELOCITYSETPOINTSOURCE_H
+
+#include "../hardware/Encoder.h"
+
+/**
+ * Generates the wheel velocity setpoints at the control rate, ahead of the velocity loop
+ * Called from the control task with the tick's encoder sample; writes left/right targets in cm/s
+ */
+class VelocitySetpointSource {
+public:
+    virtual ~VelocitySetpointSource() = default;
+    virtual void nextSetpoint(const EncoderSnapshot& snapshot, float dt, float& leftVelocity, float& rightVelocity) = 0;
+};
+
+#endif
@@ -1,21 +1,167 @@
 #include "BatteryMonitor.h"
 #include "../network/Telemetry.h"
+#include <driver/adc.h>
+#include <algorithm>
+
+namespace {
+    struct SocPoint {
+        float cellVoltage;
+        float percent;
+    };
+
+    // Resting LiPo cell voltage vs. state of charge
+    const SocPoint SOC_CURVE[] = {
+        {3.30f, 0},  {3.61f, 5},  {3.69f, 10}, {3.73f, 20}, {3.77f, 30}, {3.80f, 40},
+        {3.84f, 50}, {3.87f, 60}, {3.95f, 70}, {4.02f, 80}, {4.11f, 90}, {4.20f, 100}
+    };
+    const int SOC_POINTS = sizeof(SOC_CURVE) / sizeof(SOC_CURVE[0]);
+}
 
 BatteryMonitor::BatteryMonitor(uint8_t pin, float multiplier) 
-    : adcPin(pin), voltageMultiplier(multiplier) {}
+    : adcPin(pin), voltageMultiplier(multiplier), adcChars(), continuous(false), taskHandle(nullptr),
+      voltage(0), stateOfCharge(0), low(false), block() {}
 
 void BatteryMonitor::begin() {
-    pinMode(adcPin, INPUT);
-    analogReadResolution(12);
-    analogSetAttenuation(ADC_11db);  // Set ADC to read up to 3.3V
-    
     esp_adc_cal_characterize(ADC_UNIT_1, ADC_ATTEN_DB_12, ADC_WIDTH_BIT_12, 1100, &adcChars);
     
-    TELEM_LOG("✓ Battery monitor initialized (readings may be erratic)");
+    continuous = beginContinuous();
+    if (!continuous) {
+        pinMode(adcPin, INPUT);
+        analogReadResolution(12);
+        analogSetAttenuation(ADC_11db);  // Set ADC to read up to 3.3V
+    }
+    
+    if (xTaskCreatePinnedToCore(taskEntry, "battery", 3072, this, BATTERY_TASK_PRIORITY, &taskHandle, BATTERY_TASK_CORE) != pdPASS) {
+        TELEM_LOG_ERROR("Battery sampler task creation failed");
+        return;
+    }
+    
+    TELEM_LOGF("✓ Battery monitor initialized (%s, %d-sample median)",
+               continuous ? "continuous ADC" : "oneshot ADC fallback", BATTERY_OVERSAMPLE);
+}
+
+bool BatteryMonitor::beginContinuous() {
+    int channel = digitalPinToAnalogChannel(adcPin);
+    if (channel < 0 || channel >= SOC_ADC_CHANNEL_NUM(0)) {
+        TELEM_LOGF_WARNING("Battery pin %d is not on ADC1", adcPin);
+        return false;
+    }
+    
+    adc_digi_init_config_t init = {};
+    init.max_store_buf_size = BATTERY_OVERSAMPLE * SOC_ADC_DIGI_RESULT_BYTES * 4;
+    init.conv_num_each_intr = BATTERY_OVERSAMPLE * SOC_ADC_DIGI_RESULT_BYTES;
+    init.adc1_chan_mask = 1UL << channel;
+    init.adc2_chan_mask = 0;
+    if (adc_digi_initialize(&init) != ESP_OK) {
+        TELEM_LOG_WARNING("Continuous ADC init failed");
+        return false;
+    }
+    
+    adc_digi_pattern_config_t pattern = {};
+    pattern.atten = ADC_ATTEN_DB_12;
+    pattern.channel = channel;
+    pattern.unit = 0;
+    pattern.bit_width = SOC_ADC_DIGI_MAX_BITWIDTH;
+    
+    adc_digi_configuration_t config = {};
+    config.conv_limit_en = false;
+    config.conv_limit_num = 250;
+    config.pattern_num = 1;
+    config.adc_pattern = &pattern;
+    config.sample_freq_hz = BATTERY_ADC_SAMPLE_HZ;
+    config.conv_mode = ADC_CONV_SINGLE_UNIT_1;
+    config.format = ADC_DIGI_OUTPUT_FORMAT_TYPE2;
+    
+    if (adc_digi_controller_configure(&config) != ESP_OK || adc_digi_start() != ESP_OK) {
+        TELEM_LOG_WARNING("Continuous ADC start failed");
+        adc_digi_deinitialize();
+        return false;
+    }
+    return true;
+}
+
+void BatteryMonitor::taskEntry(void* arg) {
+    static_cast<BatteryMonitor*>(arg)->run();
+}
+
+void BatteryMonitor::run() {
+    uint32_t lastUs = micros();
+    
+    for (;;) {
+        int count = continuous ? readContinuousBlock() : readOneshotBlock();
+        if (count == 0) continue;
+        
+        // The median rejects WiFi and PWM spikes that an average would smear into the reading
+        uint16_t* middle = block + count / 2;
+        std::nth_element(block, middle, block + count);
+        
+        uint32_t now = micros();
+        publish(*middle, (now - lastUs) * 1e-6f);
+        lastUs = now;
+    }
+}
+
+int BatteryMonitor::readContinuousBlock() {
+    uint8_t buffer[BATTERY_OVERSAMPLE * SOC_ADC_DIGI_RESULT_BYTES];
+    uint32_t length = 0;
+    
+    // INVALID_STATE reports that the driver's pool overflowed; the returned data is still valid
+    esp_err_t err = adc_digi_read_bytes(buffer, sizeof(buffer), &length, 100);
+    if (err != ESP_OK && err != ESP_ERR_INVALID_STATE) {
+        return 0;
+    }
+    
+    int channel = digitalPinToAnalogChannel(adcPin);
+    int count = 0;
+    for (uint32_t i = 0; i + SOC_ADC_DIGI_RESULT_BYTES <= length; i += SOC_ADC_DIGI_RESULT_BYTES) {
+        const adc_digi_output_data_t* sample = reinterpret_cast<const adc_digi_output_data_t*>(&buffer[i]);
+        if (sample->type2.unit == 0 && sample->type2.channel == channel) {
+            block[count++] = sample->type2.data;
+        }
+    }
+    return count;
+}
+
+int BatteryMonitor::readOneshotBlock() {
+    for (int i = 0; i < BATTERY_OVERSAMPLE; i++) {
+        block[i] = analogRead(adcPin);
+    }
+    vTaskDelay(pdMS_TO_TICKS(BATTERY_OVERSAMPLE * 1000 / BATTERY_ADC_SAMPLE_HZ + 1));
+    return BATTERY_OVERSAMPLE;
 }
 
-float BatteryMonitor::getVoltage() {
-    int adcValue = analogRead(adcPin);
-    uint32_t voltage_mv = esp_adc_cal_raw_to_voltage(adcValue, &adcChars);
-    return (voltage_mv / 1000.0) * voltageMultiplier;
+void BatteryMonitor::publish(uint16_t raw, float dt) {
+    float sample = esp_adc_cal_raw_to_voltage(raw, &adcChars) / 1000.0f * voltageMultiplier;
+    
+    // First reading, or the pack was just plugged in: start from it instead of ramping up from zero
+    float filtered = voltage;
+    if (filtered < BATTERY_PRESENT_VOLTAGE) {
+        filtered = sample;
+    } else {
+        filtered += dt / (BATTERY_FILTER_TIME_CONSTANT + dt) * (sample - filtered);
+    }
+    voltage = filtered;
+    
+    float cellVoltage = filtered / BATTERY_CELL_COUNT;
+    stateOfCharge = stateOfChargeForCellVoltage(cellVoltage);
+    
+    if (filtered < BATTERY_PRESENT_VOLTAGE) {
+        low = false;
+    } else if (low) {
+        low = cellVoltage < BATTERY_LOW_CELL_VOLTAGE + BATTERY_LOW_HYSTERESIS;
+    } else {
+        low = cellVoltage < BATTERY_LOW_CELL_VOLTAGE;
+    }
+}
+
+float BatteryMonitor::stateOfChargeForCellVoltage(float cellVoltage) {
+    if (cellVoltage <= SOC_CURVE[0].cellVoltage) return 0;
+    if (cellVoltage >= SOC_CURVE[SOC_POINTS - 1].cellVoltage) return 100;
+    
+    int i = 1;
+    while (cellVoltage > SOC_CURVE[i].cellVoltage) i++;
+    
+    const SocPoint& a = SOC_CURVE[i - 1];
+    const SocPoint& b = SOC_CURVE[i];
+    return a.percent + (cellVoltage - a.cellVoltage) / (b.cellVoltage - a.cellVoltage) * (b.percent - a.percent);
 }
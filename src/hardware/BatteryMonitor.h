@@ -3,17 +3,50 @@
 
 #include <Arduino.h>
 #include <esp_adc_cal.h>
+#include "config.h"
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
 
+/**
+ * Battery voltage sampler
+ * A background task oversamples the divider with the ADC in continuous (DMA) mode, takes the median of each block
+ * and low-pass filters the medians. Readers only load the published values, so they are safe from any task and ISR-free.
+ * Falls back to oneshot reads in the same task if the continuous driver cannot be started.
+ */
 class BatteryMonitor {
 public:
     BatteryMonitor(uint8_t pin, float multiplier);
     void begin();
-    float getVoltage();
+
+    float getVoltage() const { return voltage; }
+    float getStateOfCharge() const { return stateOfCharge; }  // percent, from the per-cell resting voltage curve
+    bool isPresent() const { return voltage >= BATTERY_PRESENT_VOLTAGE; }
+    // Set below BATTERY_LOW_CELL_VOLTAGE per cell, cleared once back above it plus the hysteresis
+    bool isLow() const { return low; }
+    bool isContinuous() const { return continuous; }
+
+    static float stateOfChargeForCellVoltage(float cellVoltage);
 
 private:
     uint8_t adcPin;
     float voltageMultiplier;
     esp_adc_cal_characteristics_t adcChars;
+    bool continuous;
+    TaskHandle_t taskHandle;
+
+    volatile float voltage;
+    volatile float stateOfCharge;
+    volatile bool low;
+
+    uint16_t block[BATTERY_OVERSAMPLE];
+
+    bool beginContinuous();
+    int readContinuousBlock();
+    int readOneshotBlock();
+    void publish(uint16_t raw, float dt);
+
+    static void taskEntry(void* arg);
+    void run();
 };
 
 #endif
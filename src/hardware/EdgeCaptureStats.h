@@ -0,0 +1,56 @@
+#ifndef EDGE_CAPTURE_STATS_H
+#define EDGE_CAPTURE_STATS_H
+
+#include "Encoder.h"
+
+/**
+ * Running summary of the edge records drained from one encoder while capture is on
+ * A healthy quadrature encoder splits its edges evenly between A and B; the shortest
+ * interval shows how close bounce or noise comes to the PCNT glitch filter
+ */
+struct EdgeCaptureStats {
+    bool active = false;
+    unsigned long edges = 0;
+    unsigned long channelA = 0;
+    unsigned long channelB = 0;
+    long net = 0;                  // forward minus backward edges
+    uint32_t minIntervalUs = 0;    // 0 until two edges have been seen
+    uint32_t lastEdgeUs = 0;
+
+    void add(const Encoder::EdgeRecord& record) {
+        if (edges > 0) {
+            uint32_t interval = record.timestampUs - lastEdgeUs;
+            if (minIntervalUs == 0 || interval < minIntervalUs) minIntervalUs = interval;
+        }
+        lastEdgeUs = record.timestampUs;
+        edges++;
+        net += record.direction;
+        if (record.channel == 0) {
+            channelA++;
+        } else {
+            channelB++;
+        }
+    }
+
+    // Consumer side of the encoder's ring: starts a fresh summary each time capture is switched on
+    void drain(Encoder& encoder) {
+        if (!encoder.isEdgeCaptureEnabled()) {
+            active = false;
+            return;
+        }
+        if (!active) {
+            *this = EdgeCaptureStats();
+            active = true;
+        }
+
+        Encoder::EdgeRecord records[32];
+        size_t n;
+        while ((n = encoder.drainEdges(records, 32)) > 0) {
+            for (size_t i = 0; i < n; i++) {
+                add(records[i]);
+            }
+        }
+    }
+};
+
+#endif
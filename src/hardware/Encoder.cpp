@@ -1,121 +1,286 @@
 #include "Encoder.h"
+#include "config.h"
+#include <driver/pcnt.h>
+#include <soc/gpio_reg.h>
 
-Encoder* Encoder::leftInstance = nullptr;
-Encoder* Encoder::rightInstance = nullptr;
+static constexpr int16_t PCNT_LIMIT = 30000;
+
+// Quadrature step indexed by (previous AB << 2) | current AB; forward sequence is 00 -> 10 -> 11 -> 01.
+// ILLEGAL marks a double step (both channels changed between reads), where direction is unknown.
+static constexpr int8_t ILLEGAL = 2;
+DRAM_ATTR static const int8_t QUADRATURE_TABLE[16] = {
+     0, -1,  1, ILLEGAL,
+     1,  0, ILLEGAL, -1,
+    -1, ILLEGAL,  0,  1,
+    ILLEGAL,  1, -1,  0
+};
+
+static volatile uint32_t* inputRegisterFor(int pin) {
+    return (volatile uint32_t*)(pin < 32 ? GPIO_IN_REG : GPIO_IN1_REG);
+}
+
+Encoder* Encoder::instances[Encoder::MAX_ENCODERS] = {};
+int Encoder::registeredCount = 0;
+int Encoder::nextPcntUnit = 0;
 
 Encoder::Encoder(int pinA, int pinB, int ppr, float wheelDiameter, bool reversed)
     : pinA(pinA), pinB(pinB), ppr(ppr), wheelDiameter(wheelDiameter), reversed(reversed),
-      count(0), lastA(0), lastB(0), lastTimeMs(0), lastCount(0), velocity(0.0) {}
+      count(0), lastState(0), illegalTransitions(0), edgeSeq(0), lastEdgeUs(0),
+      edgeCaptureEnabled(false), edgeOverruns(0),
+      inputRegA(inputRegisterFor(pinA)), inputRegB(inputRegisterFor(pinB)),
+      shiftA(pinA % 32), shiftB(pinB % 32), pcntUnit(-1), pcntAccumulator(PCNT_LIMIT),
+      lastTimeMs(0), lastCount(0), velocity(0.0), distancePerCount(PI * wheelDiameter / ppr),
+      velocityMode(ENCODER_EDGE_TIMED_VELOCITY ? VelocityMode::EdgeTimed : VelocityMode::Windowed),
+      estimateCount(0), estimateEdgeUs(0), slot(-1) {}
 
 void Encoder::begin() {
     pinMode(pinA, INPUT_PULLUP);
     pinMode(pinB, INPUT_PULLUP);
     
-    lastA = digitalRead(pinA);
-    lastB = digitalRead(pinB);
+#if ENCODER_USE_PCNT
+    beginPulseCounter();
+#else
+    lastState = readState();
     
-    if (this == leftInstance) {
-        attachInterrupt(digitalPinToInterrupt(pinA), isrA_Left, CHANGE);
-        attachInterrupt(digitalPinToInterrupt(pinB), isrB_Left, CHANGE);
-    } else if (this == rightInstance) {
-        attachInterrupt(digitalPinToInterrupt(pinA), isrA_Right, CHANGE);
-        attachInterrupt(digitalPinToInterrupt(pinB), isrB_Right, CHANGE);
+    if (slot < 0) {
+        if (registeredCount >= MAX_ENCODERS) {
+            Serial.printf("Encoder: all %d ISR slots in use, raise ENCODER_COUNT\n", MAX_ENCODERS);
+            return;
+        }
+        slot = registeredCount++;
+        instances[slot] = this;
     }
     
+    IsrFunction isr = isrForSlot(slot, std::make_integer_sequence<int, MAX_ENCODERS>());
+    attachInterrupt(digitalPinToInterrupt(pinA), isr, CHANGE);
+    attachInterrupt(digitalPinToInterrupt(pinB), isr, CHANGE);
+#endif
+    
     lastTimeMs = millis();
 }
 
 void Encoder::update() {
+    // The PCNT backend has no per-edge timestamps, so it always uses the fixed window
+    if (velocityMode == VelocityMode::EdgeTimed && pcntUnit < 0) {
+        updateEdgeTimed();
+    } else {
+        updateWindowed();
+    }
+}
+
+void Encoder::updateWindowed() {
     unsigned long currentTime = millis();
     unsigned long deltaTime = currentTime - lastTimeMs;
 
     if (deltaTime >= UPDATE_INTERVAL_MS)
     {
-        long deltaCount = count - lastCount;
+        long currentCount = getCount();
+        long deltaCount = currentCount - lastCount;
         float revolutions = (float)deltaCount / ppr;
         float distance = revolutions * PI * wheelDiameter;
         float timeSec = deltaTime / 1000.0;
         
         velocity = distance / timeSec;
         
-        lastCount = count;
+        lastCount = currentCount;
         lastTimeMs = currentTime;
     }
 }
 
-float Encoder::getDistance() const {
-    float revolutions = (float)count / ppr;
-    return revolutions * PI * wheelDiameter;  // cm
-}
-
-float Encoder::getRPM() const {
-    float circumference = PI * wheelDiameter;
-    float rps = velocity / circumference;
-    return rps * 60.0;
-}
-
-void Encoder::handleInterruptA() {
-    int A = digitalRead(pinA);
-    int B = digitalRead(pinB);
-    
-    if (A != lastA) {
-        int direction = 0;
-        if (A == HIGH) {
-            if (B == LOW) {
-                direction = 1;
-            } else {
-                direction = -1;
-            }
-        } else {
-            if (B == HIGH) {
-                direction = 1;
-            } else {
-                direction = -1;
-            }
-        }
+// At speed several edges land between calls and this is count differencing over an exact edge-to-edge span;
+// at crawl speed it degenerates to edge period measurement. Between edges the estimate is capped by
+// one count over the time since the last edge, so it decays to zero instead of holding a stale value.
+void Encoder::updateEdgeTimed() {
+    long edgeCount;
+    uint32_t edgeUs;
+    readEdge(edgeCount, edgeUs);
+    
+    long deltaCount = edgeCount - estimateCount;
+    uint32_t span = edgeUs - estimateEdgeUs;
+    
+    if (deltaCount != 0 && (labs(deltaCount) >= EDGE_MIN_COUNTS || span >= EDGE_MAX_WINDOW_US)) {
+        velocity = deltaCount * distancePerCount / (span * 1e-6f);
+        estimateCount = edgeCount;
+        estimateEdgeUs = edgeUs;
+        return;
+    }
+    
+    uint32_t sinceEdge = micros() - edgeUs;
+    if (sinceEdge >= EDGE_STALL_TIMEOUT_US) {
+        velocity = 0;
+        estimateCount = edgeCount;
+        estimateEdgeUs = edgeUs;
+        return;
+    }
     
-        count += reversed ? -direction : direction;
-        lastA = A;
+    float bound = distancePerCount / (sinceEdge * 1e-6f);
+    if (fabsf(velocity) > bound) {
+        velocity = copysignf(bound, velocity);
     }
 }
 
-void Encoder::handleInterruptB() {
-    int A = digitalRead(pinA);
-    int B = digitalRead(pinB);
-    
-    if (B != lastB) {
-        int direction = 0;
-        if (B == HIGH) {
-            if (A == HIGH) {
-                direction = 1;
-            } else {
-                direction = -1;
-            }
-        } else {
-            if (A == LOW) {
-                direction = 1;
-            } else {
-                direction = -1;
-            }
+long Encoder::getCount() const {
+    if (pcntUnit >= 0) {
+        return readPulseCounter();
+    }
+    return count;
+}
+
+void Encoder::reset() {
+    if (pcntUnit >= 0) {
+        pcnt_counter_pause((pcnt_unit_t)pcntUnit);
+        pcnt_counter_clear((pcnt_unit_t)pcntUnit);
+        pcntAccumulator.reset();
+        pcnt_counter_resume((pcnt_unit_t)pcntUnit);
+    }
+    count = 0;
+    lastCount = 0;
+    estimateCount = 0;
+    illegalTransitions = 0;
+}
+
+void Encoder::enableEdgeCapture(bool enable) {
+    if (enable && !edgeCaptureEnabled) {
+        edgeBuffer.clear();
+        edgeOverruns = 0;
+    }
+    edgeCaptureEnabled = enable;
+}
+
+float Encoder::getDistance() const {
+    return countsToDistance(getCount());  // cm
+}
+
+EncoderSnapshot Encoder::capture(const Encoder& left, const Encoder& right) {
+    EncoderSnapshot snapshot;
+    uint32_t leftSeq;
+    uint32_t rightSeq;
+    
+    do {
+        leftSeq = left.edgeSeq;
+        rightSeq = right.edgeSeq;
+        snapshot.leftCount = left.getCount();
+        snapshot.rightCount = right.getCount();
+        snapshot.timestampUs = micros();
+    } while (((leftSeq | rightSeq) & 1) || leftSeq != left.edgeSeq || rightSeq != right.edgeSeq);
+    
+    snapshot.leftDistance = left.countsToDistance(snapshot.leftCount);
+    snapshot.rightDistance = right.countsToDistance(snapshot.rightCount);
+    snapshot.leftVelocity = left.velocity;
+    snapshot.rightVelocity = right.velocity;
+    return snapshot;
+}
+
+// Both pins usually share one GPIO input bank, so a single register load samples A and B together
+uint8_t IRAM_ATTR Encoder::readState() const {
+    uint32_t inA = *inputRegA;
+    uint32_t inB = (inputRegB == inputRegA) ? inA : *inputRegB;
+    return (((inA >> shiftA) & 1) << 1) | ((inB >> shiftB) & 1);
+}
+
+// edgeSeq is odd while count and lastEdgeUs are being written, so readers can take a consistent pair
+void IRAM_ATTR Encoder::handleInterrupt() {
+    uint8_t previous = lastState;
+    uint8_t state = readState();
+    int8_t step = QUADRATURE_TABLE[(previous << 2) | state];
+    lastState = state;
+    
+    if (step == ILLEGAL) {
+        illegalTransitions = illegalTransitions + 1;
+        return;
+    }
+    
+    int8_t direction = reversed ? -step : step;
+    uint32_t now = micros();
+    
+    edgeSeq = edgeSeq + 1;
+    count += direction;
+    lastEdgeUs = now;
+    edgeSeq = edgeSeq + 1;
+    
+    if (edgeCaptureEnabled) {
+        // A legal step flips exactly one channel; bit 1 of the state is A
+        uint8_t channel = ((state ^ previous) & 0b10) ? 0 : 1;
+        if (!edgeBuffer.push({now, direction, channel})) {
+            edgeOverruns = edgeOverruns + 1;
         }
-        
-        count += reversed ? -direction : direction;
-        lastB = B;
     }
 }
 
-void IRAM_ATTR Encoder::isrA_Left() {
-    if (leftInstance) leftInstance->handleInterruptA();
+void Encoder::readEdge(long& edgeCount, uint32_t& edgeUs) const {
+    uint32_t seq;
+    do {
+        seq = edgeSeq;
+        edgeCount = count;
+        edgeUs = lastEdgeUs;
+    } while ((seq & 1) || seq != edgeSeq);
 }
 
-void IRAM_ATTR Encoder::isrB_Left() {
-    if (leftInstance) leftInstance->handleInterruptB();
+// Full 4x quadrature on one PCNT unit: channel 0 counts A edges gated by B, channel 1 counts B edges gated by A.
+// Direction convention matches QUADRATURE_TABLE used by handleInterrupt() (A rising while B low counts up).
+void Encoder::beginPulseCounter() {
+    if (nextPcntUnit >= PCNT_UNIT_MAX) {
+        Serial.println("Encoder: no free PCNT unit");
+        return;
+    }
+    pcntUnit = nextPcntUnit++;
+    pcnt_unit_t unit = (pcnt_unit_t)pcntUnit;
+    
+    pcnt_config_t config = {};
+    config.unit = unit;
+    config.counter_h_lim = PCNT_LIMIT;
+    config.counter_l_lim = -PCNT_LIMIT;
+    
+    config.channel = PCNT_CHANNEL_0;
+    config.pulse_gpio_num = pinA;
+    config.ctrl_gpio_num = pinB;
+    config.pos_mode = PCNT_COUNT_DEC;
+    config.neg_mode = PCNT_COUNT_INC;
+    config.hctrl_mode = PCNT_MODE_KEEP;
+    config.lctrl_mode = PCNT_MODE_REVERSE;
+    pcnt_unit_config(&config);
+    
+    config.channel = PCNT_CHANNEL_1;
+    config.pulse_gpio_num = pinB;
+    config.ctrl_gpio_num = pinA;
+    config.pos_mode = PCNT_COUNT_INC;
+    config.neg_mode = PCNT_COUNT_DEC;
+    pcnt_unit_config(&config);
+    
+    pcnt_set_filter_value(unit, ENCODER_PCNT_FILTER);
+    pcnt_filter_enable(unit);
+    
+    pcnt_event_enable(unit, PCNT_EVT_H_LIM);
+    pcnt_event_enable(unit, PCNT_EVT_L_LIM);
+    
+    pcnt_counter_pause(unit);
+    pcnt_counter_clear(unit);
+    
+    // Shared ISR service; ESP_ERR_INVALID_STATE just means another encoder installed it
+    pcnt_isr_service_install(0);
+    pcnt_isr_handler_add(unit, pcntLimitISR, this);
+    
+    pcnt_counter_resume(unit);
 }
 
-void IRAM_ATTR Encoder::isrA_Right() {
-    if (rightInstance) rightInstance->handleInterruptA();
+long Encoder::readPulseCounter() const {
+    pcnt_unit_t unit = (pcnt_unit_t)pcntUnit;
+    int64_t total = pcntAccumulator.read([unit]() {
+        int16_t raw = 0;
+        pcnt_get_counter_value(unit, &raw);
+        return raw;
+    });
+    return reversed ? -total : total;
 }
 
-void IRAM_ATTR Encoder::isrB_Right() {
-    if (rightInstance) rightInstance->handleInterruptB();
+void Encoder::pcntLimitISR(void* arg) {
+    Encoder* encoder = static_cast<Encoder*>(arg);
+    uint32_t status = 0;
+    pcnt_get_event_status((pcnt_unit_t)encoder->pcntUnit, &status);
+    
+    if (status & PCNT_EVT_H_LIM) {
+        encoder->pcntAccumulator.onHighLimit();
+    } else if (status & PCNT_EVT_L_LIM) {
+        encoder->pcntAccumulator.onLowLimit();
+    }
 }
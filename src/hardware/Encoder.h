@@ -2,10 +2,42 @@
 #define ENCODER_H
 
 #include <Arduino.h>
+#include <utility>
+#include "config.h"
+#include "PulseCounterAccumulator.h"
+#include "../utils/SpscRingBuffer.h"
+
+/**
+ * Coherent sample of both wheel encoders taken at one instant
+ */
+struct EncoderSnapshot {
+    long leftCount;
+    long rightCount;
+    float leftDistance;   // cm
+    float rightDistance;  // cm
+    float leftVelocity;   // cm/s
+    float rightVelocity;  // cm/s
+    uint32_t timestampUs;
+};
 
 class Encoder {
+public:
+    enum class VelocityMode {
+        Windowed,   // count difference over UPDATE_INTERVAL_MS
+        EdgeTimed   // counts over the exact span between ISR edge timestamps, refreshed every update()
+    };
+    
+    struct EdgeRecord {
+        uint32_t timestampUs;
+        int8_t direction;  // +1 / -1 after the reversed flag is applied
+        uint8_t channel;   // 0 = A, 1 = B
+    };
+
 private:
     static constexpr unsigned long UPDATE_INTERVAL_MS = 100;
+    static constexpr long EDGE_MIN_COUNTS = 4;
+    static constexpr uint32_t EDGE_MAX_WINDOW_US = 20000;
+    static constexpr uint32_t EDGE_STALL_TIMEOUT_US = 250000;
     int pinA;
     int pinB;
     int ppr;
@@ -13,23 +45,61 @@ private:
     bool reversed;
     
     volatile long count;
-    volatile int lastA;
-    volatile int lastB;
+    volatile uint8_t lastState;
+    volatile unsigned long illegalTransitions;
+    volatile uint32_t edgeSeq;
+    volatile uint32_t lastEdgeUs;
+    
+    SpscRingBuffer<EdgeRecord, ENCODER_EDGE_BUFFER_SIZE> edgeBuffer;
+    volatile bool edgeCaptureEnabled;
+    volatile unsigned long edgeOverruns;
+    
+    volatile uint32_t* inputRegA;
+    volatile uint32_t* inputRegB;
+    uint8_t shiftA;
+    uint8_t shiftB;
+    
+    int pcntUnit;
+    PulseCounterAccumulator pcntAccumulator;
     
     unsigned long lastTimeMs;
     long lastCount;
     float velocity;
+    float distancePerCount;
+    
+    VelocityMode velocityMode;
+    long estimateCount;
+    uint32_t estimateEdgeUs;
+    
+    using IsrFunction = void (*)();
+    static constexpr int MAX_ENCODERS = ENCODER_COUNT;
+    static Encoder* instances[MAX_ENCODERS];
+    static int registeredCount;
+    int slot;
+    
+    // One trampoline per slot, so the ISR is a fixed-address load and a direct call
+    template<int Slot>
+    static void IRAM_ATTR isrTrampoline() {
+        Encoder* encoder = instances[Slot];
+        if (encoder) encoder->handleInterrupt();
+    }
     
-    static void IRAM_ATTR isrA_Left();
-    static void IRAM_ATTR isrB_Left();
-    static void IRAM_ATTR isrA_Right();
-    static void IRAM_ATTR isrB_Right();
+    template<int... Slots>
+    static IsrFunction isrForSlot(int index, std::integer_sequence<int, Slots...>) {
+        static const IsrFunction table[] = { &isrTrampoline<Slots>... };
+        return table[index];
+    }
     
-    static Encoder* leftInstance;
-    static Encoder* rightInstance;
+    void handleInterrupt();
+    uint8_t readState() const;
+    void readEdge(long& edgeCount, uint32_t& edgeUs) const;
+    void updateWindowed();
+    void updateEdgeTimed();
     
-    void handleInterruptA();
-    void handleInterruptB();
+    void beginPulseCounter();
+    long readPulseCounter() const;
+    static void pcntLimitISR(void* arg);
+    static int nextPcntUnit;
 
 public:
     Encoder(int pinA, int pinB, int ppr, float wheelDiameter, bool reversed = false);
@@ -37,18 +107,33 @@ public:
     void begin();
     void update();
     
-    long getCount() const { return count; }
-    float getRevolutions() const { return (float)count / ppr; }
-    float getDegrees() const { return (count % ppr) * (360.0 / ppr); }
-    float getRadians() const { return (count % ppr) * (2.0 * PI / ppr); }
+    long getCount() const;
+    float getRevolutions() const { return countsToRevolutions(getCount()); }
+    float getDegrees() const { return (getCount() % ppr) * (360.0 / ppr); }
+    float getRadians() const { return (getCount() % ppr) * (2.0 * PI / ppr); }
     float getDistance() const;
     float getVelocity() const { return velocity; }
-    float getRPM() const;
+    float getRPM() const { return velocityToRPM(velocity); }
+    
+    float countsToRevolutions(long counts) const { return (float)counts / ppr; }
+    float countsToDistance(long counts) const { return counts * distancePerCount; }
+    float velocityToRPM(float vel) const { return vel / (PI * wheelDiameter) * 60.0f; }
+    
+    // Counts are read under both encoders' edge sequence counters so no edge lands between the two reads
+    static EncoderSnapshot capture(const Encoder& left, const Encoder& right);
+    unsigned long getIllegalTransitions() const { return illegalTransitions; }
+    
+    // Edge capture is off by default so an undrained buffer does not count overruns
+    void enableEdgeCapture(bool enable);
+    bool isEdgeCaptureEnabled() const { return edgeCaptureEnabled; }
+    size_t drainEdges(EdgeRecord* out, size_t maxCount) { return edgeBuffer.drain(out, maxCount); }
+    unsigned long getEdgeOverruns() const { return edgeOverruns; }
     
-    void reset() { count = 0; lastCount = 0; }
+    void setVelocityMode(VelocityMode mode) { velocityMode = mode; }
+    VelocityMode getVelocityMode() const { return velocityMode; }
     
-    static void registerLeft(Encoder* enc) { leftInstance = enc; }
-    static void registerRight(Encoder* enc) { rightInstance = enc; }
+    void reset();
+    int getSlot() const { return slot; }
 };
 
 #endif
@@ -9,8 +9,12 @@ HardwareManager& HardwareManager::getInstance() {
 }
 
 HardwareManager::HardwareManager()
-    : leftEncoder(LEFT_ENCODER_A, LEFT_ENCODER_B, ENCODER_PPR, WHEEL_DIAMETER, false),
-      rightEncoder(RIGHT_ENCODER_A, RIGHT_ENCODER_B, ENCODER_PPR, WHEEL_DIAMETER, true),
+    : encoders{
+          {LEFT_ENCODER_A, LEFT_ENCODER_B, ENCODER_PPR, WHEEL_DIAMETER, false},
+          {RIGHT_ENCODER_A, RIGHT_ENCODER_B, ENCODER_PPR, WHEEL_DIAMETER, true}
+      },
+      leftEncoder(encoders[LEFT_ENCODER_INDEX]),
+      rightEncoder(encoders[RIGHT_ENCODER_INDEX]),
       batteryMonitor(BATTERY_VOLTAGE_PIN, BATTERY_VOLTAGE_MULTIPLIER),
       imu(IMU_CALIBRATION_SAMPLES),
       lastBroadcastTime(0),
@@ -20,31 +24,24 @@ HardwareManager::HardwareManager()
       lastHeading(0) {}
 
 void HardwareManager::begin() {
-    Encoder::registerLeft(&leftEncoder);
-    Encoder::registerRight(&rightEncoder);
-    
-    leftEncoder.begin();
-    rightEncoder.begin();
+    for (Encoder& encoder : encoders) {
+        encoder.begin();
+    }
     TELEM_LOG_INFO("Encoders initialized");
     
     batteryMonitor.begin();
     TELEM_LOG_INFO("Battery monitor initialized");
     
     if (imu.begin()) {
-        TELEM_LOG_INFO("IMU initialized - calibrating...");
-        imu.calibrate();
-        TELEM_LOG_INFO("IMU calibration complete");
+        TELEM_LOG_INFO("IMU initialized");
     } else {
         TELEM_LOG_ERROR("IMU initialization failed");
     }
 }
 
 void HardwareManager::update() {
-    leftEncoder.update();
-    rightEncoder.update();
-    
-    if (imu.isCalibrated()) {
-        imu.update();
+    for (Encoder& encoder : encoders) {
+        encoder.update();
     }
 }
 
@@ -67,39 +64,55 @@ void HardwareManager::broadcastTelemetry(WebSocketHandler* wsHandler) {
     StaticJsonDocument<512> doc;
     doc["type"] = "telemetry";
     
+    EncoderSnapshot snap = Encoder::capture(leftEncoder, rightEncoder);
+    
     JsonObject encoders = doc.createNestedObject("encoders");
     JsonObject left = encoders.createNestedObject("left");
-    left["count"] = leftEncoder.getCount();
-    left["revolutions"] = leftEncoder.getRevolutions();
-    left["distance"] = leftEncoder.getDistance();
-    left["velocity"] = leftEncoder.getVelocity();
-    left["rpm"] = leftEncoder.getRPM();
+    left["count"] = snap.leftCount;
+    left["revolutions"] = leftEncoder.countsToRevolutions(snap.leftCount);
+    left["distance"] = snap.leftDistance;
+    left["velocity"] = snap.leftVelocity;
+    left["rpm"] = leftEncoder.velocityToRPM(snap.leftVelocity);
+    left["illegal"] = leftEncoder.getIllegalTransitions();
+    left["edgeOverruns"] = leftEncoder.getEdgeOverruns();
     
     JsonObject right = encoders.createNestedObject("right");
-    right["count"] = rightEncoder.getCount();
-    right["revolutions"] = rightEncoder.getRevolutions();
-    right["distance"] = rightEncoder.getDistance();
-    right["velocity"] = rightEncoder.getVelocity();
-    right["rpm"] = rightEncoder.getRPM();
+    right["count"] = snap.rightCount;
+    right["revolutions"] = rightEncoder.countsToRevolutions(snap.rightCount);
+    right["distance"] = snap.rightDistance;
+    right["velocity"] = snap.rightVelocity;
+    right["rpm"] = rightEncoder.velocityToRPM(snap.rightVelocity);
+    right["illegal"] = rightEncoder.getIllegalTransitions();
+    right["edgeOverruns"] = rightEncoder.getEdgeOverruns();
     
     doc["battery"]["voltage"] = batteryMonitor.getVoltage();
+    doc["battery"]["soc"] = batteryMonitor.getStateOfCharge();
+    doc["battery"]["low"] = batteryMonitor.isLow();
     
-    if (imu.isCalibrated()) {
+    IMUSample sample = imu.getSample();
+    if (sample.calibrated) {
+        const IMU::Stats& imuStats = imu.getStats();
         JsonObject imuData = doc.createNestedObject("imu");
-        imuData["heading"] = imu.getHeading();
-        imuData["headingDegrees"] = imu.getHeadingDegrees();
-        imuData["gyroZ"] = imu.getGyroZ();
-        imuData["accelX"] = imu.getAccelX();
-        imuData["accelY"] = imu.getAccelY();
-        imuData["accelZ"] = imu.getAccelZ();
+        imuData["heading"] = sample.heading;
+        imuData["headingDegrees"] = sample.heading * RAD_TO_DEG;
+        imuData["roll"] = sample.roll;
+        imuData["pitch"] = sample.pitch;
+        imuData["tippedOver"] = sample.tippedOver;
+        imuData["gyroZ"] = sample.gyroZ;
+        imuData["accelX"] = sample.accelX;
+        imuData["accelY"] = sample.accelY;
+        imuData["accelZ"] = sample.accelZ;
+        imuData["latencyUs"] = imuStats.lastLatencyUs;
+        imuData["maxLatencyUs"] = imuStats.maxLatencyUs;
+        imuData["dropped"] = imuStats.droppedSamples;
     }
     
     wsHandler->broadcastJson(doc);
     
     lastVoltage = batteryMonitor.getVoltage();
-    lastLeftCount = leftEncoder.getCount();
-    lastRightCount = rightEncoder.getCount();
-    lastHeading = imu.getHeading();
+    lastLeftCount = snap.leftCount;
+    lastRightCount = snap.rightCount;
+    lastHeading = sample.heading;
     lastBroadcastTime = now;
 }
 
@@ -118,8 +131,9 @@ bool HardwareManager::hasSignificantChange() {
 }
 
 void HardwareManager::resetEncoders() {
-    leftEncoder.reset();
-    rightEncoder.reset();
+    for (Encoder& encoder : encoders) {
+        encoder.reset();
+    }
     lastLeftCount = 0;
     lastRightCount = 0;
     TELEM_LOG_INFO("Encoders reset");
@@ -17,6 +17,8 @@ public:
     void update();
     void broadcastTelemetry(WebSocketHandler* wsHandler);
     
+    Encoder* getEncoder(int index) { return &encoders[index]; }
+    int getEncoderCount() const { return ENCODER_COUNT; }
     Encoder* getLeftEncoder() { return &leftEncoder; }
     Encoder* getRightEncoder() { return &rightEncoder; }
     BatteryMonitor* getBatteryMonitor() { return &batteryMonitor; }
@@ -30,8 +32,9 @@ private:
     HardwareManager(const HardwareManager&) = delete;
     HardwareManager& operator=(const HardwareManager&) = delete;
     
-    Encoder leftEncoder;
-    Encoder rightEncoder;
+    Encoder encoders[ENCODER_COUNT];
+    Encoder& leftEncoder;
+    Encoder& rightEncoder;
     BatteryMonitor batteryMonitor;
     IMU imu;
     
@@ -45,7 +48,6 @@ private:
     long lastRightCount;
     float lastHeading;
     
-    static const int IMU_CALIBRATION_SAMPLES = 1000;
     static constexpr float VOLTAGE_THRESHOLD = 0.1;
     static constexpr long COUNT_THRESHOLD = 5;
     static constexpr float HEADING_THRESHOLD = 0.05;
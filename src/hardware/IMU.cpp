@@ -1,26 +1,68 @@
 #include "IMU.h"
 #include "config.h"
+#include "../network/Telemetry.h"
+#include <ArduinoJson.h>
+#include <LittleFS.h>
 
-IMU::IMU(int calibrationSamples) 
+namespace {
+    const char* const GYRO_BIAS_KEYS[3] = {"gyroXBias", "gyroYBias", "gyroZBias"};
+    const char* const GYRO_SLOPE_KEYS[3] = {"gyroXSlope", "gyroYSlope", "gyroZSlope"};
+    const char* const ACCEL_BIAS_KEYS[3] = {"accelXBias", "accelYBias", "accelZBias"};
+    
+    const float TIP_UPRIGHT = cosf(IMU_TIP_ANGLE * DEG_TO_RAD);
+    const float RECOVER_UPRIGHT = cosf(IMU_TIP_RECOVER_ANGLE * DEG_TO_RAD);
+    const int TIP_HOLD_SAMPLES = IMU_TIP_HOLD_MS * IMU_SAMPLE_RATE_HZ / 1000;
+}
+
+IMU::IMU(int calibrationSamples)
     : calibrationSamples(calibrationSamples),
-      calibrated(false),
-      gyroZBias(0),
-      accelXBias(0),
-      accelYBias(0),
-      accelZBias(0),
+      calibrationState(CalibrationState::Uncalibrated),
+      taskHandle(nullptr),
+      dataReadyMicros(0),
+      calibrationRequested(false),
+      resetStatsRequested(false),
+      stats(),
+      gyroBiasModels{TemperatureBiasModel(biasModelConfig()), TemperatureBiasModel(biasModelConfig()),
+                     TemperatureBiasModel(biasModelConfig())},
+      gyroBias{0, 0, 0},
+      accelBias{0, 0, 0},
+      attitude(attitudeConfig()),
+      attitudeInitialized(false),
       gyroZ(0),
-      accelX(0),
-      accelY(0),
-      accelZ(0),
-      accelXFiltered(0),
-      accelYFiltered(0),
-      accelZFiltered(0),
-      heading(0),
-      lastUpdateTime(0) {
+      accel{0, 0, 0},
+      temperature(0),
+      lastTemperatureRead(0),
+      headingSamples(0),
+      tipSamples(0),
+      tippedOver(false),
+      samplePeriod(1.0f / IMU_SAMPLE_RATE_HZ),
+      fifoStartMicros(0),
+      fifoSamples(0),
+      rateWindows(0),
+      lastDrainMicros(0),
+      fifoBuffer(),
+      window(),
+      wheelsMovedInWindow(false),
+      stillSamples(0),
+      totals(),
+      stationaryDrift(0),
+      biasRefinements(0),
+      savedGyroZBias(0),
+      savedTemperature(0),
+      lastSaveTime(0) {
+}
+
+TemperatureBiasModel::Config IMU::biasModelConfig() {
+    return {IMU_BIAS_FORGETTING, IMU_BIAS_SLOPE_PRIOR, IMU_BIAS_SLOPE_LIMIT * GYRO_SCALE};
+}
+
+MahonyFilter::Config IMU::attitudeConfig() {
+    return {IMU_ATTITUDE_KP, IMU_ATTITUDE_KI, IMU_ATTITUDE_INTEGRAL_LIMIT, IMU_ATTITUDE_ACCEL_TOLERANCE};
 }
 
 bool IMU::begin() {
     Wire.begin(IMU_SDA, IMU_SCL);
+    Wire.setClock(IMU_I2C_CLOCK_HZ);
     
     mpu.initialize();
     
@@ -31,58 +73,394 @@ bool IMU::begin() {
     mpu.setFullScaleGyroRange(MPU6050_GYRO_FS_250);
     mpu.setFullScaleAccelRange(MPU6050_ACCEL_FS_2);
     
-    lastUpdateTime = millis();
+    // The DLPF drops the gyro output rate to 1 kHz, which the divider then brings down to the FIFO rate
+    mpu.setDLPFMode(MPU6050_DLPF_BW_42);
+    mpu.setRate(1000 / IMU_SAMPLE_RATE_HZ - 1);
+    mpu.setAccelFIFOEnabled(true);
+    mpu.setXGyroFIFOEnabled(true);
+    mpu.setYGyroFIFOEnabled(true);
+    mpu.setZGyroFIFOEnabled(true);
+    mpu.setFIFOEnabled(true);
+    
+    // 50 us active-high pulse per sample
+    mpu.setInterruptMode(false);
+    mpu.setInterruptDrive(false);
+    mpu.setInterruptLatch(false);
+    mpu.setIntDataReadyEnabled(true);
+    
+    if (loadCalibration()) {
+        calibrationState = CalibrationState::Calibrated;
+        TELEM_LOGF_SUCCESS("IMU calibration restored at %.1f°C (%lu ms after boot)", temperature, millis());
+    } else {
+        startCalibration();
+    }
+    
+    startFifo();
+    lastDrainMicros = micros();
+    publish();
+    
+    if (xTaskCreatePinnedToCore(taskEntry, "imu", 4096, this, IMU_TASK_PRIORITY, &taskHandle, IMU_TASK_CORE) != pdPASS) {
+        TELEM_LOG_ERROR("IMU task creation failed");
+        return false;
+    }
+    
+    pinMode(IMU_INT, INPUT);
+    attachInterruptArg(digitalPinToInterrupt(IMU_INT), dataReadyISR, this, RISING);
     return true;
 }
 
+void IMU::requestCalibration() {
+    calibrationRequested = true;
+}
+
 void IMU::calibrate() {
-    int16_t ax, ay, az, gx, gy, gz;
-    long axSum = 0, aySum = 0, azSum = 0, gzSum = 0;
-    
-    for (int i = 0; i < calibrationSamples; i++) {
-        mpu.getMotion6(&ax, &ay, &az, &gx, &gy, &gz);
+    requestCalibration();
+    // Bounded so a robot that never sits still cannot hang the caller
+    unsigned long timeoutMs = calibrationSamples * 10000UL / IMU_SAMPLE_RATE_HZ;
+    unsigned long start = millis();
+    while ((calibrationRequested || calibrationState == CalibrationState::Collecting) && millis() - start < timeoutMs) {
+        delay(10);
+    }
+}
+
+void IRAM_ATTR IMU::dataReadyISR(void* arg) {
+    IMU* imu = static_cast<IMU*>(arg);
+    imu->dataReadyMicros = micros();
+    BaseType_t woken = pdFALSE;
+    vTaskNotifyGiveFromISR(imu->taskHandle, &woken);
+    if (woken) {
+        portYIELD_FROM_ISR();
+    }
+}
+
+void IMU::taskEntry(void* arg) {
+    static_cast<IMU*>(arg)->run();
+}
+
+// IMU task
+void IMU::run() {
+    uint32_t pendingSamples = 0;  // data-ready edges since the last drain, one FIFO sample each
+    for (;;) {
+        // Times out into polling if the INT line is not wired
+        uint32_t edges = ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(IMU_DATA_READY_TIMEOUT_MS));
+        bool interrupted = edges > 0;
+        uint32_t edgeUs = dataReadyMicros;
+        pendingSamples += edges;
+        
+        if (resetStatsRequested) {
+            stats = Stats();
+            resetStatsRequested = false;
+        }
+        if (!interrupted) {
+            stats.missedInterrupts++;
+        }
+        if (calibrationRequested) {
+            startCalibration();
+            calibrationRequested = false;
+        }
+        if (millis() - lastTemperatureRead >= IMU_TEMPERATURE_INTERVAL_MS) {
+            readTemperature();
+            updateGyroBias();
+        }
         
-        axSum += ax;
-        aySum += ay;
-        azSum += az;
-        gzSum += gz;
+        // Each drain costs a count read plus one burst, so let a few samples collect first
+        if (interrupted && pendingSamples < IMU_DRAIN_SAMPLES &&
+            micros() - lastDrainMicros < IMU_DATA_READY_TIMEOUT_MS * 1000UL) {
+            continue;
+        }
+        pendingSamples = 0;
+        
+        drainFifo();
+        publish();
+        
+        if (interrupted) {
+            recordLatency(micros() - edgeUs);
+        }
+    }
+}
+
+void IMU::startCalibration() {
+    stillSamples = 0;
+    for (double& total : totals) {
+        total = 0;
+    }
+    resetWindow();
+    calibrationState = CalibrationState::Collecting;
+    TELEM_LOG("Calibrating IMU in the background (keep still)...");
+}
+
+void IMU::drainFifo() {
+    uint16_t count = mpu.getFIFOCount();
+    unsigned long countMicros = micros();
+    if (count >= FIFO_SIZE) {
+        // A full FIFO has dropped its oldest bytes and sample boundaries are lost; the missed time is not integrated
+        stats.fifoOverflows++;
+        stats.droppedSamples += (uint32_t)((countMicros - lastDrainMicros) * 1e-6f / samplePeriod);
+        startFifo();
+        lastDrainMicros = countMicros;
+        return;
+    }
+    lastDrainMicros = countMicros;
+    
+    int available = count / FIFO_SAMPLE_BYTES;
+    while (available > 0) {
+        int burst = min(available, IMU_FIFO_BURST_SAMPLES);
+        mpu.getFIFOBytes(fifoBuffer, burst * FIFO_SAMPLE_BYTES);
+        for (int i = 0; i < burst; i++) {
+            const uint8_t* bytes = fifoBuffer + i * FIFO_SAMPLE_BYTES;
+            int16_t raw[6];
+            for (int axis = 0; axis < 6; axis++) {
+                raw[axis] = (int16_t)(bytes[2 * axis] << 8 | bytes[2 * axis + 1]);
+            }
+            processSample(raw);
+        }
+        available -= burst;
+    }
+    
+    // The sensor clock is only accurate to a few percent; time whole windows of it against micros()
+    fifoSamples += count / FIFO_SAMPLE_BYTES;
+    unsigned long elapsed = countMicros - fifoStartMicros;
+    if (elapsed >= IMU_RATE_ESTIMATE_MIN_US && fifoSamples > 0) {
+        float nominal = 1.0f / IMU_SAMPLE_RATE_HZ;
+        float measured = constrain(elapsed * 1e-6f / fifoSamples, 0.9f * nominal, 1.1f * nominal);
+        samplePeriod = rateWindows == 0 ? measured : samplePeriod + SAMPLE_PERIOD_ALPHA * (measured - samplePeriod);
+        rateWindows++;
+        fifoStartMicros = countMicros;
+        fifoSamples = 0;
+    }
+}
+
+void IMU::publish() {
+    bool calibrated = calibrationState == CalibrationState::Calibrated;
+    IMUSample sample;
+    sample.heading = calibrated ? attitude.getYaw() : 0;
+    sample.roll = calibrated ? attitude.getRoll() : 0;
+    sample.pitch = calibrated ? attitude.getPitch() : 0;
+    sample.gyroZ = gyroZ;
+    sample.accelX = accel[0];
+    sample.accelY = accel[1];
+    sample.accelZ = accel[2];
+    sample.timestampUs = dataReadyMicros;
+    sample.samples = headingSamples;
+    sample.calibrated = calibrated;
+    sample.tippedOver = tippedOver;
+    published.write(sample);
+}
+
+void IMU::recordLatency(uint32_t latencyUs) {
+    stats.lastLatencyUs = latencyUs;
+    if (latencyUs > stats.maxLatencyUs) {
+        stats.maxLatencyUs = latencyUs;
+    }
+    stats.avgLatencyUs += LATENCY_AVG_ALPHA * (latencyUs - stats.avgLatencyUs);
+}
+
+void IMU::startFifo() {
+    mpu.resetFIFO();
+    fifoStartMicros = micros();
+    fifoSamples = 0;
+}
+
+void IMU::processSample(const int16_t (&raw)[6]) {
+    addToWindow(raw);
+    if (window.count >= IMU_STILL_WINDOW) {
+        finishWindow();
+    }
+    
+    if (calibrationState != CalibrationState::Calibrated) return;
+    
+    // Body frame: x forward, z up. Gravity at calibration is taken as straight down,
+    // so calibrating on a slope reads as level.
+    const float sign = IMU_YAW_SIGN;
+    const float gyroToRad = DEG_TO_RAD / GYRO_SCALE;
+    float gx = (raw[3] - gyroBias[0]) * gyroToRad;
+    float gy = sign * (raw[4] - gyroBias[1]) * gyroToRad;
+    float gz = sign * (raw[5] - gyroBias[2]) * gyroToRad;
+    float ax = (raw[0] - accelBias[0]) / ACCEL_LSB_PER_G;
+    float ay = sign * (raw[1] - accelBias[1]) / ACCEL_LSB_PER_G;
+    float az = sign * (raw[2] - accelBias[2]) / ACCEL_LSB_PER_G + 1.0f;
+    
+    if (!attitudeInitialized) {
+        attitude.reset(ax, ay, az);
+        attitudeInitialized = true;
+    }
+    attitude.update(gx, gy, gz, ax, ay, az, samplePeriod);
+    headingSamples++;
+    
+    gyroZ = gz;
+    accel[0] = ax * 9.81f;
+    accel[1] = ay * 9.81f;
+    accel[2] = (az - 1.0f) * 9.81f;
+    
+    updateTipOver(attitude.getUpright());
+}
+
+void IMU::updateTipOver(float upright) {
+    bool pastThreshold = tippedOver ? upright > RECOVER_UPRIGHT : upright < TIP_UPRIGHT;
+    tipSamples = pastThreshold ? tipSamples + 1 : 0;
+    if (tipSamples >= TIP_HOLD_SAMPLES) {
+        tippedOver = !tippedOver;
+        tipSamples = 0;
+    }
+}
+
+void IMU::resetWindow() {
+    window.count = 0;
+    for (int axis = 0; axis < 6; axis++) {
+        window.sum[axis] = 0;
+        window.min[axis] = INT16_MAX;
+        window.max[axis] = INT16_MIN;
+    }
+    wheelsMovedInWindow = false;
+}
+
+void IMU::addToWindow(const int16_t (&raw)[6]) {
+    window.count++;
+    for (int axis = 0; axis < 6; axis++) {
+        window.sum[axis] += raw[axis];
+        window.min[axis] = min(window.min[axis], raw[axis]);
+        window.max[axis] = max(window.max[axis], raw[axis]);
+    }
+}
+
+bool IMU::isWindowStill() const {
+    if (wheelsMovedInWindow) return false;
+    
+    const float accelRange = IMU_STILL_ACCEL_RANGE * ACCEL_SCALE;
+    const float gyroRange = IMU_STILL_GYRO_RANGE * GYRO_SCALE;
+    for (int axis = 0; axis < 6; axis++) {
+        float range = axis < 3 ? accelRange : gyroRange;
+        if (window.max[axis] - window.min[axis] > range) return false;
+    }
+    return true;
+}
+
+void IMU::finishWindow() {
+    bool still = isWindowStill();
+    
+    if (still && calibrationState == CalibrationState::Collecting) {
+        stillSamples += window.count;
+        for (int axis = 0; axis < 6; axis++) {
+            totals[axis] += window.sum[axis];
+        }
+        if (stillSamples >= calibrationSamples) {
+            finishCalibration();
+        }
+    } else if (still && calibrationState == CalibrationState::Calibrated) {
+        float means[3];
+        bool nearBias = true;
+        for (int i = 0; i < 3; i++) {
+            means[i] = (float)window.sum[3 + i] / window.count;
+            // A steady slow turn is also a still window; only small offsets from the bias are taken as drift
+            nearBias = nearBias && fabsf(means[i] - gyroBias[i]) <= IMU_STILL_GYRO_RANGE * GYRO_SCALE;
+        }
         
-        delay(2);
+        if (nearBias) {
+            stationaryDrift = IMU_YAW_SIGN * (means[2] - gyroBias[2]) / GYRO_SCALE * DEG_TO_RAD;
+            for (int i = 0; i < 3; i++) {
+                gyroBiasModels[i].observe(temperature, means[i]);
+            }
+            updateGyroBias();
+            biasRefinements++;
+            
+            if (fabsf(gyroBiasModels[2].predict(savedTemperature) - savedGyroZBias) >= IMU_BIAS_SAVE_DELTA * GYRO_SCALE &&
+                millis() - lastSaveTime >= IMU_BIAS_SAVE_INTERVAL_MS) {
+                saveCalibration();
+            }
+        }
+    }
+    
+    resetWindow();
+}
+
+void IMU::finishCalibration() {
+    readTemperature();
+    for (int i = 0; i < 3; i++) {
+        accelBias[i] = totals[i] / stillSamples;
+        // A slope fitted before this recalibration still holds
+        gyroBiasModels[i].reset(totals[3 + i] / stillSamples, temperature, gyroBiasModels[i].getSlope());
     }
+    updateGyroBias();
     
-    accelXBias = (float)axSum / calibrationSamples;
-    accelYBias = (float)aySum / calibrationSamples;
-    accelZBias = (float)azSum / calibrationSamples;
-    gyroZBias = (float)gzSum / calibrationSamples;
+    attitudeInitialized = false;
+    headingSamples = 0;
+    tippedOver = false;
+    tipSamples = 0;
+    calibrationState = CalibrationState::Calibrated;
     
-    calibrated = true;
-    heading = 0;
-    lastUpdateTime = millis();
+    saveCalibration();
+    TELEM_LOGF_SUCCESS("IMU calibrated at %.1f°C (%lu ms after boot)", temperature, millis());
 }
 
-void IMU::update() {
-    if (!calibrated) return;
+void IMU::updateGyroBias() {
+    for (int i = 0; i < 3; i++) {
+        gyroBias[i] = gyroBiasModels[i].predict(temperature);
+    }
+}
+
+float IMU::readTemperature() {
+    temperature = mpu.getTemperature() / 340.0f + 36.53f;
+    lastTemperatureRead = millis();
+    return temperature;
+}
+
+bool IMU::loadCalibration() {
+    if (!LittleFS.exists(IMU_CALIBRATION_PATH)) return false;
     
-    int16_t ax, ay, az, gx, gy, gz;
-    mpu.getMotion6(&ax, &ay, &az, &gx, &gy, &gz);
+    File file = LittleFS.open(IMU_CALIBRATION_PATH, "r");
+    if (!file) return false;
     
-    accelX = (ax - accelXBias) / ACCEL_SCALE;
-    accelY = (ay - accelYBias) / ACCEL_SCALE;
-    accelZ = (az - accelZBias) / ACCEL_SCALE;
+    JsonDocument doc;
+    DeserializationError error = deserializeJson(doc, file);
+    file.close();
+    if (error) return false;
     
-    accelXFiltered = ACCEL_ALPHA * accelX + (1.0 - ACCEL_ALPHA) * accelXFiltered;
-    accelYFiltered = ACCEL_ALPHA * accelY + (1.0 - ACCEL_ALPHA) * accelYFiltered;
-    accelZFiltered = ACCEL_ALPHA * accelZ + (1.0 - ACCEL_ALPHA) * accelZFiltered;
+    // Files from before the attitude filter only hold the Z gyro bias
+    if (!doc["gyroXBias"].is<float>()) return false;
     
-    gyroZ = (gz - gyroZBias) / GYRO_SCALE;
+    float storedTemperature = doc["temperature"] | -1000.0f;
+    float currentTemperature = readTemperature();
+    if (fabsf(currentTemperature - storedTemperature) > IMU_CALIBRATION_TEMP_TOLERANCE) {
+        TELEM_LOGF("Stored IMU calibration is from %.1f°C, now %.1f°C - recalibrating",
+                   storedTemperature, currentTemperature);
+        return false;
+    }
     
-    unsigned long currentTime = millis();
-    float dt = (currentTime - lastUpdateTime) / 1000.0;
-    lastUpdateTime = currentTime;
+    for (int i = 0; i < 3; i++) {
+        float bias = doc[GYRO_BIAS_KEYS[i]] | 0.0f;
+        float slope = doc[GYRO_SLOPE_KEYS[i]] | 0.0f;
+        gyroBiasModels[i].reset(bias, storedTemperature, slope);
+        accelBias[i] = doc[ACCEL_BIAS_KEYS[i]] | 0.0f;
+    }
+    updateGyroBias();
     
-    heading += (gyroZ * PI / 180.0) * dt;
+    savedGyroZBias = gyroBiasModels[2].predict(storedTemperature);
+    savedTemperature = storedTemperature;
+    lastSaveTime = millis();
+    return true;
+}
+
+bool IMU::saveCalibration() {
+    float currentTemperature = readTemperature();
     
-    // Normalize heading to [-PI, PI]
-    while (heading > PI) heading -= 2 * PI;
-    while (heading < -PI) heading += 2 * PI;
+    JsonDocument doc;
+    for (int i = 0; i < 3; i++) {
+        doc[GYRO_BIAS_KEYS[i]] = gyroBiasModels[i].predict(currentTemperature);
+        doc[GYRO_SLOPE_KEYS[i]] = gyroBiasModels[i].getSlope();
+        doc[ACCEL_BIAS_KEYS[i]] = accelBias[i];
+    }
+    doc["temperature"] = currentTemperature;
+    
+    File file = LittleFS.open(IMU_CALIBRATION_PATH, "w");
+    if (!file) {
+        TELEM_LOG_ERROR("Failed to save IMU calibration");
+        return false;
+    }
+    serializeJson(doc, file);
+    file.close();
+    
+    savedGyroZBias = gyroBiasModels[2].predict(currentTemperature);
+    savedTemperature = currentTemperature;
+    lastSaveTime = millis();
+    return true;
 }
@@ -3,49 +3,177 @@
 
 #include <Wire.h>
 #include <MPU6050.h>
+#include "config.h"
+#include "../utils/SeqLock.h"
+#include "../utils/MahonyFilter.h"
+#include "../utils/TemperatureBiasModel.h"
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
 
+struct IMUSample {
+    float heading;         // rad, [-PI, PI]; attitude yaw
+    float roll;            // rad
+    float pitch;           // rad
+    float gyroZ;           // rad/s, body
+    float accelX;          // m/s^2, gravity at calibration removed
+    float accelY;
+    float accelZ;
+    uint32_t timestampUs;  // data-ready edge of the newest sample
+    uint32_t samples;      // integrated since calibration
+    bool calibrated;
+    bool tippedOver;
+};
+
+/**
+ * MPU6050 attitude, yaw rate and acceleration
+ * A low-priority task wakes on each data-ready interrupt, drains the FIFO in burst reads every few samples and runs
+ * each sample through a Mahony filter over the sensor's own period, then publishes the newest state through a SeqLock.
+ * Readers on any task copy the snapshot without waiting on the I2C bus.
+ * Calibration is incremental: the task only keeps windows in which the sensor was still, so it runs alongside
+ * startup. Gyro biases follow a linear temperature model that later still windows keep fitting; it is stored
+ * and reused on boot while the die temperature is close to the stored one.
+ */
 class IMU {
 public:
+    enum class CalibrationState : uint8_t {
+        Uncalibrated,
+        Collecting,
+        Calibrated
+    };
+    
+    struct Stats {
+        uint32_t lastLatencyUs;   // data-ready edge to publish
+        uint32_t maxLatencyUs;
+        float avgLatencyUs;
+        uint32_t droppedSamples;  // lost to FIFO overflows
+        uint32_t fifoOverflows;
+        uint32_t missedInterrupts;
+    };
+    
     IMU(int calibrationSamples = 1000);
     
+    // Loads the stored calibration if the temperature matches, otherwise starts collecting. Starts the sampling task.
     bool begin();
-    void calibrate();
-    void update();
+    void requestCalibration();
+    void calibrate();  // blocking
+    
+    IMUSample getSample() const { return published.read(); }
+    float getHeading() const { return getSample().heading; } // in radians
+    float getHeadingDegrees() const { return getHeading() * 180.0 / PI; }
+    float getRoll() const { return getSample().roll; }      // in radians
+    float getPitch() const { return getSample().pitch; }    // in radians
+    float getGyroZ() const { return getSample().gyroZ; }    // in rad/s
+    float getAccelX() const { return getSample().accelX; }  // in m/s^2
+    float getAccelY() const { return getSample().accelY; }  // in m/s^2
+    float getAccelZ() const { return getSample().accelZ; }  // in m/s^2
+    bool isTippedOver() const { return getSample().tippedOver; }
+    float getTemperature() const { return temperature; }  // in °C
+    float getSamplePeriod() const { return samplePeriod; }  // in seconds, measured against micros()
+    // Fitted gyro Z bias change per °C, in °/s
+    float getGyroZTemperatureSlope() const { return gyroBiasModels[2].getSlope() / GYRO_SCALE; }
+    
+    bool isCalibrated() const { return calibrationState == CalibrationState::Calibrated; }
+    CalibrationState getCalibrationState() const { return calibrationState; }
+    float getCalibrationProgress() const { return (float)stillSamples / calibrationSamples; }
     
-    float getHeading() const { return heading; } // in radians
-    float getHeadingDegrees() const { return heading * 180.0 / PI; }
-    float getGyroZ() const { return gyroZ; }    // in rad/s
-    float getAccelX() const { return accelX; }  // in m/s^2
-    float getAccelY() const { return accelY; }  // in m/s^2
-    float getAccelZ() const { return accelZ; }  // in m/s^2
+    // Windows in which the wheels turned are never taken as still
+    void setWheelsMoving(bool moving) { if (moving) wheelsMovedInWindow = true; }
+    // Residual gyro Z rate seen in the last still window before it was folded into the bias model, in rad/s
+    float getStationaryDrift() const { return stationaryDrift; }
+    uint32_t getBiasRefinements() const { return biasRefinements; }
     
-    bool isCalibrated() const { return calibrated; }
+    const Stats& getStats() const { return stats; }
+    void resetStats() { resetStatsRequested = true; }
 
 private:
+    static constexpr int FIFO_SAMPLE_BYTES = 12;  // accel X/Y/Z then gyro X/Y/Z, big-endian
+    static constexpr int FIFO_SIZE = 1024;
+    
     MPU6050 mpu;
     int calibrationSamples;
-    bool calibrated;
+    volatile CalibrationState calibrationState;
     
-    float gyroZBias;
-    float accelXBias;
-    float accelYBias;
-    float accelZBias;
+    TaskHandle_t taskHandle;
+    volatile uint32_t dataReadyMicros;
+    volatile bool calibrationRequested;
+    volatile bool resetStatsRequested;
+    SeqLock<IMUSample> published;
+    Stats stats;
     
+    // Raw units; the gyro biases are re-evaluated from the models whenever the temperature is read
+    TemperatureBiasModel gyroBiasModels[3];
+    float gyroBias[3];
+    float accelBias[3];
+    
+    MahonyFilter attitude;
+    bool attitudeInitialized;
     float gyroZ;
-    float accelX;
-    float accelY;
-    float accelZ;
+    float accel[3];
+    volatile float temperature;
+    unsigned long lastTemperatureRead;
+    
+    uint32_t headingSamples;
+    int tipSamples;  // consecutive samples past the tip (or recover) threshold
+    bool tippedOver;
+    
+    volatile float samplePeriod;
+    unsigned long fifoStartMicros;
+    uint32_t fifoSamples;  // since fifoStartMicros
+    uint32_t rateWindows;
+    unsigned long lastDrainMicros;
+    uint8_t fifoBuffer[IMU_FIFO_BURST_SAMPLES * FIFO_SAMPLE_BYTES];
+    
+    // Current stillness window, raw units: accel X/Y/Z, then gyro X/Y/Z
+    struct Window {
+        int count;
+        long sum[6];
+        int16_t min[6];
+        int16_t max[6];
+    };
+    Window window;
+    volatile bool wheelsMovedInWindow;
+    
+    // Accepted still samples while collecting
+    volatile int stillSamples;
+    double totals[6];
+    
+    volatile float stationaryDrift;
+    volatile uint32_t biasRefinements;
+    float savedGyroZBias;
+    float savedTemperature;
+    unsigned long lastSaveTime;
+    
+    static void dataReadyISR(void* arg);
+    static void taskEntry(void* arg);
+    void run();
+    void drainFifo();
+    void publish();
+    void recordLatency(uint32_t latencyUs);
+    
+    void startFifo();
+    void processSample(const int16_t (&raw)[6]);
+    void updateTipOver(float upright);
+    
+    void startCalibration();
+    void resetWindow();
+    void addToWindow(const int16_t (&raw)[6]);
+    bool isWindowStill() const;
+    void finishWindow();
+    void finishCalibration();
+    void updateGyroBias();
     
-    float accelXFiltered;
-    float accelYFiltered;
-    float accelZFiltered;
+    bool loadCalibration();
+    bool saveCalibration();
+    float readTemperature();
     
-    float heading;
-    unsigned long lastUpdateTime;
+    static TemperatureBiasModel::Config biasModelConfig();
+    static MahonyFilter::Config attitudeConfig();
     
     static constexpr float ACCEL_SCALE = 16384.0 / 9.81;
+    static constexpr float ACCEL_LSB_PER_G = 16384.0;
     static constexpr float GYRO_SCALE = 131.0;
-    static constexpr float ACCEL_ALPHA = 0.1;
+    static constexpr float SAMPLE_PERIOD_ALPHA = 0.2f;
+    static constexpr float LATENCY_AVG_ALPHA = 0.01f;
 };
 
 #endif
@@ -0,0 +1,42 @@
+#ifndef PULSECOUNTERACCUMULATOR_H
+#define PULSECOUNTERACCUMULATOR_H
+
+#include <stdint.h>
+
+/**
+ * Extends a 16-bit hardware pulse counter to a 64-bit count
+ * The counter auto-clears when it reaches +/-limit; each limit event is folded into a wrap count
+ * Hardware-free so the overflow logic can be exercised with a mocked counter
+ */
+class PulseCounterAccumulator {
+public:
+    explicit PulseCounterAccumulator(int16_t limit) : limit(limit), wraps(0) {}
+
+    void onHighLimit() { wraps = wraps + 1; }
+    void onLowLimit() { wraps = wraps - 1; }
+    void reset() { wraps = 0; }
+
+    int16_t getLimit() const { return limit; }
+    int32_t getWraps() const { return wraps; }
+
+    // readRaw returns the live hardware counter; retried if a limit event lands mid-read
+    template<typename ReadRaw>
+    int64_t read(ReadRaw readRaw) const {
+        int32_t before;
+        int32_t after;
+        int16_t raw;
+        do {
+            before = wraps;
+            raw = readRaw();
+            after = wraps;
+        } while (before != after);
+
+        return (int64_t)after * limit + raw;
+    }
+
+private:
+    const int16_t limit;
+    volatile int32_t wraps;
+};
+
+#endif
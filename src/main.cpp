@@ -2,6 +2,7 @@
 #include <WiFi.h>
 #include <ESPmDNS.h>
 #include <ArduinoOTA.h>
+#include <LittleFS.h>
 #include "config.h"
 #include "hardware/Encoder.h"
 #include "hardware/IMU.h"
@@ -9,19 +10,36 @@
 #include "drive/DriveController.h"
 #include "hardware/BatteryMonitor.h"
 #include "drive/VelocityController.h"
+#include "drive/ControlScheduler.h"
+#include "drive/Localizer.h"
+#include "drive/PoseEstimator.h"
 #include "network/Telemetry.h"
 #include "utils/ConfigManager.h"
 
-Encoder leftEncoder(LEFT_ENCODER_A, LEFT_ENCODER_B, ENCODER_PPR, WHEEL_DIAMETER);
-Encoder rightEncoder(RIGHT_ENCODER_A, RIGHT_ENCODER_B, ENCODER_PPR, WHEEL_DIAMETER, true); // Reversed
+Encoder encoders[ENCODER_COUNT] = {
+    {LEFT_ENCODER_A, LEFT_ENCODER_B, ENCODER_PPR, WHEEL_DIAMETER},
+    {RIGHT_ENCODER_A, RIGHT_ENCODER_B, ENCODER_PPR, WHEEL_DIAMETER, true}  // Reversed
+};
+Encoder& leftEncoder = encoders[LEFT_ENCODER_INDEX];
+Encoder& rightEncoder = encoders[RIGHT_ENCODER_INDEX];
 DriveController driveController;
 BatteryMonitor batteryMonitor(BATTERY_VOLTAGE_PIN, BATTERY_VOLTAGE_MULTIPLIER);
 VelocityController velocityController;
+Localizer localizer(TRACK_WIDTH, ODOMETRY_WHEEL_NOISE);
+PoseEstimator poseEstimator({
+    TRACK_WIDTH, POSE_TRACK_WIDTH_UNCERTAINTY, POSE_WHEEL_NOISE, PI * WHEEL_DIAMETER / ENCODER_PPR,
+    POSE_GYRO_NOISE, POSE_GYRO_BIAS_DRIFT, POSE_GYRO_BIAS_SIGMA, POSE_YAW_GATE
+});
+ControlScheduler controlScheduler(CONTROL_LOOP_RATE_HZ, CONTROL_TASK_CORE, CONTROL_TASK_PRIORITY);
 ConfigManager configManager;
 WebServerManager webServer(WEB_SERVER_PORT);
-IMU imu;
+IMU imu(IMU_CALIBRATION_SAMPLES);
 
 unsigned long lastIMULog = 0;
+unsigned long lastSupplySample = 0;
+unsigned long lastPoseUpdateMicros = 0;
+bool poseUpdateStarted = false;
+float lastImuHeading = 0;
 
 void setupWiFi() {
     WiFi.mode(WIFI_STA);
@@ -105,6 +123,44 @@ void setupOTA() {
     TELEM_LOG("✓ OTA ready");
 }
 
+// Control task, from the same encoder snapshot as the odometry; without a calibrated IMU the estimate falls back to wheel odometry
+void updatePoseEstimate(const EncoderSnapshot& snap) {
+    unsigned long now = micros();
+    if (poseUpdateStarted && now - lastPoseUpdateMicros < POSE_UPDATE_MS * 1000UL) return;
+    float dt = (now - lastPoseUpdateMicros) * 1e-6f;
+    lastPoseUpdateMicros = now;
+    
+    imu.setWheelsMoving(fabsf(snap.leftVelocity) > IMU_STILL_WHEEL_VELOCITY || fabsf(snap.rightVelocity) > IMU_STILL_WHEEL_VELOCITY);
+    IMUSample sample = imu.getSample();
+    float imuDtheta = Localizer::wrapAngle(sample.heading - lastImuHeading);
+    lastImuHeading = sample.heading;
+    
+    // The first call only seeds the time and heading; a step from zero would span the whole boot
+    if (!poseUpdateStarted) {
+        poseUpdateStarted = true;
+        return;
+    }
+    if (sample.calibrated) {
+        // The yaw change comes from the sensor's own sample clock, so dt only spreads it into a rate
+        poseEstimator.update(snap.leftDistance, snap.rightDistance, imuDtheta / dt, dt);
+    } else {
+        poseEstimator.updateOdometryOnly(snap.leftDistance, snap.rightDistance, dt);
+    }
+}
+
+// Loop task; the tip-over flag comes from the IMU attitude filter
+void checkTipOver() {
+    bool tipped = IMU_TIP_CUTOFF_ENABLED && imu.isTippedOver();
+    if (tipped == velocityController.isMotorInhibited()) return;
+    
+    velocityController.setMotorInhibit(tipped);
+    if (tipped) {
+        TELEM_LOG_WARNING("Tipped over - motors cut");
+    } else {
+        TELEM_LOG_INFO("Upright again - motors re-enabled");
+    }
+}
+
 void setup() {
     Serial.begin(115200);
     delay(1000);
@@ -117,23 +173,15 @@ void setup() {
     // Initialize drive controller
     driveController.begin();
     
-    // Register encoder instances (required for ISR callbacks)
-    Encoder::registerLeft(&leftEncoder);
-    Encoder::registerRight(&rightEncoder);
-    
-    // Initialize encoders
-    TELEM_LOG("Setting up encoders...");
-    leftEncoder.begin();
-    rightEncoder.begin();
-    TELEM_LOG("✓ Encoders initialized");
+    // Mounted before anything reads its files; the web server's own begin() then finds it mounted
+    if (!LittleFS.begin(true)) {
+        TELEM_LOG("✗ LittleFS mount failed");
+    }
     
-    // Initialize IMU
+    // Initialize IMU; calibration restores the stored bias or continues in the background on the IMU task
     TELEM_LOG("Setting up IMU...");
     if (imu.begin()) {
         TELEM_LOG("✓ IMU connected");
-        TELEM_LOG("Calibrating IMU (keep still)...");
-        imu.calibrate();
-        TELEM_LOG("✓ IMU calibrated");
     } else {
         TELEM_LOG("✗ IMU connection failed!");
     }
@@ -152,6 +200,8 @@ void setup() {
         velocityController.setDeadzone(cfg.deadzonePWM);
         velocityController.setPIDGains(cfg.pidKp, cfg.pidKi, cfg.pidKd);
         velocityController.enablePID(cfg.pidEnabled);
+        velocityController.setNominalVoltage(cfg.nominalVoltage);
+        velocityController.enableVoltageCompensation(cfg.voltageCompensationEnabled);
         
         // Apply polynomial coefficients if enabled
         if (cfg.polynomialEnabled) {
@@ -159,7 +209,14 @@ void setup() {
             float pwm2vel[] = {cfg.pwm2vel_b0, cfg.pwm2vel_b1, cfg.pwm2vel_b2, cfg.pwm2vel_b3};
             velocityController.setVelocityToPWMPolynomial(vel2pwm, 3);
             velocityController.setPWMToVelocityPolynomial(pwm2vel, 3);
+            for (int i = 0; i < MOTOR_MAPPING_COUNT; i++) {
+                const ConfigManager::Config::MappingFit& fit = cfg.motorMappings[i];
+                if (!fit.valid) continue;
+                velocityController.setVelocityToPWMPolynomial((MotorMapping)i, fit.vel2pwm, 3);
+                velocityController.setPWMToVelocityPolynomial((MotorMapping)i, fit.pwm2vel, 3);
+            }
             velocityController.enablePolynomialMapping(true);
+            velocityController.enableLookupTable(cfg.lookupTableEnabled);
         }
         
         configManager.print();
@@ -167,6 +224,24 @@ void setup() {
         TELEM_LOG("No saved configuration found - using defaults");
     }
     
+    // Start the control loop; encoders are set up from the control task so their interrupts land on its core
+    TELEM_LOG("Starting control loop...");
+    controlScheduler.begin(
+        [](float) {
+            for (Encoder& encoder : encoders) {
+                encoder.update();
+            }
+            EncoderSnapshot snap = Encoder::capture(leftEncoder, rightEncoder);
+            localizer.update(snap.leftDistance, snap.rightDistance, snap.leftVelocity, snap.rightVelocity);
+            updatePoseEstimate(snap);
+            velocityController.update();
+        },
+        []() {
+            for (Encoder& encoder : encoders) {
+                encoder.begin();  // each takes the next ISR slot
+            }
+        });
+    
     // Setup WiFi (Station Mode)
     setupWiFi();
     
@@ -176,7 +251,10 @@ void setup() {
     }
     
     // Setup Web Server (this also initializes Telemetry)
+    webServer.setLocalizer(&localizer);
+    webServer.setPoseEstimator(&poseEstimator);
     webServer.begin(&leftEncoder, &rightEncoder, &driveController, &batteryMonitor, &velocityController, &configManager);
+    webServer.setControlScheduler(&controlScheduler);
     
     TELEM_LOG("=== System Ready ===");
 }
@@ -186,12 +264,15 @@ void loop() {
 
     webServer.handleWebSocket();
     
-    leftEncoder.update();
-    rightEncoder.update();
+    // BatteryMonitor's reading is already filtered; the scale only needs refreshing at this rate
+    if (millis() - lastSupplySample >= VOLTAGE_COMP_SAMPLE_MS) {
+        lastSupplySample = millis();
+        velocityController.updateSupplyVoltage(batteryMonitor.getVoltage());
+    }
+    
+    checkTipOver();
     
     // if (imu.isCalibrated()) {
-    //     imu.update();
-        
     //     if (millis() - lastIMULog >= 100) {
     //         lastIMULog = millis();
     //         TELEM_LOGF("IMU | AX:%.1f AY:%.1f AZ:%.1f GZ:%.2f° Heading:%.1f°", 
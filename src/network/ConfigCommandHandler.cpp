@@ -65,6 +65,48 @@ void ConfigCommandHandler::handleConfigReset(uint32_t clientId) {
     }
 }
 
+bool ConfigCommandHandler::savePolynomialFit(MotorMapping mapping, const float* vel2pwm, const float* pwm2vel) {
+    if (!configManager) return false;
+    
+    ConfigManager::Config& cfg = configManager->getConfig();
+    ConfigManager::Config::MappingFit& fit = cfg.motorMappings[(int)mapping];
+    cfg.polynomialEnabled = true;
+    for (int i = 0; i < 4; i++) {
+        fit.vel2pwm[i] = vel2pwm[i];
+        fit.pwm2vel[i] = pwm2vel[i];
+    }
+    fit.valid = true;
+    
+    if (!configManager->save()) {
+        TELEM_LOG_ERROR("Failed to save calibration fit");
+        return false;
+    }
+    
+    applyConfigToControllers();
+    wsHandler->broadcastText("CONFIG_SAVED");
+    TELEM_LOGF_SUCCESS("Calibration fit for %s saved and applied", motorMappingName(mapping));
+    return true;
+}
+
+bool ConfigCommandHandler::savePIDGains(float kp, float ki, float kd) {
+    if (!configManager) return false;
+    
+    ConfigManager::Config& cfg = configManager->getConfig();
+    cfg.pidKp = kp;
+    cfg.pidKi = ki;
+    cfg.pidKd = kd;
+    
+    if (!configManager->save()) {
+        TELEM_LOG_ERROR("Failed to save PID gains");
+        return false;
+    }
+    
+    applyConfigToControllers();
+    wsHandler->broadcastText("CONFIG_SAVED");
+    TELEM_LOG_SUCCESS("PID gains saved and applied");
+    return true;
+}
+
 void ConfigCommandHandler::applyConfigToControllers() {
     ConfigManager::Config& cfg = configManager->getConfig();
     
@@ -72,10 +114,20 @@ void ConfigCommandHandler::applyConfigToControllers() {
     velocityController->setDeadzone(cfg.deadzonePWM);
     velocityController->enablePID(cfg.pidEnabled);
     velocityController->setPIDGains(cfg.pidKp, cfg.pidKi, cfg.pidKd);
+    velocityController->setNominalVoltage(cfg.nominalVoltage);
+    velocityController->enableVoltageCompensation(cfg.voltageCompensationEnabled);
     velocityController->enablePolynomialMapping(cfg.polynomialEnabled);
+    velocityController->enableLookupTable(cfg.lookupTableEnabled);
     
     float vel2pwm[] = {cfg.vel2pwm_a0, cfg.vel2pwm_a1, cfg.vel2pwm_a2, cfg.vel2pwm_a3};
     float pwm2vel[] = {cfg.pwm2vel_b0, cfg.pwm2vel_b1, cfg.pwm2vel_b2, cfg.pwm2vel_b3};
     velocityController->setVelocityToPWMPolynomial(vel2pwm, 3);
     velocityController->setPWMToVelocityPolynomial(pwm2vel, 3);
+    
+    for (int i = 0; i < MOTOR_MAPPING_COUNT; i++) {
+        const ConfigManager::Config::MappingFit& fit = cfg.motorMappings[i];
+        if (!fit.valid) continue;
+        velocityController->setVelocityToPWMPolynomial((MotorMapping)i, fit.vel2pwm, 3);
+        velocityController->setPWMToVelocityPolynomial((MotorMapping)i, fit.pwm2vel, 3);
+    }
 }
@@ -11,6 +11,11 @@ public:
     ConfigCommandHandler(WebSocketHandler* wsHandler, ConfigManager* configMgr, VelocityController* velCtrl);
     
     void handleConfigCommand(uint32_t clientId, const String& message);
+    // Stores cubic velocity->PWM and PWM->velocity coefficients for one wheel and direction,
+    // enables polynomial mapping and applies it
+    bool savePolynomialFit(MotorMapping mapping, const float* vel2pwm, const float* pwm2vel);
+    // Stores velocity PID gains and applies them
+    bool savePIDGains(float kp, float ki, float kd);
 
 private:
     WebSocketHandler* wsHandler;
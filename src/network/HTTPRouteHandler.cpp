@@ -10,7 +10,7 @@ HTTPRouteHandler::HTTPRouteHandler(
     VelocityController* velCtrl,
     ConfigManager* configMgr
 ) : server(server), leftEncoder(leftEnc), rightEncoder(rightEnc),
-    batteryMonitor(battery), velocityController(velCtrl), configManager(configMgr) {}
+    batteryMonitor(battery), velocityController(velCtrl), configManager(configMgr), localizer(nullptr), poseEstimator(nullptr) {}
 
 void HTTPRouteHandler::setupRoutes() {
     server->on("/", HTTP_GET, [this](AsyncWebServerRequest* request) {
@@ -52,12 +52,14 @@ void HTTPRouteHandler::handleRoot(AsyncWebServerRequest* request) {
 void HTTPRouteHandler::handleEncoderAPI(AsyncWebServerRequest* request) {
     float voltage = batteryMonitor->getVoltage();
     
+    EncoderSnapshot snap = Encoder::capture(*leftEncoder, *rightEncoder);
+    
     String json = EncoderJsonBuilder::buildSimpleEncoderData(
-        leftEncoder->getCount(), leftEncoder->getRevolutions(), leftEncoder->getDistance(),
-        leftEncoder->getVelocity(), leftEncoder->getRPM(),
-        rightEncoder->getCount(), rightEncoder->getRevolutions(), rightEncoder->getDistance(),
-        rightEncoder->getVelocity(), rightEncoder->getRPM(),
-        voltage
+        snap.leftCount, leftEncoder->countsToRevolutions(snap.leftCount), snap.leftDistance,
+        snap.leftVelocity, leftEncoder->velocityToRPM(snap.leftVelocity), leftEncoder->getIllegalTransitions(),
+        snap.rightCount, rightEncoder->countsToRevolutions(snap.rightCount), snap.rightDistance,
+        snap.rightVelocity, rightEncoder->velocityToRPM(snap.rightVelocity), rightEncoder->getIllegalTransitions(),
+        voltage, batteryMonitor->getStateOfCharge()
     );
     
     request->send(200, "application/json", json);
@@ -66,6 +68,8 @@ void HTTPRouteHandler::handleEncoderAPI(AsyncWebServerRequest* request) {
 void HTTPRouteHandler::handleResetAPI(AsyncWebServerRequest* request) {
     leftEncoder->reset();
     rightEncoder->reset();
+    if (localizer) localizer->requestReset();
+    if (poseEstimator) poseEstimator->requestReset();
     request->send(200, "text/plain", "Encoders reset");
 }
 
@@ -96,6 +100,9 @@ void HTTPRouteHandler::handleConfigSaveAPI(AsyncWebServerRequest* request) {
     cfg.pidEnabled = velocityController->isPIDEnabled();
     velocityController->getPIDGains(cfg.pidKp, cfg.pidKi, cfg.pidKd);
     cfg.polynomialEnabled = velocityController->isPolynomialMappingEnabled();
+    cfg.lookupTableEnabled = velocityController->isLookupTableEnabled();
+    cfg.voltageCompensationEnabled = velocityController->isVoltageCompensationEnabled();
+    cfg.nominalVoltage = velocityController->getNominalVoltage();
     
     if (configManager->save()) {
         request->send(200, "application/json", "{\"status\":\"saved\"}");
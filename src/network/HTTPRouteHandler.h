@@ -6,6 +6,8 @@
 #include "../hardware/Encoder.h"
 #include "../hardware/BatteryMonitor.h"
 #include "../drive/VelocityController.h"
+#include "../drive/Localizer.h"
+#include "../drive/PoseEstimator.h"
 #include "../utils/ConfigManager.h"
 
 class HTTPRouteHandler {
@@ -19,6 +21,8 @@ public:
         ConfigManager* configMgr
     );
     
+    void setLocalizer(Localizer* loc) { localizer = loc; }
+    void setPoseEstimator(PoseEstimator* estimator) { poseEstimator = estimator; }
     void setupRoutes();
 
 private:
@@ -28,6 +32,8 @@ private:
     BatteryMonitor* batteryMonitor;
     VelocityController* velocityController;
     ConfigManager* configManager;
+    Localizer* localizer;
+    PoseEstimator* poseEstimator;
     
     void handleRoot(AsyncWebServerRequest* request);
     void handleEncoderAPI(AsyncWebServerRequest* request);
@@ -6,8 +6,9 @@
 WebServerManager::WebServerManager(int port) 
     : server(port), leftEncoder(nullptr), rightEncoder(nullptr), 
       driveController(nullptr), batteryMonitor(nullptr), velocityController(nullptr), 
-      configManager(nullptr), wsHandler(nullptr), controlManager(nullptr),
-      commandRouter(nullptr), configHandler(nullptr), httpHandler(nullptr), lastUpdate(0) {}
+      configManager(nullptr), controlScheduler(nullptr), localizer(nullptr), poseEstimator(nullptr), wsHandler(nullptr), controlManager(nullptr),
+      commandRouter(nullptr), configHandler(nullptr), httpHandler(nullptr), lastUpdate(0),
+      lastControlStatsUpdate(0), batteryLowReported(false) {}
 
 WebServerManager::~WebServerManager() {
     delete wsHandler;
@@ -55,10 +56,14 @@ void WebServerManager::initializeComponents() {
     
     configHandler = new ConfigCommandHandler(wsHandler, configManager, velocityController);
     commandRouter->setConfigHandler(configHandler);
+    commandRouter->setLocalizer(localizer);
+    commandRouter->setPoseEstimator(poseEstimator);
     
     httpHandler = new HTTPRouteHandler(
         &server, leftEncoder, rightEncoder, batteryMonitor, velocityController, configManager
     );
+    httpHandler->setLocalizer(localizer);
+    httpHandler->setPoseEstimator(poseEstimator);
     
     Telemetry::getInstance().begin(wsHandler->getWebSocket());
 }
@@ -94,15 +99,21 @@ void WebServerManager::broadcastEncoderData() {
     if (wsHandler->getClientCount() == 0) return;
     
     float voltage = batteryMonitor->getVoltage();
+    EncoderSnapshot snap = Encoder::capture(*leftEncoder, *rightEncoder);
+    LocalizerState odometry = localizer ? localizer->getState() : LocalizerState();
+    PoseEstimate estimate = poseEstimator ? poseEstimator->getState() : PoseEstimate();
     
     String json = EncoderJsonBuilder::buildEncoderData(
-        leftEncoder->getCount(), leftEncoder->getRevolutions(), leftEncoder->getDistance(), 
-        leftEncoder->getVelocity(), leftEncoder->getRPM(),
-        rightEncoder->getCount(), rightEncoder->getRevolutions(), rightEncoder->getDistance(),
-        rightEncoder->getVelocity(), rightEncoder->getRPM(),
-        voltage,
+        snap.leftCount, leftEncoder->countsToRevolutions(snap.leftCount), snap.leftDistance,
+        snap.leftVelocity, leftEncoder->velocityToRPM(snap.leftVelocity),
+        leftEncoder->getIllegalTransitions(), leftEncoder->getEdgeOverruns(), leftEdgeStats,
+        snap.rightCount, rightEncoder->countsToRevolutions(snap.rightCount), snap.rightDistance,
+        snap.rightVelocity, rightEncoder->velocityToRPM(snap.rightVelocity),
+        rightEncoder->getIllegalTransitions(), rightEncoder->getEdgeOverruns(), rightEdgeStats,
+        voltage, batteryMonitor->getStateOfCharge(), velocityController->getVoltageScale(),
         driveController->getLastLeftPWM(), driveController->getLastRightPWM(),
-        velocityController->getLeftVelocityError(), velocityController->getRightVelocityError()
+        velocityController->getLeftVelocityError(), velocityController->getRightVelocityError(),
+        odometry, estimate
     );
     wsHandler->broadcastText(json);
     
@@ -113,14 +124,61 @@ void WebServerManager::broadcastEncoderData() {
     ));
 }
 
+void WebServerManager::broadcastControlLoopStats() {
+    if (!controlScheduler || wsHandler->getClientCount() == 0) return;
+    
+    ControlScheduler::Stats stats = controlScheduler->getStats();
+    wsHandler->broadcastText(WebSocketMessageBuilder::buildControlLoopStats(
+        stats.rateHz, stats.ticks, stats.overruns,
+        stats.lastExecUs, stats.maxExecUs,
+        stats.avgJitterUs, stats.maxJitterUs
+    ));
+}
+
+void WebServerManager::broadcastOnlineIdStatus() {
+    if (!velocityController->isOnlineIdentificationEnabled() || wsHandler->getClientCount() == 0) return;
+    
+    const MotorModelEstimator* models[MOTOR_MAPPING_COUNT];
+    for (int i = 0; i < MOTOR_MAPPING_COUNT; i++) {
+        models[i] = &velocityController->getOnlineModel((MotorMapping)i);
+    }
+    wsHandler->broadcastText(MotorModelJsonBuilder::buildOnlineIdStatus(true, models));
+}
+
+void WebServerManager::checkBatteryLow() {
+    bool low = batteryMonitor->isLow();
+    if (low == batteryLowReported) return;
+    batteryLowReported = low;
+    
+    float voltage = batteryMonitor->getVoltage();
+    float soc = batteryMonitor->getStateOfCharge();
+    if (low) {
+        TELEM_LOGF_WARNING("Battery low: %.2f V (%.0f%%)", voltage, soc);
+    } else {
+        TELEM_LOGF_INFO("Battery recovered: %.2f V (%.0f%%)", voltage, soc);
+    }
+    wsHandler->broadcastText(WebSocketMessageBuilder::buildBatteryStatus(low, voltage, soc));
+}
+
 void WebServerManager::handleWebSocket() {
     wsHandler->cleanup();
     
+    // Drained every loop pass so the rings only overrun when this task falls behind the wheels
+    leftEdgeStats.drain(*leftEncoder);
+    rightEdgeStats.drain(*rightEncoder);
+    
     unsigned long now = millis();
     if (now - lastUpdate >= 200) {
         broadcastEncoderData();
+        checkBatteryLow();
         lastUpdate = now;
     }
+    
+    if (now - lastControlStatsUpdate >= 1000) {
+        broadcastControlLoopStats();
+        broadcastOnlineIdStatus();
+        lastControlStatsUpdate = now;
+    }
 }
 
 void WebServerManager::update() {
@@ -10,9 +10,13 @@
 #include "ConfigCommandHandler.h"
 #include "HTTPRouteHandler.h"
 #include "../hardware/Encoder.h"
+#include "../hardware/EdgeCaptureStats.h"
 #include "../drive/DriveController.h"
 #include "../hardware/BatteryMonitor.h"
 #include "../drive/VelocityController.h"
+#include "../drive/ControlScheduler.h"
+#include "../drive/Localizer.h"
+#include "../drive/PoseEstimator.h"
 #include "../utils/ConfigManager.h"
 
 class WebServerManager {
@@ -25,6 +29,9 @@ private:
     BatteryMonitor* batteryMonitor;
     VelocityController* velocityController;
     ConfigManager* configManager;
+    ControlScheduler* controlScheduler;
+    Localizer* localizer;
+    PoseEstimator* poseEstimator;
     
     WebSocketHandler* wsHandler;
     ClientControlManager* controlManager;
@@ -32,7 +39,12 @@ private:
     ConfigCommandHandler* configHandler;
     HTTPRouteHandler* httpHandler;
     
+    EdgeCaptureStats leftEdgeStats;
+    EdgeCaptureStats rightEdgeStats;
+    
     unsigned long lastUpdate;
+    unsigned long lastControlStatsUpdate;
+    bool batteryLowReported;
 
 public:
     WebServerManager(int port);
@@ -40,6 +52,10 @@ public:
     
     void begin(Encoder* left, Encoder* right, DriveController* drive, 
                BatteryMonitor* battery, VelocityController* velCtrl, ConfigManager* config);
+    void setControlScheduler(ControlScheduler* scheduler) { controlScheduler = scheduler; }
+    // Must be set before begin()
+    void setLocalizer(Localizer* loc) { localizer = loc; }
+    void setPoseEstimator(PoseEstimator* estimator) { poseEstimator = estimator; }
     void handleWebSocket();
     void update();
 
@@ -48,6 +64,9 @@ private:
     void setupCallbacks();
     void broadcastEncoderData();
     void broadcastControlStatus();
+    void checkBatteryLow();
+    void broadcastControlLoopStats();
+    void broadcastOnlineIdStatus();
 };
 
 #endif
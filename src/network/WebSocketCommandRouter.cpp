@@ -6,6 +6,8 @@
 #include "commands/DirectMotorCommand.h"
 #include "commands/VelocityCommand.h"
 #include "commands/CalibrationCommand.h"
+#include "commands/AutoTuneCommand.h"
+#include "commands/SystemIdCommand.h"
 
 WebSocketCommandRouter::WebSocketCommandRouter(
     WebSocketHandler* wsHandler,
@@ -16,7 +18,7 @@ WebSocketCommandRouter::WebSocketCommandRouter(
     Encoder* rightEnc
 ) : wsHandler(wsHandler), controlManager(controlMgr),
     driveController(drive), velocityController(velCtrl),
-    leftEncoder(leftEnc), rightEncoder(rightEnc), configHandler(nullptr) {
+    leftEncoder(leftEnc), rightEncoder(rightEnc), configHandler(nullptr), localizer(nullptr), poseEstimator(nullptr) {
     factory = new CommandFactory(drive, velCtrl, leftEnc, rightEnc);
 }
 
@@ -28,6 +30,11 @@ void WebSocketCommandRouter::setConfigHandler(ConfigCommandHandler* handler) {
     configHandler = handler;
 }
 
+void WebSocketCommandRouter::setPoseEstimator(PoseEstimator* estimator) {
+    poseEstimator = estimator;
+    factory->setPoseEstimator(estimator);
+}
+
 void WebSocketCommandRouter::begin() {
     wsHandler->onMessage([this](uint32_t clientId, const String& message) {
         handleMessage(clientId, message);
@@ -42,7 +49,9 @@ void WebSocketCommandRouter::handleMessage(uint32_t clientId, const String& mess
     if (message == "RESET") {
         leftEncoder->reset();
         rightEncoder->reset();
-        TELEM_LOG_COMMAND("Encoders reset via WebSocket");
+        if (localizer) localizer->requestReset();
+        if (poseEstimator) poseEstimator->requestReset();
+        TELEM_LOG_COMMAND("Encoders and odometry reset via WebSocket");
     } 
     else if (message == "REQUEST_CONTROL") {
         controlManager->requestControl(clientId);
@@ -74,12 +83,24 @@ void WebSocketCommandRouter::handleMessage(uint32_t clientId, const String& mess
     else if (message.startsWith("START_CALIBRATION:") || message == "STOP_CALIBRATION") {
         handleCalibrationCommands(clientId, message);
     }
+    else if (message.startsWith("START_AUTOTUNE:") || message == "STOP_AUTOTUNE") {
+        handleAutoTuneCommands(clientId, message);
+    }
+    else if (message.startsWith("START_SYSID:") || message == "STOP_SYSID") {
+        handleSystemIdCommands(clientId, message);
+    }
     else if (message.startsWith("PID_")) {
         handlePIDCommands(clientId, message);
     }
     else if (message.startsWith("POLY_")) {
         handlePolynomialCommands(clientId, message);
     }
+    else if (message.startsWith("ONLINE_ID_")) {
+        handleOnlineIdCommands(clientId, message);
+    }
+    else if (message.startsWith("EDGE_CAPTURE:")) {
+        handleEdgeCaptureCommand(clientId, message.substring(13));
+    }
     else if (message.startsWith("CONFIG_") && configHandler) {
         configHandler->handleConfigCommand(clientId, message);
     }
@@ -96,14 +117,8 @@ void WebSocketCommandRouter::handleJoystickCommand(uint32_t clientId, const Stri
         float x = coords.substring(0, commaIndex).toFloat();
         float y = coords.substring(commaIndex + 1).toFloat();
         
-        JoystickCommand* cmd = executor.getCurrentCommandAs<JoystickCommand>();
-        if (cmd) {
-            cmd->updateJoystick(x, y);
-        } else {
-            auto newCmd = factory->createJoystickCommand();
-            newCmd->updateJoystick(x, y);
-            executor.executeCommand(std::move(newCmd));
-        }
+        // A running joystick command absorbs this one on the loop task
+        executor.executeCommand(factory->createJoystickCommand(x, y));
     }
 }
 
@@ -118,13 +133,7 @@ void WebSocketCommandRouter::handleMotorCommand(uint32_t clientId, const String&
         float leftPower = coords.substring(0, commaIndex).toFloat();
         float rightPower = coords.substring(commaIndex + 1).toFloat();
         
-        DirectMotorCommand* cmd = executor.getCurrentCommandAs<DirectMotorCommand>();
-        if (cmd) {
-            cmd->setMotorPowers(leftPower, rightPower);
-        } else {
-            auto newCmd = factory->createDirectMotorCommand(leftPower, rightPower);
-            executor.executeCommand(std::move(newCmd));
-        }
+        executor.executeCommand(factory->createDirectMotorCommand(leftPower, rightPower));
         
         TELEM_LOGF_COMMAND("Direct motor control - L:%.2f R:%.2f", leftPower, rightPower);
     }
@@ -138,12 +147,7 @@ void WebSocketCommandRouter::handleVelocityCommand(uint32_t clientId, const Stri
     
     float velocity = value.toFloat();
     
-    VelocityCommand* cmd = executor.getCurrentCommandAs<VelocityCommand>();
-    if (cmd) {
-        cmd->updateVelocity(velocity);
-    } else {
-        executor.executeCommand(factory->createVelocityCommand(velocity));
-    }
+    executor.executeCommand(factory->createVelocityCommand(velocity));
     
     TELEM_LOGF_COMMAND("Velocity command: %.1f cm/s", velocity);
     
@@ -154,24 +158,38 @@ void WebSocketCommandRouter::handleVelocityCommand(uint32_t clientId, const Stri
 
 void WebSocketCommandRouter::handleCalibrationCommands(uint32_t clientId, const String& message) {
     if (message.startsWith("START_CALIBRATION:")) {
+        // motor,startPWM,endPWM,stepSize,holdTime[,fitDegree[,autoSave[,minHoldTime,steadyTolerance[,bidirectional]]]]
         String params = message.substring(18);
-        int commaPos1 = params.indexOf(',');
-        int commaPos2 = params.indexOf(',', commaPos1 + 1);
-        int commaPos3 = params.indexOf(',', commaPos2 + 1);
-        int commaPos4 = params.indexOf(',', commaPos3 + 1);
+        String fields[10];
+        int fieldCount = 0;
+        while (fieldCount < 10) {
+            int commaPos = params.indexOf(',');
+            if (commaPos < 0) {
+                fields[fieldCount++] = params;
+                break;
+            }
+            fields[fieldCount++] = params.substring(0, commaPos);
+            params = params.substring(commaPos + 1);
+        }
         
         CalibrationCommand::Config config;
-        config.motor = params.substring(0, commaPos1);
-        config.startPWM = params.substring(commaPos1 + 1, commaPos2).toInt();
-        config.endPWM = params.substring(commaPos2 + 1, commaPos3).toInt();
-        config.stepSize = params.substring(commaPos3 + 1, commaPos4).toInt();
-        config.holdTime = params.substring(commaPos4 + 1).toInt();
+        config.motor = fields[0];
+        config.startPWM = fields[1].toInt();
+        config.endPWM = fields[2].toInt();
+        config.stepSize = fields[3].toInt();
+        config.holdTime = fields[4].toInt();
+        config.fitDegree = fieldCount > 5 ? fields[5].toInt() : 0;
+        config.autoSave = fieldCount > 6 && fields[6] == "true";
+        config.minHoldTime = fieldCount > 8 ? fields[7].toInt() : 0;
+        config.steadyTolerance = fieldCount > 8 ? fields[8].toFloat() : 0;
+        config.bidirectional = fieldCount > 9 && fields[9] == "true";
         
         auto cmd = factory->createCalibrationCommand(config);
         
         cmd->setDataCallback([this](const CalibrationCommand::DataPoint& point) {
             wsHandler->broadcastText(WebSocketMessageBuilder::buildCalibrationPoint(
-                point.pwm, point.leftVelocity, point.rightVelocity));
+                point.pwm, point.leftVelocity, point.rightVelocity,
+                point.leftVariance, point.rightVariance));
         });
         
         cmd->setProgressCallback([this](int current, int end, int start) {
@@ -183,6 +201,20 @@ void WebSocketCommandRouter::handleCalibrationCommands(uint32_t clientId, const
             wsHandler->broadcastText("CALIBRATION_COMPLETE");
         });
         
+        cmd->setFitCallback([this](MotorMapping mapping, const PolynomialFit::Result& pwmToVelocity,
+                                   const PolynomialFit::Result& velocityToPWM, bool autoSave) {
+            const char* name = motorMappingName(mapping);
+            wsHandler->broadcastText(WebSocketMessageBuilder::buildCalibrationFit("PWM2VEL", name, pwmToVelocity));
+            wsHandler->broadcastText(WebSocketMessageBuilder::buildCalibrationFit("VEL2PWM", name, velocityToPWM));
+            TELEM_LOGF_SUCCESS("Calibration fit %s: vel->pwm degree %d (RMS %.2f PWM), pwm->vel degree %d (RMS %.2f cm/s)",
+                               name, velocityToPWM.degree, velocityToPWM.rmsResidual,
+                               pwmToVelocity.degree, pwmToVelocity.rmsResidual);
+            
+            if (autoSave && configHandler && pwmToVelocity.ok && velocityToPWM.ok) {
+                configHandler->savePolynomialFit(mapping, velocityToPWM.coefficients, pwmToVelocity.coefficients);
+            }
+        });
+        
         executor.executeCommand(std::move(cmd));
     } 
     else if (message == "STOP_CALIBRATION") {
@@ -190,6 +222,164 @@ void WebSocketCommandRouter::handleCalibrationCommands(uint32_t clientId, const
     }
 }
 
+void WebSocketCommandRouter::handleAutoTuneCommands(uint32_t clientId, const String& message) {
+    if (!controlManager->hasControl(clientId)) {
+        TELEM_LOGF_WARNING("Client #%u tried to run auto-tune without control", clientId);
+        return;
+    }
+    
+    if (message.startsWith("START_AUTOTUNE:")) {
+        // motor,velocity[,relayAmplitude,hysteresis,cycles[,rule[,autoSave[,timeoutMs]]]]
+        String params = message.substring(15);
+        String fields[8];
+        int fieldCount = 0;
+        while (fieldCount < 8) {
+            int commaPos = params.indexOf(',');
+            if (commaPos < 0) {
+                fields[fieldCount++] = params;
+                break;
+            }
+            fields[fieldCount++] = params.substring(0, commaPos);
+            params = params.substring(commaPos + 1);
+        }
+        
+        AutoTuneCommand::Config config;
+        config.motor = fields[0];
+        config.velocity = fields[1].toFloat();
+        config.relayAmplitude = fieldCount > 4 ? fields[2].toFloat() : 40.0f;
+        config.hysteresis = fieldCount > 4 ? fields[3].toFloat() : 0.5f;
+        config.cycles = fieldCount > 4 ? fields[4].toInt() : 6;
+        config.rule = RelayAutoTuner::Rule::ZieglerNicholsPI;
+        if (fieldCount > 5 && !RelayAutoTuner::parseRule(fields[5].c_str(), config.rule)) {
+            TELEM_LOGF_WARNING("Unknown tuning rule '%s', using Ziegler-Nichols PI", fields[5].c_str());
+        }
+        config.autoSave = fieldCount > 6 && fields[6] == "true";
+        config.timeout = fieldCount > 7 ? fields[7].toInt() : 10000;
+        
+        auto cmd = factory->createAutoTuneCommand(config);
+        
+        cmd->setProgressCallback([this](const char* wheel, int cycles, int targetCycles) {
+            wsHandler->broadcastText(WebSocketMessageBuilder::buildAutoTuneProgress(wheel, cycles, targetCycles));
+        });
+        
+        cmd->setWheelResultCallback([this](const char* wheel, const RelayAutoTuner::Result& result,
+                                           float kp, float ki, float kd) {
+            wsHandler->broadcastText(WebSocketMessageBuilder::buildAutoTuneResult(wheel, result, kp, ki, kd));
+            TELEM_LOGF("Relay auto-tune %s: Ku=%.3f Tu=%.4fs amplitude %.2f cm/s%s",
+                       wheel, result.ultimateGain, result.ultimatePeriod, result.oscillationAmplitude,
+                       result.ok ? "" : " (no clean limit cycle)");
+        });
+        
+        RelayAutoTuner::Rule rule = config.rule;
+        cmd->setCompleteCallback([this, rule](bool ok, float kp, float ki, float kd, bool autoSave) {
+            if (!ok) {
+                wsHandler->broadcastText("AUTOTUNE_FAILED");
+                TELEM_LOG_ERROR("Relay auto-tune failed");
+                return;
+            }
+            
+            String values = String(RelayAutoTuner::ruleName(rule)) + "," + String(kp, 3) + "," +
+                            String(ki, 3) + "," + String(kd, 4);
+            wsHandler->broadcastText("AUTOTUNE_COMPLETE:" + values);
+            TELEM_LOGF_SUCCESS("Relay auto-tune (%s): Kp=%.3f Ki=%.3f Kd=%.4f", RelayAutoTuner::ruleName(rule), kp, ki, kd);
+            
+            if (autoSave && configHandler) {
+                configHandler->savePIDGains(kp, ki, kd);
+            }
+        });
+        
+        executor.executeCommand(std::move(cmd));
+    }
+    else if (message == "STOP_AUTOTUNE") {
+        executor.stopCurrentCommand();
+    }
+}
+
+void WebSocketCommandRouter::handleSystemIdCommands(uint32_t clientId, const String& message) {
+    if (!controlManager->hasControl(clientId)) {
+        TELEM_LOGF_WARNING("Client #%u tried to run system identification without control", clientId);
+        return;
+    }
+    
+    if (message.startsWith("START_SYSID:")) {
+        // motor,type,biasPWM,amplitudePWM,durationS[,p1[,p2]]
+        // p1 = step time (step), bit time (prbs) or start Hz (chirp); p2 = end Hz (chirp)
+        String params = message.substring(12);
+        String fields[7];
+        int fieldCount = 0;
+        while (fieldCount < 7) {
+            int commaPos = params.indexOf(',');
+            if (commaPos < 0) {
+                fields[fieldCount++] = params;
+                break;
+            }
+            fields[fieldCount++] = params.substring(0, commaPos);
+            params = params.substring(commaPos + 1);
+        }
+        
+        SystemIdCommand::Config config;
+        config.motor = fields[0];
+        ExcitationSignal::Config& excitation = config.excitation;
+        if (fieldCount < 5 || !ExcitationSignal::parseType(fields[1].c_str(), excitation.type)) {
+            TELEM_LOGF_WARNING("Invalid system ID request: %s", message.c_str());
+            return;
+        }
+        excitation.bias = fields[2].toFloat();
+        excitation.amplitude = fields[3].toFloat();
+        excitation.duration = fields[4].toFloat();
+        excitation.stepTime = excitation.duration * 0.1f;
+        excitation.bitTime = 0.05f;
+        excitation.startHz = 0.2f;
+        excitation.endHz = 15.0f;
+        if (fieldCount > 5) {
+            float p1 = fields[5].toFloat();
+            if (excitation.type == ExcitationSignal::Type::Step) excitation.stepTime = p1;
+            if (excitation.type == ExcitationSignal::Type::Prbs) excitation.bitTime = p1;
+            if (excitation.type == ExcitationSignal::Type::Chirp) excitation.startHz = p1;
+        }
+        if (fieldCount > 6 && excitation.type == ExcitationSignal::Type::Chirp) {
+            excitation.endHz = fields[6].toFloat();
+        }
+        
+        auto cmd = factory->createSystemIdCommand(config);
+        
+        cmd->setProgressCallback([this](int samples, int capacity) {
+            wsHandler->broadcastText("SYSID_PROGRESS:" + String(samples) + "," + String(capacity));
+        });
+        
+        cmd->setFitCallback([this](const char* wheel, const FopdtFit::Result& result) {
+            wsHandler->broadcastText(WebSocketMessageBuilder::buildSystemIdFit(wheel, result));
+            if (result.ok) {
+                TELEM_LOGF_SUCCESS("System ID %s: K=%.4f cm/s/PWM tau=%.1f ms L=%.1f ms (fit %.1f%%)",
+                                   wheel, result.gain, result.timeConstant * 1000.0f,
+                                   result.deadTime * 1000.0f, result.fitPercent);
+            } else {
+                TELEM_LOGF_ERROR("System ID %s: no stable first-order fit", wheel);
+            }
+        });
+        
+        cmd->setCaptureCallback([this](int samples, int chunks, float sampleRateHz) {
+            wsHandler->broadcastText("SYSID_CAPTURE:" + String(samples) + "," + String(chunks) + "," +
+                                     String(sampleRateHz, 1));
+        });
+        
+        cmd->setChunkCallback([this](const uint8_t* data, size_t len) {
+            if (!wsHandler->canBroadcast()) return false;
+            wsHandler->broadcastBinary(data, len);
+            return true;
+        });
+        
+        cmd->setCompleteCallback([this]() {
+            wsHandler->broadcastText("SYSID_COMPLETE");
+        });
+        
+        executor.executeCommand(std::move(cmd));
+    }
+    else if (message == "STOP_SYSID") {
+        executor.stopCurrentCommand();
+    }
+}
+
 void WebSocketCommandRouter::handlePIDCommands(uint32_t clientId, const String& message) {
     if (message.startsWith("PID_GAINS:")) {
         String params = message.substring(10);
@@ -211,6 +401,15 @@ void WebSocketCommandRouter::handlePIDCommands(uint32_t clientId, const String&
 void WebSocketCommandRouter::handlePolynomialCommands(uint32_t clientId, const String& message) {
     if (message.startsWith("POLY_VEL2PWM:")) {
         String params = message.substring(13);
+        // Optional "<mapping>:" prefix, e.g. left_rev:3,a0,a1,a2,a3; without it every mapping is set
+        MotorMapping mapping;
+        bool haveMapping = false;
+        int colonPos = params.indexOf(':');
+        if (colonPos > 0) {
+            haveMapping = parseMotorMapping(params.substring(0, colonPos).c_str(), mapping);
+            if (!haveMapping) return;
+            params = params.substring(colonPos + 1);
+        }
         int commaPos = params.indexOf(',');
         if (commaPos > 0) {
             int degree = params.substring(0, commaPos).toInt();
@@ -229,12 +428,25 @@ void WebSocketCommandRouter::handlePolynomialCommands(uint32_t clientId, const S
                 }
             }
             
-            velocityController->setVelocityToPWMPolynomial(coeffs, degree);
+            if (haveMapping) {
+                velocityController->setVelocityToPWMPolynomial(mapping, coeffs, degree);
+            } else {
+                velocityController->setVelocityToPWMPolynomial(coeffs, degree);
+            }
             wsHandler->broadcastText(WebSocketMessageBuilder::buildCommandAck("POLY_VEL2PWM", "degree=" + String(degree)));
         }
     }
     else if (message.startsWith("POLY_PWM2VEL:")) {
         String params = message.substring(13);
+        // Optional "<mapping>:" prefix, e.g. left_rev:3,a0,a1,a2,a3; without it every mapping is set
+        MotorMapping mapping;
+        bool haveMapping = false;
+        int colonPos = params.indexOf(':');
+        if (colonPos > 0) {
+            haveMapping = parseMotorMapping(params.substring(0, colonPos).c_str(), mapping);
+            if (!haveMapping) return;
+            params = params.substring(colonPos + 1);
+        }
         int commaPos = params.indexOf(',');
         if (commaPos > 0) {
             int degree = params.substring(0, commaPos).toInt();
@@ -253,7 +465,11 @@ void WebSocketCommandRouter::handlePolynomialCommands(uint32_t clientId, const S
                 }
             }
             
-            velocityController->setPWMToVelocityPolynomial(coeffs, degree);
+            if (haveMapping) {
+                velocityController->setPWMToVelocityPolynomial(mapping, coeffs, degree);
+            } else {
+                velocityController->setPWMToVelocityPolynomial(coeffs, degree);
+            }
             wsHandler->broadcastText(WebSocketMessageBuilder::buildCommandAck("POLY_PWM2VEL", "degree=" + String(degree)));
         }
     }
@@ -262,4 +478,39 @@ void WebSocketCommandRouter::handlePolynomialCommands(uint32_t clientId, const S
         velocityController->enablePolynomialMapping(enable);
         wsHandler->broadcastText(WebSocketMessageBuilder::buildCommandAck("POLY_ENABLE", enable ? "true" : "false"));
     }
+    else if (message.startsWith("POLY_LUT:")) {
+        bool enable = message.substring(9) == "true";
+        velocityController->enableLookupTable(enable);
+        wsHandler->broadcastText(WebSocketMessageBuilder::buildCommandAck("POLY_LUT", enable ? "true" : "false"));
+    }
+}
+
+void WebSocketCommandRouter::handleOnlineIdCommands(uint32_t clientId, const String& message) {
+    if (!controlManager->hasControl(clientId)) {
+        TELEM_LOGF_WARNING("Client #%u tried to change online identification without control", clientId);
+        return;
+    }
+    
+    if (message.startsWith("ONLINE_ID_ENABLE:")) {
+        bool enable = message.substring(17) == "true";
+        velocityController->enableOnlineIdentification(enable);
+        wsHandler->broadcastText(WebSocketMessageBuilder::buildCommandAck("ONLINE_ID_ENABLE", enable ? "true" : "false"));
+    }
+    else if (message == "ONLINE_ID_RESET") {
+        velocityController->resetOnlineIdentification();
+        TELEM_LOG_COMMAND("Online motor identification reset");
+    }
+}
+
+void WebSocketCommandRouter::handleEdgeCaptureCommand(uint32_t clientId, const String& value) {
+    if (!controlManager->hasControl(clientId)) {
+        TELEM_LOGF_WARNING("Client #%u tried to change edge capture without control", clientId);
+        return;
+    }
+    
+    // The web server drains both rings and publishes the summary with the encoder telemetry
+    bool enable = value == "true";
+    leftEncoder->enableEdgeCapture(enable);
+    rightEncoder->enableEdgeCapture(enable);
+    wsHandler->broadcastText(WebSocketMessageBuilder::buildCommandAck("EDGE_CAPTURE", enable ? "true" : "false"));
 }
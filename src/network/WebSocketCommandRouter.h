@@ -9,6 +9,8 @@
 #include "../drive/DriveController.h"
 #include "../drive/VelocityController.h"
 #include "../hardware/Encoder.h"
+#include "../drive/Localizer.h"
+#include "../drive/PoseEstimator.h"
 
 class ConfigCommandHandler;
 
@@ -26,6 +28,8 @@ public:
     ~WebSocketCommandRouter();
     
     void setConfigHandler(ConfigCommandHandler* handler);
+    void setLocalizer(Localizer* loc) { localizer = loc; }
+    void setPoseEstimator(PoseEstimator* estimator);
     void begin();
     void update();
 
@@ -37,6 +41,8 @@ private:
     Encoder* leftEncoder;
     Encoder* rightEncoder;
     ConfigCommandHandler* configHandler;
+    Localizer* localizer;
+    PoseEstimator* poseEstimator;
     
     CommandExecutor executor;
     CommandFactory* factory;
@@ -47,8 +53,12 @@ private:
     void handleMotorCommand(uint32_t clientId, const String& coords);
     void handleVelocityCommand(uint32_t clientId, const String& value);
     void handleCalibrationCommands(uint32_t clientId, const String& message);
+    void handleAutoTuneCommands(uint32_t clientId, const String& message);
+    void handleSystemIdCommands(uint32_t clientId, const String& message);
     void handlePIDCommands(uint32_t clientId, const String& message);
     void handlePolynomialCommands(uint32_t clientId, const String& message);
+    void handleOnlineIdCommands(uint32_t clientId, const String& message);
+    void handleEdgeCaptureCommand(uint32_t clientId, const String& value);
     
     bool parseFloatParams(const String& params, float* values, int count);
 };
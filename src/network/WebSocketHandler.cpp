@@ -94,6 +94,10 @@ void WebSocketHandler::broadcastBinary(const uint8_t* data, size_t len) {
     ws.binaryAll(data, len);
 }
 
+bool WebSocketHandler::canBroadcast() {
+    return ws.availableForWriteAll();
+}
+
 bool WebSocketHandler::parseJson(const String& message, JsonDocument& doc) {
     DeserializationError error = deserializeJson(doc, message);
     if (error) {
@@ -26,6 +26,8 @@ public:
     
     void sendBinary(uint32_t clientId, const uint8_t* data, size_t len);
     void broadcastBinary(const uint8_t* data, size_t len);
+    // False while any client's send queue is full
+    bool canBroadcast();
     
     bool parseJson(const String& message, JsonDocument& doc);
     
@@ -0,0 +1,176 @@
+#ifndef AUTOTUNE_COMMAND_H
+#define AUTOTUNE_COMMAND_H
+
+#include "ICommand.h"
+#include "../../drive/VelocityController.h"
+#include "../../drive/ControlTickHook.h"
+#include "../../utils/RelayAutoTuner.h"
+#include <functional>
+
+/**
+ * Blocking relay auto-tune of the wheel velocity loop
+ * Each tuned wheel is driven at its feedforward PWM for the target velocity plus a relay of +/- relayAmplitude,
+ * switched from the control tick so the measured limit cycle includes the real loop delay.
+ * PID gains for the velocity loop's correction term follow from Ku and Tu by the selected rule;
+ * with both wheels tuned the wheel with the lower Ku sets the gains.
+ */
+class AutoTuneCommand : public ICommand, public ControlTickHook {
+public:
+    struct Config {
+        String motor;            // "left", "right", or "both"
+        float velocity;          // cm/s operating point
+        float relayAmplitude;    // PWM
+        float hysteresis;        // cm/s
+        int cycles;              // limit cycles averaged per wheel
+        unsigned long timeout;   // milliseconds
+        RelayAutoTuner::Rule rule;
+        bool autoSave;
+    };
+
+    using ProgressCallback = std::function<void(const char* wheel, int cycles, int targetCycles)>;
+    using WheelCallback = std::function<void(const char* wheel, const RelayAutoTuner::Result& result,
+                                             float kp, float ki, float kd)>;
+    using CompleteCallback = std::function<void(bool ok, float kp, float ki, float kd, bool autoSave)>;
+
+    static constexpr int SETTLE_CYCLES = 2;
+
+private:
+    struct Wheel {
+        const char* name;
+        bool left;
+        bool tuned;
+        float biasPWM;
+        RelayAutoTuner tuner;
+        int reportedCycles;
+    };
+
+    VelocityController* velocityController;
+    Config config;
+    Wheel wheels[2];
+    unsigned long startTime;
+    bool active;
+
+    ProgressCallback onProgress;
+    WheelCallback onWheelResult;
+    CompleteCallback onComplete;
+
+public:
+    AutoTuneCommand(VelocityController* velCtrl, const Config& cfg)
+        : velocityController(velCtrl), config(cfg),
+          wheels{{"left", true, false, 0, RelayAutoTuner(), 0}, {"right", false, false, 0, RelayAutoTuner(), 0}},
+          startTime(0), active(false) {}
+
+    bool start() override {
+        if (config.velocity <= 0 || config.relayAmplitude <= 0) return false;
+
+        wheels[0].tuned = config.motor == "left" || config.motor == "both";
+        wheels[1].tuned = config.motor == "right" || config.motor == "both";
+        if (!wheels[0].tuned && !wheels[1].tuned) return false;
+
+        RelayAutoTuner::Config relay = {config.velocity, config.relayAmplitude, config.hysteresis,
+                                        config.cycles, SETTLE_CYCLES};
+        for (Wheel& wheel : wheels) {
+            wheel.biasPWM = wheel.tuned ? velocityController->feedforwardPWM(config.velocity, wheel.left) : 0;
+            wheel.tuner.begin(relay);
+            wheel.reportedCycles = 0;
+        }
+
+        startTime = millis();
+        active = true;
+        velocityController->attachTickHook(this);
+        return true;
+    }
+
+    // Control task
+    void onControlTick(const EncoderSnapshot& snapshot, float dt, float& leftPWM, float& rightPWM) override {
+        leftPWM = drive(wheels[0], snapshot.leftVelocity, dt);
+        rightPWM = drive(wheels[1], snapshot.rightVelocity, dt);
+    }
+
+    bool update() override {
+        if (!active) return false;
+
+        bool finished = true;
+        for (Wheel& wheel : wheels) {
+            if (!wheel.tuned) continue;
+
+            int cycles = wheel.tuner.getCompletedCycles();
+            if (cycles != wheel.reportedCycles) {
+                wheel.reportedCycles = cycles;
+                if (onProgress) onProgress(wheel.name, cycles, wheel.tuner.getTargetCycles());
+            }
+            finished = finished && wheel.tuner.isFinished();
+        }
+
+        if (finished || millis() - startTime >= config.timeout) {
+            // Stop the relay before reading results the control task was writing
+            velocityController->detachTickHook();
+            velocityController->release();
+            active = false;
+            report();
+            return false;
+        }
+
+        return true;
+    }
+
+    void stop() override {
+        active = false;
+        velocityController->detachTickHook();
+        velocityController->release();
+    }
+
+    bool isBlocking() const override { return true; }
+    const char* getName() const override { return "AutoTune"; }
+    bool isInterruptible() const override { return true; }
+
+    void setProgressCallback(ProgressCallback cb) { onProgress = cb; }
+    void setWheelResultCallback(WheelCallback cb) { onWheelResult = cb; }
+    void setCompleteCallback(CompleteCallback cb) { onComplete = cb; }
+
+private:
+    float drive(Wheel& wheel, float velocity, float dt) {
+        if (!wheel.tuned) return 0;
+        // A finished wheel holds its operating point until the other one is done
+        if (wheel.tuner.isFinished()) return wheel.biasPWM;
+        // constrain() is a macro: step the relay once, outside it
+        float pwm = wheel.biasPWM + wheel.tuner.update(velocity, dt);
+        return constrain(pwm, 0.0f, 255.0f);
+    }
+
+    void report() {
+        bool ok = true;
+        float minUltimateGain = 0;
+        float kp = 0;
+        float ki = 0;
+        float kd = 0;
+
+        for (Wheel& wheel : wheels) {
+            if (!wheel.tuned) continue;
+
+            RelayAutoTuner::Result result = wheel.tuner.getResult();
+            result.ok = result.ok && wheel.tuner.isFinished();  // timed out
+            float wheelKp = 0;
+            float wheelKi = 0;
+            float wheelKd = 0;
+            if (result.ok) {
+                RelayAutoTuner::computeGains(config.rule, result.ultimateGain, result.ultimatePeriod,
+                                             wheelKp, wheelKi, wheelKd);
+                if (minUltimateGain == 0 || result.ultimateGain < minUltimateGain) {
+                    minUltimateGain = result.ultimateGain;
+                    kp = wheelKp;
+                    ki = wheelKi;
+                    kd = wheelKd;
+                }
+            } else {
+                ok = false;
+            }
+
+            if (onWheelResult) onWheelResult(wheel.name, result, wheelKp, wheelKi, wheelKd);
+        }
+
+        if (onComplete) onComplete(ok, kp, ki, kd, config.autoSave);
+    }
+};
+
+#endif
@@ -2,8 +2,12 @@
 #define AUTONOMOUS_SEQUENCE_COMMAND_H
 
 #include "ICommand.h"
+#include "config.h"
 #include "../../drive/VelocityController.h"
+#include "../../drive/VelocitySetpointSource.h"
+#include "../../drive/ProfileFollower.h"
 #include "../../hardware/Encoder.h"
+#include "../../drive/PoseEstimator.h"
 #include <vector>
 #include <functional>
 
@@ -11,8 +15,10 @@
  * Blocking autonomous sequence command
  * Executes a predefined sequence of movements
  * Example: Drive forward 1m, turn 90°, drive forward 0.5m, stop
+ * Distances and turns follow a jerk-limited motion profile fed to the velocity loop every control tick through
+ * a ProfileFollower, with the position error fed back, so they stop on the target instead of overshooting it.
  */
-class AutonomousSequenceCommand : public ICommand {
+class AutonomousSequenceCommand : public ICommand, public VelocitySetpointSource {
 public:
     enum class ActionType {
         DRIVE_DISTANCE,  // Drive forward/backward for X cm
@@ -24,8 +30,8 @@ public:
     
     struct Action {
         ActionType type;
-        float param1;  // Distance (cm), angle (deg), time (ms), or velocity (cm/s)
-        float param2;  // Velocity for DRIVE_DISTANCE, or unused
+        float param1;  // Distance (cm), angle (deg, positive clockwise), time (ms), or velocity (cm/s)
+        float param2;  // Velocity (cm/s) for DRIVE_DISTANCE, angular velocity (deg/s) for TURN_ANGLE, or time (ms)
     };
     
     using ProgressCallback = std::function<void(int stepIndex, int totalSteps)>;
@@ -35,20 +41,50 @@ private:
     VelocityController* velocityController;
     Encoder* leftEncoder;
     Encoder* rightEncoder;
+    PoseEstimator* poseEstimator;  // optional; turns fall back to the wheel encoders without it
     
     std::vector<Action> sequence;
     size_t currentStep;
     unsigned long stepStartTime;
-    float stepStartDistance;
     bool active;
     
+    MotionProfile::Limits driveLimits;  // cm
+    MotionProfile::Limits turnLimits;   // degrees
+    
+    // Profiled step; written by start/update while detached, then owned by the control task
+    ProfileFollower follower;
+    bool profileIsTurn;
+    bool profileStarted;
+    uint32_t profileStartUs;
+    float startLeftDistance;
+    float startRightDistance;
+    float lastHeading;
+    float turnedAngle;         // rad, accumulated across the +/-pi wrap
+    
     ProgressCallback onProgress;
     CompleteCallback onComplete;
 
 public:
-    AutonomousSequenceCommand(VelocityController* velCtrl, Encoder* left, Encoder* right)
-        : velocityController(velCtrl), leftEncoder(left), rightEncoder(right),
-          currentStep(0), stepStartTime(0), stepStartDistance(0), active(false) {}
+    AutonomousSequenceCommand(VelocityController* velCtrl, Encoder* left, Encoder* right,
+                              PoseEstimator* estimator = nullptr)
+        : velocityController(velCtrl), leftEncoder(left), rightEncoder(right), poseEstimator(estimator),
+          currentStep(0), stepStartTime(0), active(false),
+          driveLimits{0, MOTION_MAX_ACCELERATION, MOTION_MAX_JERK},
+          turnLimits{0, MOTION_MAX_ANGULAR_ACCELERATION, MOTION_MAX_ANGULAR_JERK},
+          follower({MOTION_POSITION_GAIN, MOTION_CATCH_UP_MARGIN, MOTION_SETTLE_TIMEOUT_MS * 1e-3f}),
+          profileIsTurn(false), profileStarted(false), profileStartUs(0),
+          startLeftDistance(0), startRightDistance(0), lastHeading(0), turnedAngle(0) {}
+    
+    // Jerk 0 gives trapezoidal profiles
+    void setDriveLimits(float acceleration, float jerk) {
+        driveLimits.maxAcceleration = acceleration;
+        driveLimits.maxJerk = jerk;
+    }
+    
+    void setTurnLimits(float angularAcceleration, float angularJerk) {
+        turnLimits.maxAcceleration = angularAcceleration;
+        turnLimits.maxJerk = angularJerk;
+    }
     
     // Build the sequence
     void addDriveDistance(float distanceCm, float velocityCmPerS) {
@@ -89,27 +125,15 @@ public:
         bool stepComplete = false;
         
         switch (action.type) {
-            case ActionType::DRIVE_DISTANCE: {
-                velocityController->update();
-                float currentDist = (leftEncoder->getDistance() + rightEncoder->getDistance()) / 2.0f;
-                float traveled = abs(currentDist - stepStartDistance);
-                stepComplete = (traveled >= abs(action.param1));
-                break;
-            }
-            
-            case ActionType::TURN_ANGLE: {
-                // Simplified turn - in reality you'd use IMU or encoder differential
-                velocityController->update();
-                // For now, use time-based approximation
-                // TODO: Implement proper angle tracking with IMU
-                unsigned long elapsed = millis() - stepStartTime;
-                float estimatedAngle = (elapsed / 1000.0f) * action.param2;
-                stepComplete = (estimatedAngle >= abs(action.param1));
+            case ActionType::DRIVE_DISTANCE:
+            case ActionType::TURN_ANGLE:
+                stepComplete = follower.isDone();
+                if (stepComplete) {
+                    velocityController->detachSetpointSource();
+                }
                 break;
-            }
             
             case ActionType::DRIVE_TIME: {
-                velocityController->update();
                 unsigned long elapsed = millis() - stepStartTime;
                 stepComplete = (elapsed >= (unsigned long)action.param2);
                 break;
@@ -144,7 +168,8 @@ public:
     
     void stop() override {
         active = false;
-        velocityController->setVelocity(0, 0);
+        velocityController->detachSetpointSource();
+        velocityController->release();
         if (onComplete) onComplete(false);  // Stopped before completion
     }
     
@@ -157,6 +182,42 @@ public:
     
     size_t getStepCount() const { return sequence.size(); }
     size_t getCurrentStep() const { return currentStep; }
+    // cm or degrees, of the last profiled step
+    float getEndpointError() const {
+        return profileIsTurn ? follower.getEndpointError() * RAD_TO_DEG : follower.getEndpointError();
+    }
+    
+    // Control task
+    void nextSetpoint(const EncoderSnapshot& snapshot, float dt, float& leftVelocity, float& rightVelocity) override {
+        if (!profileStarted) {
+            profileStartUs = snapshot.timestampUs;
+            startLeftDistance = snapshot.leftDistance;
+            startRightDistance = snapshot.rightDistance;
+            if (poseEstimator) {
+                lastHeading = poseEstimator->getState().pose.theta;
+                turnedAngle = 0;
+            }
+            profileStarted = true;
+        }
+        
+        if (follower.isDone()) {
+            leftVelocity = 0;
+            rightVelocity = 0;
+            return;
+        }
+        
+        float t = (snapshot.timestampUs - profileStartUs) * 1e-6f;
+        float command = follower.update(t, measureProgress(snapshot));
+        
+        if (profileIsTurn) {
+            float wheel = command * TRACK_WIDTH / 2;
+            leftVelocity = wheel;
+            rightVelocity = -wheel;
+        } else {
+            leftVelocity = command;
+            rightVelocity = command;
+        }
+    }
 
 private:
     void startCurrentStep() {
@@ -166,16 +227,22 @@ private:
         stepStartTime = millis();
         
         switch (action.type) {
-            case ActionType::DRIVE_DISTANCE:
-                stepStartDistance = (leftEncoder->getDistance() + rightEncoder->getDistance()) / 2.0f;
-                velocityController->setVelocity(action.param2, action.param2);
+            case ActionType::DRIVE_DISTANCE: {
+                // A negative velocity drives the distance backwards
+                float distance = (action.param1 < 0) != (action.param2 < 0) ? -fabsf(action.param1) : fabsf(action.param1);
+                MotionProfile::Limits limits = driveLimits;
+                limits.maxVelocity = fabsf(action.param2);
+                startProfile(distance, limits, MOTION_DISTANCE_TOLERANCE, false);
                 break;
-                
+            }
+            
             case ActionType::TURN_ANGLE: {
-                // Turn in place: one motor forward, one backward
-                float turnVel = action.param2;
-                if (action.param1 < 0) turnVel = -turnVel;  // Turn direction
-                velocityController->setVelocity(turnVel, -turnVel);
+                // Planned in degrees, tracked in radians
+                MotionProfile::Limits limits = turnLimits;
+                limits.maxVelocity = fabsf(action.param2) * DEG_TO_RAD;
+                limits.maxAcceleration *= DEG_TO_RAD;
+                limits.maxJerk *= DEG_TO_RAD;
+                startProfile(action.param1 * DEG_TO_RAD, limits, MOTION_ANGLE_TOLERANCE * DEG_TO_RAD, true);
                 break;
             }
             
@@ -189,6 +256,33 @@ private:
                 break;
         }
     }
+    
+    void startProfile(float distance, const MotionProfile::Limits& limits, float endTolerance, bool turn) {
+        // Published first so the velocity loop holds still once the profile detaches
+        velocityController->setVelocity(0, 0);
+        
+        profileIsTurn = turn;
+        profileStarted = false;
+        if (follower.start(distance, limits, endTolerance)) {
+            velocityController->attachSetpointSource(this);
+        }
+    }
+    
+    // Signed like the profile: cm along the drive, or rad turned clockwise
+    float measureProgress(const EncoderSnapshot& snapshot) {
+        float left = snapshot.leftDistance - startLeftDistance;
+        float right = snapshot.rightDistance - startRightDistance;
+        if (!profileIsTurn) {
+            return (left + right) / 2.0f;
+        }
+        if (poseEstimator) {
+            float heading = poseEstimator->getState().pose.theta;
+            turnedAngle += Localizer::wrapAngle(heading - lastHeading);
+            lastHeading = heading;
+            return -turnedAngle;
+        }
+        return (left - right) / TRACK_WIDTH;
+    }
 };
 
 #endif // AUTONOMOUS_SEQUENCE_COMMAND_H
@@ -2,13 +2,19 @@
 #define CALIBRATION_COMMAND_H
 
 #include "ICommand.h"
-#include "../../drive/DriveController.h"
+#include "../../drive/VelocityController.h"
+#include "../../drive/MotorMapping.h"
 #include "../../hardware/Encoder.h"
+#include "../../utils/PolynomialFit.h"
+#include "../../utils/RollingStats.h"
 #include <functional>
+#include <vector>
 
 /**
  * Blocking calibration command
- * Sweeps PWM values and records velocity data
+ * Sweeps PWM values and records velocity data, optionally repeating the sweep in reverse
+ * In adaptive mode a step ends as soon as the wheel speed settles, bounded by minHoldTime and holdTime
+ * The sweep is kept on the robot and fitted both ways (PWM->velocity and velocity->PWM) for each swept wheel and direction
  */
 class CalibrationCommand : public ICommand {
 public:
@@ -17,45 +23,75 @@ public:
         int startPWM;
         int endPWM;
         int stepSize;
-        unsigned long holdTime;  // milliseconds
+        unsigned long holdTime;  // milliseconds; the maximum hold in adaptive mode
+        unsigned long minHoldTime;  // milliseconds; 0 = fixed holdTime per step
+        float steadyTolerance;      // cm/s standard deviation over the window that counts as settled
+        int fitDegree;           // 0 = choose automatically, -1 = no fit
+        bool autoSave;           // persist the fit to the configuration (limited to cubic)
+        bool bidirectional;      // sweep reverse PWM after the forward pass
     };
     
     struct DataPoint {
-        int pwm;
-        float leftVelocity;
+        int pwm;              // negative on the reverse pass
+        float leftVelocity;   // mean over the steady-state window
         float rightVelocity;
+        float leftVariance;
+        float rightVariance;
     };
     
     using DataCallback = std::function<void(const DataPoint&)>;
     using ProgressCallback = std::function<void(int current, int end, int start)>;
     using CompleteCallback = std::function<void()>;
+    using FitCallback = std::function<void(MotorMapping mapping, const PolynomialFit::Result& pwmToVelocity,
+                                           const PolynomialFit::Result& velocityToPWM, bool autoSave)>;
+    
+    static constexpr float MIN_FIT_VELOCITY = 1.0f;  // cm/s; slower points are inside the deadzone
+    static constexpr int PERSISTED_MAX_DEGREE = 3;
+    static constexpr int STEADY_WINDOW = 20;  // velocity samples, one per executor update
 
 private:
-    DriveController* driveController;
+    VelocityController* velocityController;
     Encoder* leftEncoder;
     Encoder* rightEncoder;
     Config config;
     
-    int currentPWM;
+    int currentPWM;  // magnitude; the direction sign is applied separately
+    int direction;
     unsigned long stepStartTime;
     bool active;
+    std::vector<DataPoint> points;
+    
+    RollingStats<STEADY_WINDOW> leftWindow;
+    RollingStats<STEADY_WINDOW> rightWindow;
+    uint32_t lastSampleUs;
     
     DataCallback onDataPoint;
     ProgressCallback onProgress;
     CompleteCallback onComplete;
+    FitCallback onFit;
 
 public:
-    CalibrationCommand(DriveController* drive, Encoder* left, Encoder* right, const Config& cfg)
-        : driveController(drive), leftEncoder(left), rightEncoder(right), 
-          config(cfg), currentPWM(0), stepStartTime(0), active(false) {}
+    CalibrationCommand(VelocityController* velCtrl, Encoder* left, Encoder* right, const Config& cfg)
+        : velocityController(velCtrl), leftEncoder(left), rightEncoder(right), 
+          config(cfg), currentPWM(0), direction(1), stepStartTime(0), active(false), lastSampleUs(0) {}
     
     bool start() override {
         currentPWM = config.startPWM;
+        direction = 1;
         stepStartTime = millis();
         active = true;
         
+        points.clear();
+        if (config.stepSize > 0 && config.endPWM >= config.startPWM) {
+            int steps = (config.endPWM - config.startPWM) / config.stepSize + 1;
+            points.reserve(config.bidirectional ? 2 * steps : steps);
+        }
+        
+        leftWindow.clear();
+        rightWindow.clear();
+        
         // Set initial PWM
-        applyPWM(currentPWM);
+        applyPWM(direction * currentPWM);
         
         return true;
     }
@@ -65,31 +101,48 @@ public:
         
         unsigned long now = millis();
         
-        // Check if we've held this PWM long enough
-        if (now - stepStartTime >= config.holdTime) {
+        EncoderSnapshot snap = velocityController->getSnapshot();
+        if (snap.timestampUs != lastSampleUs) {
+            lastSampleUs = snap.timestampUs;
+            leftWindow.add(snap.leftVelocity);
+            rightWindow.add(snap.rightVelocity);
+        }
+        
+        // Check if we've held this PWM long enough, or it has settled
+        unsigned long held = now - stepStartTime;
+        if (held >= config.holdTime || (isAdaptive() && held >= config.minHoldTime && isSettled())) {
             // Collect data point
             DataPoint point = {
-                currentPWM,
-                leftEncoder->getVelocity(),
-                rightEncoder->getVelocity()
+                direction * currentPWM,
+                leftWindow.mean(),
+                rightWindow.mean(),
+                leftWindow.variance(),
+                rightWindow.variance()
             };
             
+            points.push_back(point);
             if (onDataPoint) onDataPoint(point);
             if (onProgress) onProgress(currentPWM, config.endPWM, config.startPWM);
             
             // Move to next step
             currentPWM += config.stepSize;
             
-            if (currentPWM > config.endPWM) {
+            if (currentPWM > config.endPWM && config.bidirectional && direction > 0) {
+                direction = -1;
+                currentPWM = config.startPWM;
+            } else if (currentPWM > config.endPWM) {
                 // Calibration complete
                 active = false;
+                fitSweep();
                 if (onComplete) onComplete();
                 return false;  // Command finished
             }
             
             // Apply next PWM value
-            applyPWM(currentPWM);
+            applyPWM(direction * currentPWM);
             stepStartTime = now;
+            leftWindow.clear();
+            rightWindow.clear();
         }
         
         return true;  // Still running
@@ -97,8 +150,7 @@ public:
     
     void stop() override {
         active = false;
-        driveController->setLeftMotorPower(0);
-        driveController->setRightMotorPower(0);
+        velocityController->release();
     }
     
     bool isBlocking() const override { return true; }
@@ -109,20 +161,76 @@ public:
     void setDataCallback(DataCallback cb) { onDataPoint = cb; }
     void setProgressCallback(ProgressCallback cb) { onProgress = cb; }
     void setCompleteCallback(CompleteCallback cb) { onComplete = cb; }
+    void setFitCallback(FitCallback cb) { onFit = cb; }
 
 private:
+    bool isAdaptive() const {
+        return config.minHoldTime > 0 && config.steadyTolerance > 0;
+    }
+    
+    bool isSettled() const {
+        if (!leftWindow.isFull()) return false;
+        
+        float limit = config.steadyTolerance * config.steadyTolerance;
+        bool leftSettled = leftWindow.variance() <= limit;
+        bool rightSettled = rightWindow.variance() <= limit;
+        
+        if (config.motor == "left") return leftSettled;
+        if (config.motor == "right") return rightSettled;
+        return leftSettled && rightSettled;
+    }
+    
+    bool sweptWheel(bool left) const {
+        return config.motor == "both" || config.motor == (left ? "left" : "right");
+    }
+    
+    void fitSweep() {
+        if (config.fitDegree < 0 || !onFit) return;
+        
+        for (int wheel = 0; wheel < 2; wheel++) {
+            bool left = wheel == 0;
+            if (!sweptWheel(left)) continue;
+            
+            fitDirection(left, false);
+            if (config.bidirectional) {
+                fitDirection(left, true);
+            }
+        }
+    }
+    
+    void fitDirection(bool left, bool reverse) {
+        std::vector<float> pwm;
+        std::vector<float> velocity;
+        pwm.reserve(points.size());
+        velocity.reserve(points.size());
+        for (const DataPoint& point : points) {
+            if ((point.pwm < 0) != reverse) continue;
+            
+            // Magnitudes in the driven direction; a wheel moving the wrong way is left out
+            float v = left ? point.leftVelocity : point.rightVelocity;
+            if (reverse) v = -v;
+            if (v > MIN_FIT_VELOCITY) {
+                pwm.push_back(abs(point.pwm));
+                velocity.push_back(v);
+            }
+        }
+        
+        int maxDegree = config.autoSave ? PERSISTED_MAX_DEGREE : Polynomial::MAX_DEGREE;
+        int n = pwm.size();
+        PolynomialFit::Result pwmToVelocity = PolynomialFit::fit(pwm.data(), velocity.data(), n, config.fitDegree, maxDegree);
+        PolynomialFit::Result velocityToPWM = PolynomialFit::fit(velocity.data(), pwm.data(), n, config.fitDegree, maxDegree);
+        onFit(motorMappingFor(left, reverse), pwmToVelocity, velocityToPWM, config.autoSave);
+    }
+    
     void applyPWM(int pwm) {
         float pwmValue = pwm / 255.0f;
         
         if (config.motor == "left") {
-            driveController->setLeftMotorPower(pwmValue);
-            driveController->setRightMotorPower(0);
+            velocityController->setPower(pwmValue, 0);
         } else if (config.motor == "right") {
-            driveController->setLeftMotorPower(0);
-            driveController->setRightMotorPower(pwmValue);
+            velocityController->setPower(0, pwmValue);
         } else if (config.motor == "both") {
-            driveController->setLeftMotorPower(pwmValue);
-            driveController->setRightMotorPower(pwmValue);
+            velocityController->setPower(pwmValue, pwmValue);
         }
     }
 };
@@ -4,23 +4,32 @@
 #include "ICommand.h"
 #include <memory>
 #include "../Telemetry.h"
+#include "../../utils/SpscRingBuffer.h"
 
+/**
+ * Runs one command at a time on the loop task
+ * executeCommand()/stopCurrentCommand() only queue the request (single producer: the AsyncTCP task);
+ * update() applies them, so commands are started, stopped and destroyed on the loop task alone.
+ */
 class CommandExecutor {
 private:
+    static constexpr size_t REQUEST_QUEUE_SIZE = 8;
+
     std::unique_ptr<ICommand> currentCommand;
     bool commandRunning;
+    SpscRingBuffer<ICommand*, REQUEST_QUEUE_SIZE> requests;  // nullptr = stop, otherwise start and take ownership
 
-public:
-    CommandExecutor() : commandRunning(false) {}
-    
-    bool executeCommand(std::unique_ptr<ICommand> command) {
-        if (!command) return false;
+    void applyStart(std::unique_ptr<ICommand> command) {
+        // A streaming command takes newer input without a restart
+        if (currentCommand && currentCommand->absorb(*command)) {
+            return;
+        }
         
         if (currentCommand) {
             if (!currentCommand->isInterruptible()) {
                 TELEM_LOGF("⚠️ Cannot interrupt non-interruptible command: %s", 
                           currentCommand->getName());
-                return false;
+                return;
             }
             
             TELEM_LOGF("🛑 Stopping command: %s", currentCommand->getName());
@@ -36,14 +45,61 @@ public:
                       command->isBlocking() ? "blocking" : "non-blocking");
             currentCommand = std::move(command);
             commandRunning = true;
-            return true;
+            return;
         }
         
         TELEM_LOGF("❌ Failed to start command: %s", command->getName());
-        return false;
     }
     
+    void applyStop() {
+        if (currentCommand) {
+            TELEM_LOGF_ERROR("Stopping command: %s", currentCommand->getName());
+            currentCommand->stop();
+            currentCommand.reset();
+            commandRunning = false;
+        }
+    }
+
+public:
+    CommandExecutor() : commandRunning(false) {}
+    
+    ~CommandExecutor() {
+        ICommand* pending;
+        while (requests.pop(pending)) {
+            delete pending;
+        }
+    }
+    
+    // Producer side: queued until the next update()
+    bool executeCommand(std::unique_ptr<ICommand> command) {
+        if (!command) return false;
+        
+        ICommand* pending = command.release();
+        if (!requests.push(pending)) {
+            TELEM_LOGF_WARNING("Command queue full, dropping %s", pending->getName());
+            delete pending;
+            return false;
+        }
+        return true;
+    }
+    
+    void stopCurrentCommand() {
+        if (!requests.push(nullptr)) {
+            TELEM_LOG_WARNING("Command queue full, dropping stop request");
+        }
+    }
+    
+    // Loop task only
     void update() {
+        ICommand* pending;
+        while (requests.pop(pending)) {
+            if (pending) {
+                applyStart(std::unique_ptr<ICommand>(pending));
+            } else {
+                applyStop();
+            }
+        }
+        
         if (!commandRunning || !currentCommand) {
             return;
         }
@@ -58,15 +114,6 @@ public:
         }
     }
     
-    void stopCurrentCommand() {
-        if (currentCommand) {
-            TELEM_LOGF_ERROR("Stopping command: %s", currentCommand->getName());
-            currentCommand->stop();
-            currentCommand.reset();
-            commandRunning = false;
-        }
-    }
-
     bool isCommandRunning() const {
         return commandRunning && currentCommand != nullptr;
     }
@@ -78,11 +125,6 @@ public:
     const char* getCurrentCommandName() const {
         return currentCommand ? currentCommand->getName() : nullptr;
     }
-    
-    template<typename T>
-    T* getCurrentCommandAs() {
-        return dynamic_cast<T*>(currentCommand.get());
-    }
 };
 
 #endif
@@ -6,9 +6,12 @@
 #include "DirectMotorCommand.h"
 #include "VelocityCommand.h"
 #include "CalibrationCommand.h"
+#include "AutoTuneCommand.h"
+#include "SystemIdCommand.h"
 #include "AutonomousSequenceCommand.h"
 #include "../../drive/DriveController.h"
 #include "../../drive/VelocityController.h"
+#include "../../drive/PoseEstimator.h"
 #include "../../hardware/Encoder.h"
 #include "../Telemetry.h"
 #include <memory>
@@ -33,19 +36,22 @@ private:
     VelocityController* velocityController;
     Encoder* leftEncoder;
     Encoder* rightEncoder;
+    PoseEstimator* poseEstimator;
 
 public:
     CommandFactory(DriveController* drive, VelocityController* velCtrl, 
                    Encoder* left, Encoder* right)
         : driveController(drive), velocityController(velCtrl),
-          leftEncoder(left), rightEncoder(right) {}
+          leftEncoder(left), rightEncoder(right), poseEstimator(nullptr) {}
     
-    std::unique_ptr<JoystickCommand> createJoystickCommand() {
-        return std::make_unique<JoystickCommand>(driveController);
+    void setPoseEstimator(PoseEstimator* estimator) { poseEstimator = estimator; }
+    
+    std::unique_ptr<JoystickCommand> createJoystickCommand(float x = 0, float y = 0) {
+        return std::make_unique<JoystickCommand>(velocityController, x, y);
     }
     
     std::unique_ptr<DirectMotorCommand> createDirectMotorCommand(float left = 0, float right = 0) {
-        return std::make_unique<DirectMotorCommand>(driveController, left, right);
+        return std::make_unique<DirectMotorCommand>(velocityController, left, right);
     }
     
     std::unique_ptr<VelocityCommand> createVelocityCommand(float velocity) {
@@ -55,12 +61,20 @@ public:
     std::unique_ptr<CalibrationCommand> createCalibrationCommand(
         const CalibrationCommand::Config& config) {
         return std::make_unique<CalibrationCommand>(
-            driveController, leftEncoder, rightEncoder, config);
+            velocityController, leftEncoder, rightEncoder, config);
+    }
+    
+    std::unique_ptr<AutoTuneCommand> createAutoTuneCommand(const AutoTuneCommand::Config& config) {
+        return std::make_unique<AutoTuneCommand>(velocityController, config);
+    }
+    
+    std::unique_ptr<SystemIdCommand> createSystemIdCommand(const SystemIdCommand::Config& config) {
+        return std::make_unique<SystemIdCommand>(velocityController, config);
     }
     
     std::unique_ptr<AutonomousSequenceCommand> createAutonomousSequence() {
         return std::make_unique<AutonomousSequenceCommand>(
-            velocityController, leftEncoder, rightEncoder);
+            velocityController, leftEncoder, rightEncoder, poseEstimator);
     }
     
     // Example: Create a pre-defined autonomous routine
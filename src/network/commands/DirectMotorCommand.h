@@ -2,7 +2,7 @@
 #define DIRECT_MOTOR_COMMAND_H
 
 #include "ICommand.h"
-#include "../../drive/DriveController.h"
+#include "../../drive/VelocityController.h"
 
 /**
  * Non-blocking direct motor power command
@@ -10,18 +10,17 @@
  */
 class DirectMotorCommand : public ICommand {
 private:
-    DriveController* driveController;
+    VelocityController* velocityController;
     float leftPower, rightPower;
     unsigned long lastUpdateTime;
     static constexpr unsigned long TIMEOUT_MS = 500;
 
 public:
-    DirectMotorCommand(DriveController* drive, float left = 0, float right = 0)
-        : driveController(drive), leftPower(left), rightPower(right), lastUpdateTime(0) {}
+    DirectMotorCommand(VelocityController* velCtrl, float left = 0, float right = 0)
+        : velocityController(velCtrl), leftPower(left), rightPower(right), lastUpdateTime(0) {}
     
     bool start() override {
-        driveController->setLeftMotorPower(leftPower);
-        driveController->setRightMotorPower(rightPower);
+        velocityController->setPower(leftPower, rightPower);
         lastUpdateTime = millis();
         return true;
     }
@@ -35,20 +34,25 @@ public:
     }
     
     void stop() override {
-        driveController->setLeftMotorPower(0);
-        driveController->setRightMotorPower(0);
+        velocityController->release();
     }
     
     bool isBlocking() const override { return false; }
     const char* getName() const override { return "DirectMotor"; }
     bool isInterruptible() const override { return true; }
     
-    // Update motor powers (called from WebSocket handler)
+    bool absorb(const ICommand& newer) override {
+        const DirectMotorCommand* input = dynamic_cast<const DirectMotorCommand*>(&newer);
+        if (!input) return false;
+        setMotorPowers(input->leftPower, input->rightPower);
+        return true;
+    }
+    
+    // Update motor powers (loop task, via absorb())
     void setMotorPowers(float left, float right) {
         leftPower = left;
         rightPower = right;
-        driveController->setLeftMotorPower(left);
-        driveController->setRightMotorPower(right);
+        velocityController->setPower(left, right);
         lastUpdateTime = millis();
     }
 };
@@ -22,6 +22,10 @@ public:
     virtual const char* getName() const = 0;
     
     virtual bool isInterruptible() const { return true; }
+    
+    // Called on the running command when a new one is queued; return true to take its input
+    // instead of being replaced (streaming input such as joystick updates)
+    virtual bool absorb(const ICommand& newer) { return false; }
 };
 
 #endif
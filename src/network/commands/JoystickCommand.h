@@ -3,6 +3,8 @@
 
 #include "ICommand.h"
 #include "../../drive/DriveController.h"
+#include "../../drive/VelocityController.h"
+#include "../Telemetry.h"
 
 /**
  * Non-blocking joystick control command
@@ -10,17 +12,17 @@
  */
 class JoystickCommand : public ICommand {
 private:
-    DriveController* driveController;
+    VelocityController* velocityController;
     float x, y;  // Current joystick position
     unsigned long lastUpdateTime;
     static constexpr unsigned long TIMEOUT_MS = 500;
 
 public:
-    JoystickCommand(DriveController* drive) 
-        : driveController(drive), x(0), y(0), lastUpdateTime(0) {}
+    JoystickCommand(VelocityController* velCtrl, float newX = 0, float newY = 0) 
+        : velocityController(velCtrl), x(newX), y(newY), lastUpdateTime(0) {}
     
     bool start() override {
-        lastUpdateTime = millis();
+        updateJoystick(x, y);
         return true;
     }
     
@@ -37,20 +39,32 @@ public:
     
     void stop() override {
         // Stop motors when command ends
-        driveController->setLeftMotorPower(0);
-        driveController->setRightMotorPower(0);
+        velocityController->release();
     }
     
     bool isBlocking() const override { return false; }
     const char* getName() const override { return "Joystick"; }
     bool isInterruptible() const override { return true; }
     
-    // Update joystick position (called from WebSocket handler)
+    bool absorb(const ICommand& newer) override {
+        const JoystickCommand* input = dynamic_cast<const JoystickCommand*>(&newer);
+        if (!input) return false;
+        updateJoystick(input->x, input->y);
+        return true;
+    }
+    
+    // Update joystick position (loop task, via absorb())
     void updateJoystick(float newX, float newY) {
         x = newX;
         y = newY;
         lastUpdateTime = millis();
-        driveController->setPowerControl(y, x);
+        
+        float leftPower;
+        float rightPower;
+        DriveController::mix(y, x, leftPower, rightPower);
+        velocityController->setPower(leftPower, rightPower);
+        
+        TELEM_LOGF_INFO("Fwd:%.2f Turn:%.2f -> L:%.2f R:%.2f", y, x, leftPower, rightPower);
     }
     
     bool isAtCenter() const {
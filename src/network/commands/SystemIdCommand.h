@@ -0,0 +1,263 @@
+#ifndef SYSTEM_ID_COMMAND_H
+#define SYSTEM_ID_COMMAND_H
+
+#include "ICommand.h"
+#include "config.h"
+#include "../../drive/VelocityController.h"
+#include "../../drive/ControlTickHook.h"
+#include "../../utils/ExcitationSignal.h"
+#include "../../utils/FopdtFit.h"
+#include "../Telemetry.h"
+#include <functional>
+#include <memory>
+#include <new>
+#include <string.h>
+
+/**
+ * Blocking system identification command
+ * The selected wheels are held at the bias PWM for a lead-in, then driven by a step, PRBS or chirp from the control tick.
+ * PWM and velocity are captured every tick into RAM, a first-order-plus-dead-time model is fitted per wheel,
+ * and the capture is streamed to the client in binary chunks.
+ */
+class SystemIdCommand : public ICommand, public ControlTickHook {
+public:
+    struct Config {
+        String motor;  // "left", "right", or "both"
+        ExcitationSignal::Config excitation;
+    };
+
+    // Little-endian on the wire
+    struct __attribute__((packed)) Sample {
+        uint32_t timeUs;        // since the end of the lead-in
+        int16_t leftPWM;
+        int16_t rightPWM;
+        int16_t leftVelocity;   // 0.01 cm/s
+        int16_t rightVelocity;
+    };
+
+    struct __attribute__((packed)) ChunkHeader {
+        char magic[4];          // "SYID"
+        uint16_t chunk;
+        uint16_t chunkCount;
+        uint32_t firstSample;
+        uint16_t sampleCount;
+    };
+
+    static constexpr int CHUNK_SAMPLES = 100;
+    static constexpr float VELOCITY_SCALE = 100.0f;
+
+    using ProgressCallback = std::function<void(int samples, int capacity)>;
+    using FitCallback = std::function<void(const char* wheel, const FopdtFit::Result& result)>;
+    using CaptureCallback = std::function<void(int samples, int chunks, float sampleRateHz)>;
+    // Returns false if the chunk could not be queued; it is offered again on the next update
+    using ChunkCallback = std::function<bool(const uint8_t* data, size_t len)>;
+    using CompleteCallback = std::function<void()>;
+
+private:
+    enum class Phase : uint8_t {
+        LeadIn,
+        Capturing,
+        Captured,
+        Streaming
+    };
+
+    VelocityController* velocityController;
+    Config config;
+    bool driveLeft;
+    bool driveRight;
+
+    ExcitationSignal excitation;
+    std::unique_ptr<Sample[]> samples;
+    int capacity;
+    volatile int sampleCount;
+    volatile Phase phase;
+    float leadInElapsed;
+    float captureElapsed;
+
+    int nextChunk;
+    int chunkCount;
+    int reportedSamples;
+    uint8_t chunkBuffer[sizeof(ChunkHeader) + CHUNK_SAMPLES * sizeof(Sample)];
+
+    ProgressCallback onProgress;
+    FitCallback onFit;
+    CaptureCallback onCapture;
+    ChunkCallback onChunk;
+    CompleteCallback onComplete;
+
+public:
+    SystemIdCommand(VelocityController* velCtrl, const Config& cfg)
+        : velocityController(velCtrl), config(cfg), driveLeft(false), driveRight(false),
+          capacity(0), sampleCount(0), phase(Phase::LeadIn), leadInElapsed(0), captureElapsed(0),
+          nextChunk(0), chunkCount(0), reportedSamples(0), chunkBuffer() {}
+
+    bool start() override {
+        driveLeft = config.motor == "left" || config.motor == "both";
+        driveRight = config.motor == "right" || config.motor == "both";
+        if (!driveLeft && !driveRight) return false;
+        if (config.excitation.duration <= 0) return false;
+
+        capacity = (int)(config.excitation.duration * CONTROL_LOOP_RATE_HZ) + 1;
+        if (capacity > SYSTEM_ID_MAX_SAMPLES) capacity = SYSTEM_ID_MAX_SAMPLES;
+        samples.reset(new (std::nothrow) Sample[capacity]);
+        if (!samples) {
+            TELEM_LOGF_ERROR("System ID: no memory for %d samples", capacity);
+            return false;
+        }
+
+        excitation.begin(config.excitation);
+        sampleCount = 0;
+        leadInElapsed = 0;
+        captureElapsed = 0;
+        reportedSamples = 0;
+        phase = Phase::LeadIn;
+        velocityController->attachTickHook(this);
+        return true;
+    }
+
+    // Control task
+    void onControlTick(const EncoderSnapshot& snapshot, float dt, float& leftPWM, float& rightPWM) override {
+        float pwm = config.excitation.bias;
+
+        if (phase == Phase::LeadIn) {
+            leadInElapsed += dt;
+            if (leadInElapsed * 1000.0f >= SYSTEM_ID_LEAD_IN_MS) {
+                phase = Phase::Capturing;
+            }
+        } else if (phase == Phase::Capturing) {
+            // constrain() is a macro: advance the excitation once, outside it
+            pwm = excitation.next(dt);
+            pwm = constrain(pwm, -255.0f, 255.0f);
+            captureElapsed += dt;
+
+            // The sample pairs this tick's command with the velocity measured at its start
+            int index = sampleCount;
+            Sample& sample = samples[index];
+            sample.timeUs = (uint32_t)(captureElapsed * 1e6f);
+            sample.leftPWM = driveLeft ? (int16_t)lroundf(pwm) : 0;
+            sample.rightPWM = driveRight ? (int16_t)lroundf(pwm) : 0;
+            sample.leftVelocity = toFixed(snapshot.leftVelocity);
+            sample.rightVelocity = toFixed(snapshot.rightVelocity);
+            sampleCount = index + 1;
+
+            if (sampleCount >= capacity || excitation.isFinished()) {
+                phase = Phase::Captured;
+            }
+        }
+
+        leftPWM = driveLeft ? pwm : 0;
+        rightPWM = driveRight ? pwm : 0;
+    }
+
+    bool update() override {
+        if (phase == Phase::LeadIn) return true;
+
+        if (phase == Phase::Capturing) {
+            int count = sampleCount;
+            if (count - reportedSamples >= capacity / 10) {
+                reportedSamples = count;
+                if (onProgress) onProgress(count, capacity);
+            }
+            return true;
+        }
+
+        if (phase == Phase::Captured) {
+            velocityController->detachTickHook();
+            velocityController->release();
+            if (onProgress) onProgress(sampleCount, capacity);
+
+            fitCapture();
+
+            chunkCount = (sampleCount + CHUNK_SAMPLES - 1) / CHUNK_SAMPLES;
+            nextChunk = 0;
+            phase = Phase::Streaming;
+            if (onCapture) onCapture(sampleCount, chunkCount, sampleRate());
+            return true;
+        }
+
+        if (nextChunk < chunkCount) {
+            size_t len = buildChunk(nextChunk);
+            if (!onChunk || onChunk(chunkBuffer, len)) {
+                nextChunk++;
+            }
+            return true;
+        }
+
+        if (onComplete) onComplete();
+        return false;
+    }
+
+    void stop() override {
+        velocityController->detachTickHook();
+        velocityController->release();
+    }
+
+    bool isBlocking() const override { return true; }
+    const char* getName() const override { return "SystemId"; }
+    bool isInterruptible() const override { return true; }
+
+    void setProgressCallback(ProgressCallback cb) { onProgress = cb; }
+    void setFitCallback(FitCallback cb) { onFit = cb; }
+    void setCaptureCallback(CaptureCallback cb) { onCapture = cb; }
+    void setChunkCallback(ChunkCallback cb) { onChunk = cb; }
+    void setCompleteCallback(CompleteCallback cb) { onComplete = cb; }
+
+private:
+    static int16_t toFixed(float velocity) {
+        return (int16_t)constrain(lroundf(velocity * VELOCITY_SCALE), -32767L, 32767L);
+    }
+
+    float sampleTime() const {
+        int n = sampleCount;
+        if (n < 2) return 0;
+        return (samples[n - 1].timeUs - samples[0].timeUs) * 1e-6f / (n - 1);
+    }
+
+    float sampleRate() const {
+        float dt = sampleTime();
+        return dt > 0 ? 1.0f / dt : 0;
+    }
+
+    void fitCapture() {
+        if (!onFit) return;
+
+        const Sample* data = samples.get();
+        int n = sampleCount;
+        float dt = sampleTime();
+        int maxDelay = dt > 0 ? (int)(SYSTEM_ID_MAX_DELAY_MS * 1e-3f / dt) : 0;
+
+        if (driveLeft) {
+            FopdtFit::Result result = FopdtFit::fit(
+                [data](int i) { return (float)data[i].leftPWM; },
+                [data](int i) { return data[i].leftVelocity / VELOCITY_SCALE; },
+                n, dt, maxDelay);
+            onFit("left", result);
+        }
+        if (driveRight) {
+            FopdtFit::Result result = FopdtFit::fit(
+                [data](int i) { return (float)data[i].rightPWM; },
+                [data](int i) { return data[i].rightVelocity / VELOCITY_SCALE; },
+                n, dt, maxDelay);
+            onFit("right", result);
+        }
+    }
+
+    size_t buildChunk(int chunk) {
+        int first = chunk * CHUNK_SAMPLES;
+        int count = sampleCount - first;
+        if (count > CHUNK_SAMPLES) count = CHUNK_SAMPLES;
+
+        ChunkHeader header;
+        memcpy(header.magic, "SYID", 4);
+        header.chunk = chunk;
+        header.chunkCount = chunkCount;
+        header.firstSample = first;
+        header.sampleCount = count;
+
+        memcpy(chunkBuffer, &header, sizeof(header));
+        memcpy(chunkBuffer + sizeof(header), &samples[first], count * sizeof(Sample));
+        return sizeof(header) + count * sizeof(Sample);
+    }
+};
+
+#endif
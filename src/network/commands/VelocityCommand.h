@@ -26,10 +26,7 @@ public:
     }
     
     bool update() override {
-        // Let velocity controller handle the control loop
-        velocityController->update();
-        
-        // Timeout check
+        // The control task runs the loop; only the timeout is checked here
         if (millis() - lastUpdateTime > TIMEOUT_MS) {
             return false;
         }
@@ -38,13 +35,20 @@ public:
     }
     
     void stop() override {
-        velocityController->setVelocity(0, 0);
+        velocityController->release();
     }
     
     bool isBlocking() const override { return false; }
     const char* getName() const override { return "Velocity"; }
     bool isInterruptible() const override { return true; }
     
+    bool absorb(const ICommand& newer) override {
+        const VelocityCommand* input = dynamic_cast<const VelocityCommand*>(&newer);
+        if (!input) return false;
+        updateVelocity(input->targetVelocity);
+        return true;
+    }
+    
     void updateVelocity(float velocity) {
         targetVelocity = velocity;
         velocityController->setVelocity(velocity, velocity);
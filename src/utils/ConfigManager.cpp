@@ -1,5 +1,36 @@
 #include "ConfigManager.h"
 
+// "motorMappings": {"left_fwd": {"vel2pwm": [a0..a3], "pwm2vel": [b0..b3]}, ...}
+static void readMotorMappings(JsonVariant mappings, ConfigManager::Config& config) {
+    for (int i = 0; i < MOTOR_MAPPING_COUNT; i++) {
+        JsonVariant entry = mappings[motorMappingName((MotorMapping)i)];
+        if (!entry["vel2pwm"].is<JsonArray>() || !entry["pwm2vel"].is<JsonArray>()) continue;
+        
+        ConfigManager::Config::MappingFit& fit = config.motorMappings[i];
+        for (int j = 0; j < 4; j++) {
+            fit.vel2pwm[j] = entry["vel2pwm"][j] | 0.0f;
+            fit.pwm2vel[j] = entry["pwm2vel"][j] | 0.0f;
+        }
+        fit.valid = true;
+    }
+}
+
+static void writeMotorMappings(JsonDocument& doc, const ConfigManager::Config& config) {
+    JsonObject mappings = doc["motorMappings"].to<JsonObject>();
+    for (int i = 0; i < MOTOR_MAPPING_COUNT; i++) {
+        const ConfigManager::Config::MappingFit& fit = config.motorMappings[i];
+        if (!fit.valid) continue;
+        
+        JsonObject entry = mappings[motorMappingName((MotorMapping)i)].to<JsonObject>();
+        JsonArray vel2pwm = entry["vel2pwm"].to<JsonArray>();
+        JsonArray pwm2vel = entry["pwm2vel"].to<JsonArray>();
+        for (int j = 0; j < 4; j++) {
+            vel2pwm.add(fit.vel2pwm[j]);
+            pwm2vel.add(fit.pwm2vel[j]);
+        }
+    }
+}
+
 ConfigManager::ConfigManager(const char* path) : configPath(path) {
     config = Config();  // Initialize with defaults
 }
@@ -33,9 +64,12 @@ bool ConfigManager::load() {
     config.pidKp = doc["pidKp"] | 0.0f;
     config.pidKi = doc["pidKi"] | 0.0f;
     config.pidKd = doc["pidKd"] | 0.0f;
+    config.voltageCompensationEnabled = doc["voltageCompensationEnabled"] | false;
+    config.nominalVoltage = doc["nominalVoltage"] | VOLTAGE_COMP_NOMINAL;
     
     // Load polynomial parameters
     config.polynomialEnabled = doc["polynomialEnabled"] | false;
+    config.lookupTableEnabled = doc["lookupTableEnabled"] | false;
     config.vel2pwm_a0 = doc["vel2pwm_a0"] | 0.0f;
     config.vel2pwm_a1 = doc["vel2pwm_a1"] | 1.0f;
     config.vel2pwm_a2 = doc["vel2pwm_a2"] | 0.0f;
@@ -46,6 +80,11 @@ bool ConfigManager::load() {
     config.pwm2vel_b2 = doc["pwm2vel_b2"] | 0.0f;
     config.pwm2vel_b3 = doc["pwm2vel_b3"] | 0.0f;
     
+    for (Config::MappingFit& fit : config.motorMappings) {
+        fit.valid = false;
+    }
+    readMotorMappings(doc["motorMappings"], config);
+    
     Serial.println("✓ Configuration loaded successfully");
     return true;
 }
@@ -60,9 +99,12 @@ bool ConfigManager::save() {
     doc["pidKp"] = config.pidKp;
     doc["pidKi"] = config.pidKi;
     doc["pidKd"] = config.pidKd;
+    doc["voltageCompensationEnabled"] = config.voltageCompensationEnabled;
+    doc["nominalVoltage"] = config.nominalVoltage;
     
     // Save polynomial parameters
     doc["polynomialEnabled"] = config.polynomialEnabled;
+    doc["lookupTableEnabled"] = config.lookupTableEnabled;
     doc["vel2pwm_a0"] = config.vel2pwm_a0;
     doc["vel2pwm_a1"] = config.vel2pwm_a1;
     doc["vel2pwm_a2"] = config.vel2pwm_a2;
@@ -73,6 +115,8 @@ bool ConfigManager::save() {
     doc["pwm2vel_b2"] = config.pwm2vel_b2;
     doc["pwm2vel_b3"] = config.pwm2vel_b3;
     
+    writeMotorMappings(doc, config);
+    
     File file = LittleFS.open(configPath, "w");
     if (!file) {
         Serial.println("Failed to open config file for writing");
@@ -112,8 +156,11 @@ bool ConfigManager::updateFromJson(const String& jsonStr) {
     if (doc["pidKp"].is<float>()) config.pidKp = doc["pidKp"];
     if (doc["pidKi"].is<float>()) config.pidKi = doc["pidKi"];
     if (doc["pidKd"].is<float>()) config.pidKd = doc["pidKd"];
+    if (doc["voltageCompensationEnabled"].is<bool>()) config.voltageCompensationEnabled = doc["voltageCompensationEnabled"];
+    if (doc["nominalVoltage"].is<float>()) config.nominalVoltage = doc["nominalVoltage"];
     
     if (doc["polynomialEnabled"].is<bool>()) config.polynomialEnabled = doc["polynomialEnabled"];
+    if (doc["lookupTableEnabled"].is<bool>()) config.lookupTableEnabled = doc["lookupTableEnabled"];
     if (doc["vel2pwm_a0"].is<float>()) config.vel2pwm_a0 = doc["vel2pwm_a0"];
     if (doc["vel2pwm_a1"].is<float>()) config.vel2pwm_a1 = doc["vel2pwm_a1"];
     if (doc["vel2pwm_a2"].is<float>()) config.vel2pwm_a2 = doc["vel2pwm_a2"];
@@ -124,6 +171,8 @@ bool ConfigManager::updateFromJson(const String& jsonStr) {
     if (doc["pwm2vel_b2"].is<float>()) config.pwm2vel_b2 = doc["pwm2vel_b2"];
     if (doc["pwm2vel_b3"].is<float>()) config.pwm2vel_b3 = doc["pwm2vel_b3"];
     
+    readMotorMappings(doc["motorMappings"], config);
+    
     return true;
 }
 
@@ -136,8 +185,11 @@ String ConfigManager::toJson() const {
     doc["pidKp"] = config.pidKp;
     doc["pidKi"] = config.pidKi;
     doc["pidKd"] = config.pidKd;
+    doc["voltageCompensationEnabled"] = config.voltageCompensationEnabled;
+    doc["nominalVoltage"] = config.nominalVoltage;
     
     doc["polynomialEnabled"] = config.polynomialEnabled;
+    doc["lookupTableEnabled"] = config.lookupTableEnabled;
     doc["vel2pwm_a0"] = config.vel2pwm_a0;
     doc["vel2pwm_a1"] = config.vel2pwm_a1;
     doc["vel2pwm_a2"] = config.vel2pwm_a2;
@@ -148,6 +200,8 @@ String ConfigManager::toJson() const {
     doc["pwm2vel_b2"] = config.pwm2vel_b2;
     doc["pwm2vel_b3"] = config.pwm2vel_b3;
     
+    writeMotorMappings(doc, config);
+    
     String output;
     serializeJson(doc, output);
     return output;
@@ -159,12 +213,21 @@ void ConfigManager::print() const {
     Serial.printf("Deadzone: %.1f PWM\n", config.deadzonePWM);
     Serial.printf("PID Enabled: %s\n", config.pidEnabled ? "Yes" : "No");
     Serial.printf("PID Gains: Kp=%.3f Ki=%.3f Kd=%.3f\n", config.pidKp, config.pidKi, config.pidKd);
+    Serial.printf("Voltage Compensation: %s (nominal %.2f V)\n",
+                 config.voltageCompensationEnabled ? "Enabled" : "Disabled", config.nominalVoltage);
     Serial.printf("Polynomial Mapping: %s\n", config.polynomialEnabled ? "Enabled" : "Disabled");
+    Serial.printf("Lookup Table: %s\n", config.lookupTableEnabled ? "Enabled" : "Disabled");
     if (config.polynomialEnabled) {
         Serial.printf("Vel->PWM: %.6f + %.6f*v + %.6f*v² + %.6f*v³\n", 
                      config.vel2pwm_a0, config.vel2pwm_a1, config.vel2pwm_a2, config.vel2pwm_a3);
         Serial.printf("PWM->Vel: %.6f + %.6f*p + %.6f*p² + %.6f*p³\n", 
                      config.pwm2vel_b0, config.pwm2vel_b1, config.pwm2vel_b2, config.pwm2vel_b3);
+        for (int i = 0; i < MOTOR_MAPPING_COUNT; i++) {
+            const Config::MappingFit& fit = config.motorMappings[i];
+            if (!fit.valid) continue;
+            Serial.printf("%s Vel->PWM: %.6f + %.6f*v + %.6f*v² + %.6f*v³\n", motorMappingName((MotorMapping)i),
+                         fit.vel2pwm[0], fit.vel2pwm[1], fit.vel2pwm[2], fit.vel2pwm[3]);
+        }
     }
     Serial.println("=============================");
 }
@@ -4,6 +4,8 @@
 #include <Arduino.h>
 #include <ArduinoJson.h>
 #include <LittleFS.h>
+#include "config.h"
+#include "../drive/MotorMapping.h"
 
 /**
  * Persistent storage for robot configuration and tuning parameters
@@ -20,8 +22,13 @@ public:
         float pidKi;
         float pidKd;
         
+        // Battery voltage compensation
+        bool voltageCompensationEnabled;
+        float nominalVoltage;
+        
         // Polynomial Coefficients (Velocity -> PWM)
         bool polynomialEnabled;
+        bool lookupTableEnabled;
         float vel2pwm_a0;
         float vel2pwm_a1;
         float vel2pwm_a2;
@@ -33,6 +40,14 @@ public:
         float pwm2vel_b2;
         float pwm2vel_b3;
         
+        // Per wheel and direction cubic fits; a valid entry overrides the polynomials above for that mapping
+        struct MappingFit {
+            bool valid;
+            float vel2pwm[4];
+            float pwm2vel[4];
+        };
+        MappingFit motorMappings[MOTOR_MAPPING_COUNT];
+        
         // Default constructor with sensible defaults
         Config() :
             feedforwardGain(3.0f),
@@ -41,7 +56,10 @@ public:
             pidKp(0.0f),
             pidKi(0.0f),
             pidKd(0.0f),
+            voltageCompensationEnabled(false),
+            nominalVoltage(VOLTAGE_COMP_NOMINAL),
             polynomialEnabled(false),
+            lookupTableEnabled(false),
             vel2pwm_a0(0.0f),
             vel2pwm_a1(1.0f),
             vel2pwm_a2(0.0f),
@@ -49,7 +67,11 @@ public:
             pwm2vel_b0(0.0f),
             pwm2vel_b1(1.0f),
             pwm2vel_b2(0.0f),
-            pwm2vel_b3(0.0f) {}
+            pwm2vel_b3(0.0f) {
+            for (MappingFit& fit : motorMappings) {
+                fit = MappingFit{false, {0.0f, 1.0f, 0.0f, 0.0f}, {0.0f, 1.0f, 0.0f, 0.0f}};
+            }
+        }
     };
     
     ConfigManager(const char* configPath = "/config.json");
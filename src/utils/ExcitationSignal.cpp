@@ -0,0 +1,63 @@
+#include "ExcitationSignal.h"
+#include <math.h>
+#include <string.h>
+
+ExcitationSignal::ExcitationSignal()
+    : config{Type::Step, 0, 0, 0, 0, 0, 0, 0}, elapsed(0), bitElapsed(0), lfsr(1), prbsHigh(true) {}
+
+void ExcitationSignal::begin(const Config& cfg) {
+    config = cfg;
+    elapsed = 0;
+    bitElapsed = 0;
+    lfsr = 0x1FF;
+    prbsHigh = true;
+}
+
+float ExcitationSignal::next(float dt) {
+    elapsed += dt;
+    float t = elapsed;
+
+    switch (config.type) {
+        case Type::Step:
+            return config.bias + (t >= config.stepTime ? config.amplitude : 0.0f);
+
+        case Type::Prbs:
+            bitElapsed += dt;
+            while (config.bitTime > 0 && bitElapsed >= config.bitTime) {
+                bitElapsed -= config.bitTime;
+                // x^9 + x^5 + 1
+                uint16_t bit = ((lfsr >> 8) ^ (lfsr >> 4)) & 1;
+                lfsr = ((lfsr << 1) | bit) & 0x1FF;
+                prbsHigh = bit;
+            }
+            return config.bias + (prbsHigh ? config.amplitude : -config.amplitude);
+
+        case Type::Chirp: {
+            // Instantaneous frequency rises linearly from startHz to endHz over the duration
+            float sweepRate = config.duration > 0 ? (config.endHz - config.startHz) / config.duration : 0;
+            float phase = 2.0f * (float)M_PI * (config.startHz * t + 0.5f * sweepRate * t * t);
+            return config.bias + config.amplitude * sinf(phase);
+        }
+    }
+    return config.bias;
+}
+
+namespace {
+const char* const TYPE_NAMES[] = {"step", "prbs", "chirp"};
+constexpr int TYPE_COUNT = sizeof(TYPE_NAMES) / sizeof(TYPE_NAMES[0]);
+}
+
+bool ExcitationSignal::parseType(const char* name, Type& type) {
+    for (int i = 0; i < TYPE_COUNT; i++) {
+        if (strcmp(name, TYPE_NAMES[i]) == 0) {
+            type = (Type)i;
+            return true;
+        }
+    }
+    return false;
+}
+
+const char* ExcitationSignal::typeName(Type type) {
+    int index = (int)type;
+    return (index >= 0 && index < TYPE_COUNT) ? TYPE_NAMES[index] : "";
+}
@@ -0,0 +1,49 @@
+#ifndef EXCITATIONSIGNAL_H
+#define EXCITATIONSIGNAL_H
+
+#include <stdint.h>
+
+/**
+ * Test input for system identification: bias plus a step, PRBS or linear chirp of the given amplitude
+ * The PRBS is a 9-bit maximal-length LFSR (period 511 bits) held for bitTime per bit
+ */
+class ExcitationSignal {
+public:
+    enum class Type {
+        Step,
+        Prbs,
+        Chirp
+    };
+
+    struct Config {
+        Type type;
+        float bias;
+        float amplitude;
+        float duration;     // seconds
+        float stepTime;     // seconds into the capture (Step)
+        float bitTime;      // seconds per PRBS bit
+        float startHz;      // chirp sweep
+        float endHz;
+    };
+
+    ExcitationSignal();
+
+    void begin(const Config& config);
+    // Advances by dt and returns the input for the new time
+    float next(float dt);
+
+    float getElapsed() const { return elapsed; }
+    bool isFinished() const { return elapsed >= config.duration; }
+
+    static bool parseType(const char* name, Type& type);
+    static const char* typeName(Type type);
+
+private:
+    Config config;
+    float elapsed;
+    float bitElapsed;
+    uint16_t lfsr;
+    bool prbsHigh;
+};
+
+#endif
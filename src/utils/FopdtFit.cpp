@@ -0,0 +1,40 @@
+#include "FopdtFit.h"
+
+bool FopdtFit::solve3(float A[3][3], float b[3]) {
+    // Gaussian elimination with partial pivoting
+    for (int col = 0; col < 3; col++) {
+        int pivot = col;
+        for (int row = col + 1; row < 3; row++) {
+            if (fabsf(A[row][col]) > fabsf(A[pivot][col])) pivot = row;
+        }
+        if (fabsf(A[pivot][col]) < 1e-12f) return false;
+
+        if (pivot != col) {
+            for (int j = 0; j < 3; j++) {
+                float tmp = A[col][j];
+                A[col][j] = A[pivot][j];
+                A[pivot][j] = tmp;
+            }
+            float tmp = b[col];
+            b[col] = b[pivot];
+            b[pivot] = tmp;
+        }
+
+        for (int row = col + 1; row < 3; row++) {
+            float factor = A[row][col] / A[col][col];
+            for (int j = col; j < 3; j++) {
+                A[row][j] -= factor * A[col][j];
+            }
+            b[row] -= factor * b[col];
+        }
+    }
+
+    for (int row = 2; row >= 0; row--) {
+        float sum = b[row];
+        for (int j = row + 1; j < 3; j++) {
+            sum -= A[row][j] * b[j];
+        }
+        b[row] = sum / A[row][row];
+    }
+    return true;
+}
@@ -0,0 +1,119 @@
+#ifndef FOPDTFIT_H
+#define FOPDTFIT_H
+
+#include <math.h>
+
+/**
+ * First-order-plus-dead-time fit, tau * dy/dt = -y + K * u(t - L) + offset, from uniformly sampled input/output
+ * For each whole-sample delay d the discrete model y[k+1] = a*y[k] + b*u[k-d] + c is solved by least squares,
+ * then refined by instrumental variables (the model's own simulated output as instrument) to remove the bias
+ * that measurement noise on y[k] causes; the delay whose model best reproduces y in free-run simulation wins.
+ * Sums run in single precision (the ESP32-S3 FPU has no double) on mean-removed data to keep them well conditioned.
+ */
+class FopdtFit {
+public:
+    struct Result {
+        bool ok;
+        float gain;           // output units per input unit
+        float timeConstant;   // seconds
+        float deadTime;       // seconds
+        float offset;         // output at zero input
+        float fitPercent;     // 100 * (1 - |y - ysim| / |y - mean(y)|) of the free-run simulation
+        int points;
+    };
+
+    // u(i) and y(i) return sample i as float; sampleTime in seconds
+    template<typename InputFn, typename OutputFn>
+    static Result fit(InputFn u, OutputFn y, int n, float sampleTime, int maxDelaySamples);
+
+private:
+    static constexpr int IV_ITERATIONS = 2;
+
+    // Solves the 3x3 system in place; false if singular
+    static bool solve3(float A[3][3], float b[3]);
+};
+
+template<typename InputFn, typename OutputFn>
+FopdtFit::Result FopdtFit::fit(InputFn u, OutputFn y, int n, float sampleTime, int maxDelaySamples) {
+    Result best = {false, 0, 0, 0, 0, 0, n};
+    if (n < 10 || sampleTime <= 0) return best;
+
+    float inputSum = 0;
+    float outputSum = 0;
+    for (int i = 0; i < n; i++) {
+        inputSum += u(i);
+        outputSum += y(i);
+    }
+    float inputMean = inputSum / n;
+    float outputMean = outputSum / n;
+
+    float variation = 0;
+    for (int i = 0; i < n; i++) {
+        float e = y(i) - outputMean;
+        variation += e * e;
+    }
+    if (variation <= 0) return best;
+
+    float bestError = -1;
+    for (int d = 0; d <= maxDelaySamples && d < n - 10; d++) {
+        float theta[3] = {0, 0, 0};
+        bool solved = false;
+
+        // Pass 0 is ordinary least squares (instrument = regressor); later passes use the simulated output
+        for (int pass = 0; pass <= IV_ITERATIONS; pass++) {
+            float A[3][3] = {};
+            float rhs[3] = {};
+            float ySim = y(0) - outputMean;
+            for (int k = 0; k < n - 1; k++) {
+                float input = u(k >= d ? k - d : 0) - inputMean;
+                if (k >= d) {
+                    float phi[3] = {y(k) - outputMean, input, 1.0f};
+                    float z[3] = {pass == 0 ? phi[0] : ySim, input, 1.0f};
+                    float target = y(k + 1) - outputMean;
+                    for (int i = 0; i < 3; i++) {
+                        rhs[i] += z[i] * target;
+                        for (int j = 0; j < 3; j++) {
+                            A[i][j] += z[i] * phi[j];
+                        }
+                    }
+                }
+                ySim = theta[0] * ySim + theta[1] * input + theta[2];
+            }
+
+            if (!solve3(A, rhs) || rhs[0] <= 0 || rhs[0] >= 1) break;  // not a stable first-order response
+            theta[0] = rhs[0];
+            theta[1] = rhs[1];
+            theta[2] = rhs[2];
+            solved = true;
+        }
+        if (!solved) continue;
+
+        float a = theta[0];
+        float b = theta[1];
+        float c = theta[2];
+
+        // Free-run simulation, with the input before the capture taken as the first sample
+        float ySim = y(0) - outputMean;
+        float error = 0;
+        for (int k = 0; k < n - 1; k++) {
+            float input = u(k >= d ? k - d : 0) - inputMean;
+            ySim = a * ySim + b * input + c;
+            float e = y(k + 1) - outputMean - ySim;
+            error += e * e;
+        }
+
+        if (bestError < 0 || error < bestError) {
+            bestError = error;
+            best.ok = true;
+            best.gain = b / (1 - a);
+            best.timeConstant = -sampleTime / logf(a);
+            best.deadTime = d * sampleTime;
+            best.offset = c / (1 - a) + outputMean - best.gain * inputMean;
+            best.fitPercent = 100.0f * (1.0f - sqrtf(error / variation));
+        }
+    }
+
+    return best;
+}
+
+#endif
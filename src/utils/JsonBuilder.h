@@ -2,6 +2,14 @@
 #define JSONBUILDER_H
 
 #include <Arduino.h>
+#include "Polynomial.h"
+#include "PolynomialFit.h"
+#include "RelayAutoTuner.h"
+#include "FopdtFit.h"
+#include "../drive/Localizer.h"
+#include "../drive/PoseEstimator.h"
+#include "../drive/MotorModelEstimator.h"
+#include "../hardware/EdgeCaptureStats.h"
 
 /**
  * JsonBuilder - Efficient JSON string builder for WebSocket responses
@@ -197,13 +205,16 @@ private:
 class EncoderJsonBuilder {
 public:
     static String buildEncoderData(
-        long leftCount, float leftRevs, float leftDist, float leftVel, float leftRPM,
-        long rightCount, float rightRevs, float rightDist, float rightVel, float rightRPM,
-        float battery,
+        long leftCount, float leftRevs, float leftDist, float leftVel, float leftRPM, unsigned long leftIllegal,
+        unsigned long leftOverruns, const EdgeCaptureStats& leftCapture,
+        long rightCount, float rightRevs, float rightDist, float rightVel, float rightRPM, unsigned long rightIllegal,
+        unsigned long rightOverruns, const EdgeCaptureStats& rightCapture,
+        float battery, float batterySoc, float voltageScale,
         float motorLeftPWM, float motorRightPWM,
-        float leftVelError, float rightVelError
+        float leftVelError, float rightVelError,
+        const LocalizerState& odometry, const PoseEstimate& estimate
     ) {
-        JsonBuilder json(512);
+        JsonBuilder json(1280);
         
         json.startObject()
             .startNestedObject("left")
@@ -212,6 +223,13 @@ public:
                 .addFloat("distance", leftDist, 2)
                 .addFloat("velocity", leftVel, 2)
                 .addFloat("rpm", leftRPM, 1)
+                .addLong("illegal", leftIllegal)
+                .addLong("edgeOverruns", leftOverruns)
+                .addBool("capture", leftCapture.active)
+                .addLong("edges", leftCapture.edges)
+                .addLong("edgesA", leftCapture.channelA)
+                .addLong("edgesB", leftCapture.channelB)
+                .addLong("minEdgeUs", leftCapture.minIntervalUs)
             .endObject()
             .startNestedObject("right")
                 .addLong("count", rightCount)
@@ -219,21 +237,53 @@ public:
                 .addFloat("distance", rightDist, 2)
                 .addFloat("velocity", rightVel, 2)
                 .addFloat("rpm", rightRPM, 1)
+                .addLong("illegal", rightIllegal)
+                .addLong("edgeOverruns", rightOverruns)
+                .addBool("capture", rightCapture.active)
+                .addLong("edges", rightCapture.edges)
+                .addLong("edgesA", rightCapture.channelA)
+                .addLong("edgesB", rightCapture.channelB)
+                .addLong("minEdgeUs", rightCapture.minIntervalUs)
             .endObject()
             .addFloat("battery", battery, 2)
+            .addFloat("batterySoc", batterySoc, 0)
+            .addFloat("voltageScale", voltageScale, 3)
             .addFloat("motorLeft", motorLeftPWM, 0)
             .addFloat("motorRight", motorRightPWM, 0)
             .addFloat("leftVelError", leftVelError, 2)
             .addFloat("rightVelError", rightVelError, 2)
+            .startNestedObject("pose")
+                .addFloat("x", estimate.pose.x, 2)
+                .addFloat("y", estimate.pose.y, 2)
+                .addFloat("theta", estimate.pose.theta, 4)
+                .addFloat("v", estimate.twist.linear, 2)
+                .addFloat("omega", estimate.twist.angular, 3)
+                .addFloat("varX", estimate.variance[0], 3)
+                .addFloat("varY", estimate.variance[1], 3)
+                .addFloat("varTheta", estimate.variance[2], 5)
+                .addFloat("gyroBias", estimate.gyroBias, 5)
+                .addBool("gyro", estimate.gyroActive)
+                .addLong("slips", estimate.slipEvents)
+            .endObject()
+            .startNestedObject("odometry")
+                .addFloat("x", odometry.pose.x, 2)
+                .addFloat("y", odometry.pose.y, 2)
+                .addFloat("theta", odometry.pose.theta, 4)
+                .addFloat("v", odometry.twist.linear, 2)
+                .addFloat("omega", odometry.twist.angular, 3)
+                .addFloat("varX", odometry.covariance[0], 3)
+                .addFloat("varY", odometry.covariance[3], 3)
+                .addFloat("varTheta", odometry.covariance[5], 5)
+            .endObject()
         .endObject();
         
         return json.toString();
     }
     
     static String buildSimpleEncoderData(
-        long leftCount, float leftRevs, float leftDist, float leftVel, float leftRPM,
-        long rightCount, float rightRevs, float rightDist, float rightVel, float rightRPM,
-        float battery
+        long leftCount, float leftRevs, float leftDist, float leftVel, float leftRPM, unsigned long leftIllegal,
+        long rightCount, float rightRevs, float rightDist, float rightVel, float rightRPM, unsigned long rightIllegal,
+        float battery, float batterySoc
     ) {
         JsonBuilder json(384);
         
@@ -244,6 +294,7 @@ public:
                 .addFloat("distance", leftDist, 2)
                 .addFloat("velocity", leftVel, 2)
                 .addFloat("rpm", leftRPM, 1)
+                .addLong("illegal", leftIllegal)
             .endObject()
             .startNestedObject("right")
                 .addLong("count", rightCount)
@@ -251,8 +302,10 @@ public:
                 .addFloat("distance", rightDist, 2)
                 .addFloat("velocity", rightVel, 2)
                 .addFloat("rpm", rightRPM, 1)
+                .addLong("illegal", rightIllegal)
             .endObject()
             .addFloat("battery", battery, 2)
+            .addFloat("batterySoc", batterySoc, 0)
         .endObject();
         
         return json.toString();
@@ -285,6 +338,46 @@ public:
     }
 };
 
+/**
+ * Helper class for building online motor identification status JSON
+ */
+class MotorModelJsonBuilder {
+public:
+    // One entry per MotorMapping, keyed by its name
+    static String buildOnlineIdStatus(bool enabled, const MotorModelEstimator* const* models) {
+        JsonBuilder json(1024);
+        json.startObject()
+            .addString("type", "onlineId")
+            .addBool("enabled", enabled);
+        for (int i = 0; i < MOTOR_MAPPING_COUNT; i++) {
+            const MotorModelEstimator& model = *models[i];
+            addMapping(json, motorMappingName(model.getMapping()), model.isConfident(), model.getSampleCount(),
+                       model.getResidualRMS(), model.getCovarianceTrace(), model.getPolynomial());
+        }
+        json.endObject();
+        return json.toString();
+    }
+
+private:
+    static void addMapping(JsonBuilder& json, const char* key, bool confident, unsigned long samples,
+                           float rms, float trace, const Polynomial& poly) {
+        String coeffs = "[";
+        for (int i = 0; i <= poly.getDegree(); i++) {
+            if (i > 0) coeffs += ",";
+            coeffs += String(poly.getCoefficient(i), 8);
+        }
+        coeffs += "]";
+        
+        json.startNestedObject(key)
+            .addBool("confident", confident)
+            .addLong("samples", samples)
+            .addFloat("residualRMS", rms, 2)
+            .addFloat("covarianceTrace", trace, 3)
+            .addRaw("pwm2vel", coeffs)
+        .endObject();
+    }
+};
+
 /**
  * Helper class for building WebSocket control messages
  */
@@ -308,6 +401,17 @@ public:
         return json.toString();
     }
     
+    static String buildBatteryStatus(bool low, float voltage, float soc) {
+        JsonBuilder json(96);
+        json.startObject()
+            .addString("type", "battery")
+            .addBool("low", low)
+            .addFloat("voltage", voltage, 2)
+            .addFloat("soc", soc, 0)
+        .endObject();
+        return json.toString();
+    }
+    
     static String buildLogMessage(const String& message) {
         JsonBuilder json(256);
         String escaped = message;
@@ -320,6 +424,23 @@ public:
         return json.toString();
     }
     
+    static String buildControlLoopStats(uint32_t rateHz, uint32_t ticks, uint32_t overruns,
+                                        uint32_t lastExecUs, uint32_t maxExecUs,
+                                        float avgJitterUs, uint32_t maxJitterUs) {
+        JsonBuilder json(192);
+        json.startObject()
+            .addString("type", "controlLoop")
+            .addLong("rateHz", rateHz)
+            .addLong("ticks", ticks)
+            .addLong("overruns", overruns)
+            .addLong("execUs", lastExecUs)
+            .addLong("maxExecUs", maxExecUs)
+            .addFloat("avgJitterUs", avgJitterUs, 1)
+            .addLong("maxJitterUs", maxJitterUs)
+        .endObject();
+        return json.toString();
+    }
+    
     static String buildVelocityError(float leftError, float rightError, bool pidEnabled) {
         String msg = "VEL_ERROR:";
         msg += String(leftError, 2);
@@ -330,13 +451,43 @@ public:
         return msg;
     }
     
-    static String buildCalibrationPoint(int pwm, float leftVel, float rightVel) {
+    static String buildCalibrationPoint(int pwm, float leftVel, float rightVel, float leftVariance, float rightVariance) {
         String msg = "CALIBRATION_POINT:";
         msg += String(pwm);
         msg += ",";
         msg += String(leftVel, 2);
         msg += ",";
         msg += String(rightVel, 2);
+        msg += ",";
+        msg += String(leftVariance, 3);
+        msg += ",";
+        msg += String(rightVariance, 3);
+        return msg;
+    }
+    
+    static String buildCalibrationFit(const char* kind, const char* mapping, const PolynomialFit::Result& fit) {
+        String msg = "CALIBRATION_FIT:";
+        msg += kind;
+        msg += ",";
+        msg += mapping;
+        if (!fit.ok) {
+            msg += ",failed";
+            return msg;
+        }
+        msg += ",";
+        msg += String(fit.degree);
+        msg += ",";
+        msg += String(fit.points);
+        msg += ",";
+        msg += String(fit.rmsResidual, 3);
+        msg += ",";
+        msg += String(fit.maxResidual, 3);
+        msg += ",";
+        msg += String(fit.rSquared, 5);
+        for (int i = 0; i <= fit.degree; i++) {
+            msg += ",";
+            msg += String(fit.coefficients[i], 9);
+        }
         return msg;
     }
     
@@ -352,6 +503,54 @@ public:
         return msg;
     }
     
+    static String buildAutoTuneProgress(const char* wheel, int cycles, int targetCycles) {
+        String msg = "AUTOTUNE_PROGRESS:";
+        msg += wheel;
+        msg += ",";
+        msg += String(cycles);
+        msg += ",";
+        msg += String(targetCycles);
+        return msg;
+    }
+    
+    static String buildAutoTuneResult(const char* wheel, const RelayAutoTuner::Result& result, float kp, float ki, float kd) {
+        String msg = "AUTOTUNE_RESULT:";
+        msg += wheel;
+        msg += result.ok ? ",ok," : ",failed,";
+        msg += String(result.ultimateGain, 3);
+        msg += ",";
+        msg += String(result.ultimatePeriod, 4);
+        msg += ",";
+        msg += String(result.oscillationAmplitude, 2);
+        msg += ",";
+        msg += String(kp, 3);
+        msg += ",";
+        msg += String(ki, 3);
+        msg += ",";
+        msg += String(kd, 4);
+        return msg;
+    }
+    
+    static String buildSystemIdFit(const char* wheel, const FopdtFit::Result& result) {
+        String msg = "SYSID_FIT:";
+        msg += wheel;
+        if (!result.ok) {
+            msg += ",failed";
+            return msg;
+        }
+        msg += ",ok,";
+        msg += String(result.gain, 4);
+        msg += ",";
+        msg += String(result.timeConstant, 4);
+        msg += ",";
+        msg += String(result.deadTime, 4);
+        msg += ",";
+        msg += String(result.offset, 2);
+        msg += ",";
+        msg += String(result.fitPercent, 1);
+        return msg;
+    }
+    
     static String buildCommandAck(const char* command, const String& value) {
         String msg = "COMMAND_ACK:";
         msg += command;
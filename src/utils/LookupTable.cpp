@@ -0,0 +1,40 @@
+#include "LookupTable.h"
+
+LookupTable::LookupTable()
+    : xMin(0), xMax(1), step(1.0f / (SIZE - 1)), invStep(SIZE - 1), monotonicFixes(0), built(false) {
+    for (int i = 0; i < SIZE; i++) {
+        values[i] = 0;
+    }
+}
+
+float LookupTable::evaluate(float x) const {
+    float t = (x - xMin) * invStep;
+    if (t <= 0) return values[0];
+    if (t >= SIZE - 1) return values[SIZE - 1];
+
+    int i = (int)t;
+    float frac = t - i;
+    return values[i] + frac * (values[i + 1] - values[i]);
+}
+
+float LookupTable::inverse(float y) const {
+    if (y <= values[0]) return xMin;
+    if (y >= values[SIZE - 1]) return xMax;
+
+    // First sample strictly above y; values[lo - 1] <= y < values[lo]
+    int lo = 1;
+    int hi = SIZE - 1;
+    while (lo < hi) {
+        int mid = (lo + hi) / 2;
+        if (values[mid] > y) {
+            hi = mid;
+        } else {
+            lo = mid + 1;
+        }
+    }
+
+    float y0 = values[lo - 1];
+    float y1 = values[lo];
+    float frac = (y - y0) / (y1 - y0);
+    return xMin + (lo - 1 + frac) * step;
+}
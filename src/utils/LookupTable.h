@@ -0,0 +1,66 @@
+#ifndef LOOKUPTABLE_H
+#define LOOKUPTABLE_H
+
+/**
+ * Dense, monotonic (non-decreasing) table of y = f(x) on evenly spaced x, with linear interpolation
+ * evaluate() is O(1); inverse() binary-searches the same samples, so forward and inverse agree exactly
+ */
+class LookupTable {
+public:
+    static constexpr int SIZE = 256;
+
+    LookupTable();
+
+    // Samples fn over [xMin, xMax], forcing the samples non-decreasing
+    // Returns the largest interpolation error against fn, checked at every segment midpoint
+    template<typename Fn>
+    float build(Fn fn, float xMin, float xMax);
+
+    float evaluate(float x) const;
+    float inverse(float y) const;
+
+    bool isBuilt() const { return built; }
+    float getXMin() const { return xMin; }
+    float getXMax() const { return xMax; }
+    // Samples raised to keep the table monotonic on the last build
+    int getMonotonicFixes() const { return monotonicFixes; }
+
+private:
+    float values[SIZE];
+    float xMin;
+    float xMax;
+    float step;
+    float invStep;
+    int monotonicFixes;
+    bool built;
+};
+
+template<typename Fn>
+float LookupTable::build(Fn fn, float xMin, float xMax) {
+    this->xMin = xMin;
+    this->xMax = xMax;
+    step = (xMax - xMin) / (SIZE - 1);
+    invStep = 1.0f / step;
+    monotonicFixes = 0;
+
+    for (int i = 0; i < SIZE; i++) {
+        float y = fn(xMin + i * step);
+        if (i > 0 && y < values[i - 1]) {
+            y = values[i - 1];
+            monotonicFixes++;
+        }
+        values[i] = y;
+    }
+    built = true;
+
+    float maxError = 0;
+    for (int i = 0; i < SIZE - 1; i++) {
+        float x = xMin + (i + 0.5f) * step;
+        float error = evaluate(x) - fn(x);
+        if (error < 0) error = -error;
+        if (error > maxError) maxError = error;
+    }
+    return maxError;
+}
+
+#endif
@@ -0,0 +1,87 @@
+#include "MahonyFilter.h"
+#include <math.h>
+
+MahonyFilter::MahonyFilter(const Config& config)
+    : config(config), q0(1), q1(0), q2(0), q3(0), integral{0, 0, 0} {}
+
+void MahonyFilter::reset(float ax, float ay, float az) {
+    float roll = atan2f(ay, az);
+    float pitch = atan2f(-ax, sqrtf(ay * ay + az * az));
+
+    float cr = cosf(0.5f * roll);
+    float sr = sinf(0.5f * roll);
+    float cp = cosf(0.5f * pitch);
+    float sp = sinf(0.5f * pitch);
+    q0 = cr * cp;
+    q1 = sr * cp;
+    q2 = cr * sp;
+    q3 = -sr * sp;
+
+    integral[0] = integral[1] = integral[2] = 0;
+}
+
+void MahonyFilter::update(float gx, float gy, float gz, float ax, float ay, float az, float dt) {
+    float norm2 = ax * ax + ay * ay + az * az;
+    float low = 1.0f - config.accelTolerance;
+    float high = 1.0f + config.accelTolerance;
+
+    if (norm2 >= low * low && norm2 <= high * high) {
+        float inv = 1.0f / sqrtf(norm2);
+        ax *= inv;
+        ay *= inv;
+        az *= inv;
+
+        // Gravity direction predicted by the current attitude, in the body frame
+        float vx = 2.0f * (q1 * q3 - q0 * q2);
+        float vy = 2.0f * (q0 * q1 + q2 * q3);
+        float vz = q0 * q0 - q1 * q1 - q2 * q2 + q3 * q3;
+
+        float ex = ay * vz - az * vy;
+        float ey = az * vx - ax * vz;
+        float ez = ax * vy - ay * vx;
+
+        if (config.ki > 0) {
+            float limit = config.integralLimit;
+            integral[0] = fminf(fmaxf(integral[0] + config.ki * ex * dt, -limit), limit);
+            integral[1] = fminf(fmaxf(integral[1] + config.ki * ey * dt, -limit), limit);
+            integral[2] = fminf(fmaxf(integral[2] + config.ki * ez * dt, -limit), limit);
+        }
+
+        gx += config.kp * ex;
+        gy += config.kp * ey;
+        gz += config.kp * ez;
+    }
+
+    gx += integral[0];
+    gy += integral[1];
+    gz += integral[2];
+
+    // q += 0.5 * q * (0, g) * dt
+    float h = 0.5f * dt;
+    float a = q0;
+    float b = q1;
+    float c = q2;
+    q0 += (-b * gx - c * gy - q3 * gz) * h;
+    q1 += (a * gx + c * gz - q3 * gy) * h;
+    q2 += (a * gy - b * gz + q3 * gx) * h;
+    q3 += (a * gz + b * gy - c * gx) * h;
+
+    float inv = 1.0f / sqrtf(q0 * q0 + q1 * q1 + q2 * q2 + q3 * q3);
+    q0 *= inv;
+    q1 *= inv;
+    q2 *= inv;
+    q3 *= inv;
+}
+
+float MahonyFilter::getRoll() const {
+    return atan2f(2.0f * (q0 * q1 + q2 * q3), 1.0f - 2.0f * (q1 * q1 + q2 * q2));
+}
+
+float MahonyFilter::getPitch() const {
+    float s = 2.0f * (q0 * q2 - q3 * q1);
+    return asinf(fminf(fmaxf(s, -1.0f), 1.0f));
+}
+
+float MahonyFilter::getYaw() const {
+    return atan2f(2.0f * (q0 * q3 + q1 * q2), 1.0f - 2.0f * (q2 * q2 + q3 * q3));
+}
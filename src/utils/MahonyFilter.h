@@ -0,0 +1,38 @@
+#ifndef MAHONYFILTER_H
+#define MAHONYFILTER_H
+
+/**
+ * Mahony complementary attitude filter on a unit quaternion (body to world, z up)
+ * The accelerometer pulls roll and pitch towards gravity through a PI correction of the gyro rates;
+ * yaw is the integrated gyro. Samples whose acceleration magnitude is far from 1 g skip the correction.
+ */
+class MahonyFilter {
+public:
+    struct Config {
+        float kp;              // rad/s per unit of gravity direction error
+        float ki;              // rad/s^2 per unit error; learns the residual roll/pitch gyro bias
+        float integralLimit;   // rad/s
+        float accelTolerance;  // g; accelerometer ignored outside 1 +/- this
+    };
+
+    explicit MahonyFilter(const Config& config);
+
+    // Roll and pitch from the accelerometer (any units), yaw zero
+    void reset(float ax, float ay, float az);
+    // Gyro in rad/s, accelerometer in g
+    void update(float gx, float gy, float gz, float ax, float ay, float az, float dt);
+
+    float getRoll() const;
+    float getPitch() const;
+    float getYaw() const;
+    // Cosine of the angle between the body z axis and vertical
+    float getUpright() const { return q0 * q0 - q1 * q1 - q2 * q2 + q3 * q3; }
+    const float* getIntegral() const { return integral; }
+
+private:
+    Config config;
+    float q0, q1, q2, q3;
+    float integral[3];
+};
+
+#endif
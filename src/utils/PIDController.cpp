@@ -1,13 +1,21 @@
 #include "PIDController.h"
 
 PIDController::PIDController(float kp, float ki, float kd)
-    : kp(kp), ki(ki), kd(kd), integral(0), previousError(0), lastTime(0),
+    : kp(kp), ki(ki), kd(kd), integral(0), previousMeasurement(0), previousError(0),
+      filteredDerivative(0), derivativeFilterTau(0.01f), initialized(false), lastTimeUs(0),
       outputMin(-255), outputMax(255), integralMin(-100), integralMax(100) {}
 
 void PIDController::setGains(float kp, float ki, float kd) {
+    // Shift the old P and D contribution into the integral so the output does not step
+    float shift = (this->kp - kp) * previousError + (this->kd - kd) * filteredDerivative;
+    
     this->kp = kp;
     this->ki = ki;
     this->kd = kd;
+    
+    if (initialized) {
+        integral = clampIntegral(integral + shift);
+    }
 }
 
 void PIDController::setOutputLimits(float min, float max) {
@@ -20,14 +28,24 @@ void PIDController::setIntegralLimits(float min, float max) {
     integralMax = max;
 }
 
+void PIDController::setDerivativeFilter(float tauSeconds) {
+    derivativeFilterTau = max(tauSeconds, 0.0f);
+}
+
 float PIDController::compute(float setpoint, float measurement) {
-    unsigned long now = millis();
-    float dt = (now - lastTime) / 1000.0;
-    
-    if (lastTime == 0 || dt <= 0 || dt > 1.0) {
-        lastTime = now;
-        previousError = setpoint - measurement;
-        return 0;
+    uint32_t now = micros();
+    float dt = initialized ? (now - lastTimeUs) * 1e-6f : 0.0f;
+    lastTimeUs = now;
+    return compute(setpoint, measurement, dt);
+}
+
+float PIDController::compute(float setpoint, float measurement, float dt) {
+    if (dt > MAX_DT) {
+        initialized = false;
+    }
+    if (!initialized) {
+        dt = 0;
+        filteredDerivative = 0;
     }
     
     // Calculate error
@@ -36,28 +54,47 @@ float PIDController::compute(float setpoint, float measurement) {
     // Proportional term
     float pTerm = kp * error;
     
-    // Integral term
-    integral += error * dt;
-    integral = constrain(integral, integralMin, integralMax);  // Anti-windup
-    float iTerm = ki * integral;
+    // Derivative term on measurement, so setpoint steps do not kick
+    if (dt > 0) {
+        float rawDerivative = -(measurement - previousMeasurement) / dt;
+        float alpha = dt / (derivativeFilterTau + dt);
+        filteredDerivative += alpha * (rawDerivative - filteredDerivative);
+    }
+    float dTerm = kd * filteredDerivative;
     
-    // Derivative term
-    float derivative = (error - previousError) / dt;
-    float dTerm = kd * derivative;
+    // Integral term; skipped while the output is saturated and the error would push it further
+    if (dt > 0) {
+        float candidate = clampIntegral(integral + ki * error * dt);
+        float unclamped = pTerm + candidate + dTerm;
+        bool windingUp = (unclamped > outputMax && error > 0) || (unclamped < outputMin && error < 0);
+        if (!windingUp) {
+            integral = candidate;
+        }
+    }
     
     // Calculate total output
-    float output = pTerm + iTerm + dTerm;
+    float output = pTerm + integral + dTerm;
     output = constrain(output, outputMin, outputMax);
     
     // Save state
+    previousMeasurement = measurement;
     previousError = error;
-    lastTime = now;
+    initialized = true;
     
     return output;
 }
 
+float PIDController::clampIntegral(float value) const {
+    float low = ki * integralMin;
+    float high = ki * integralMax;
+    return constrain(value, fminf(low, high), fmaxf(low, high));
+}
+
 void PIDController::reset() {
     integral = 0;
+    previousMeasurement = 0;
     previousError = 0;
-    lastTime = 0;
+    filteredDerivative = 0;
+    initialized = false;
+    lastTimeUs = 0;
 }
@@ -3,20 +3,33 @@
 
 #include <Arduino.h>
 
+/**
+ * PID with derivative on measurement (first-order filtered), conditional integration
+ * against the output limits, and bumpless gain changes.
+ * The integral is stored already scaled by ki; its limits stay in error x seconds and are scaled by ki when applied.
+ */
 class PIDController {
 private:
+    static constexpr float MAX_DT = 1.0f;  // seconds; longer gaps restart the controller
+    
     float kp;
     float ki;
     float kd;
     
     float integral;
+    float previousMeasurement;
     float previousError;
-    unsigned long lastTime;
+    float filteredDerivative;
+    float derivativeFilterTau;
+    bool initialized;
+    uint32_t lastTimeUs;
     
     float outputMin;
     float outputMax;
-    float integralMin;
+    float integralMin;  // error x seconds
     float integralMax;
+    
+    float clampIntegral(float value) const;
 
 public:
     PIDController(float kp = 0.0, float ki = 0.0, float kd = 0.0);
@@ -24,8 +37,12 @@ public:
     void setGains(float kp, float ki, float kd);
     void setOutputLimits(float min, float max);
     void setIntegralLimits(float min, float max);
+    void setDerivativeFilter(float tauSeconds);
     
+    // dt measured with micros() between calls
     float compute(float setpoint, float measurement);
+    // dt supplied by the caller, in seconds
+    float compute(float setpoint, float measurement, float dt);
     void reset();
     
     float getKp() const { return kp; }
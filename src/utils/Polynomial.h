@@ -3,6 +3,8 @@
 
 class Polynomial {
 public:
+    static constexpr int MAX_DEGREE = 5;
+    
     Polynomial(const float* coeffs, int degree);
     Polynomial();
     
@@ -15,7 +17,6 @@ public:
     float getCoefficient(int i) const;
 
 private:
-    static constexpr int MAX_DEGREE = 5;
     float coefficients_[MAX_DEGREE + 1];
     int degree_;
 };
@@ -0,0 +1,157 @@
+#include "PolynomialFit.h"
+#include <math.h>
+
+namespace {
+constexpr int MAX_TERMS = Polynomial::MAX_DEGREE + 1;
+
+// Solves A c = b in place for symmetric positive definite A; false if A is singular
+bool solveCholesky(double A[MAX_TERMS][MAX_TERMS], double* b, int size) {
+    for (int j = 0; j < size; j++) {
+        double diagonal = A[j][j];
+        for (int k = 0; k < j; k++) {
+            diagonal -= A[j][k] * A[j][k];
+        }
+        if (diagonal <= 1e-12 * A[0][0]) {
+            return false;
+        }
+        A[j][j] = sqrt(diagonal);
+
+        for (int i = j + 1; i < size; i++) {
+            double value = A[i][j];
+            for (int k = 0; k < j; k++) {
+                value -= A[i][k] * A[j][k];
+            }
+            A[i][j] = value / A[j][j];
+        }
+    }
+
+    // L z = b, then L^T c = z
+    for (int i = 0; i < size; i++) {
+        for (int k = 0; k < i; k++) {
+            b[i] -= A[i][k] * b[k];
+        }
+        b[i] /= A[i][i];
+    }
+    for (int i = size - 1; i >= 0; i--) {
+        for (int k = i + 1; k < size; k++) {
+            b[i] -= A[k][i] * b[k];
+        }
+        b[i] /= A[i][i];
+    }
+    return true;
+}
+}
+
+PolynomialFit::Result PolynomialFit::fit(const float* x, const float* y, int n, int degree, int maxDegree) {
+    if (maxDegree > Polynomial::MAX_DEGREE) maxDegree = Polynomial::MAX_DEGREE;
+
+    if (degree > 0) {
+        return fitDegree(x, y, n, degree < maxDegree ? degree : maxDegree);
+    }
+
+    Result best = {};
+    double bestScore = 0;
+    for (int d = 1; d <= maxDegree; d++) {
+        int k = d + 1;
+        if (n - k - 1 <= 0) break;
+
+        Result candidate = fitDegree(x, y, n, d);
+        if (!candidate.ok) break;
+
+        double rss = (double)candidate.rmsResidual * candidate.rmsResidual * n;
+        double score = n * log(rss / n + 1e-12) + 2.0 * k + 2.0 * k * (k + 1) / (n - k - 1);
+        // A higher degree has to earn its extra term by a clear margin
+        if (!best.ok || score < bestScore - 2.0) {
+            best = candidate;
+            bestScore = score;
+        }
+    }
+    return best;
+}
+
+PolynomialFit::Result PolynomialFit::fitDegree(const float* x, const float* y, int n, int degree) {
+    Result result = {};
+    result.degree = degree;
+    result.points = n;
+
+    int terms = degree + 1;
+    if (degree < 1 || n < terms) {
+        return result;
+    }
+
+    double xMin = x[0];
+    double xMax = x[0];
+    for (int i = 1; i < n; i++) {
+        if (x[i] < xMin) xMin = x[i];
+        if (x[i] > xMax) xMax = x[i];
+    }
+    double center = (xMax + xMin) / 2.0;
+    double halfRange = (xMax - xMin) / 2.0;
+    if (halfRange <= 0) {
+        return result;
+    }
+
+    // Normal equations in s = (x - center) / halfRange
+    double A[MAX_TERMS][MAX_TERMS] = {};
+    double b[MAX_TERMS] = {};
+    for (int p = 0; p < n; p++) {
+        double s = (x[p] - center) / halfRange;
+        double powers[2 * MAX_TERMS - 1];
+        powers[0] = 1.0;
+        for (int k = 1; k < 2 * terms - 1; k++) {
+            powers[k] = powers[k - 1] * s;
+        }
+        for (int i = 0; i < terms; i++) {
+            b[i] += powers[i] * y[p];
+            for (int j = 0; j <= i; j++) {
+                A[i][j] += powers[i + j];
+            }
+        }
+    }
+
+    if (!solveCholesky(A, b, terms)) {
+        return result;
+    }
+
+    // Expand sum b_k s^k with s = a x + c0 into coefficients of x (Horner on polynomials)
+    double a = 1.0 / halfRange;
+    double c0 = -center / halfRange;
+    double coeffs[MAX_TERMS] = {b[degree]};
+    for (int k = degree - 1, current = 0; k >= 0; k--, current++) {
+        coeffs[current + 1] = 0;
+        for (int i = current + 1; i > 0; i--) {
+            coeffs[i] = c0 * coeffs[i] + a * coeffs[i - 1];
+        }
+        coeffs[0] = c0 * coeffs[0] + b[k];
+    }
+
+    for (int i = 0; i < MAX_TERMS; i++) {
+        result.coefficients[i] = (i <= degree) ? (float)coeffs[i] : 0.0f;
+    }
+
+    double sumSquares = 0;
+    double maxResidual = 0;
+    double mean = 0;
+    for (int p = 0; p < n; p++) {
+        mean += y[p];
+    }
+    mean /= n;
+
+    double totalSquares = 0;
+    for (int p = 0; p < n; p++) {
+        double predicted = coeffs[degree];
+        for (int k = degree - 1; k >= 0; k--) {
+            predicted = predicted * x[p] + coeffs[k];
+        }
+        double residual = y[p] - predicted;
+        sumSquares += residual * residual;
+        if (fabs(residual) > maxResidual) maxResidual = fabs(residual);
+        totalSquares += (y[p] - mean) * (y[p] - mean);
+    }
+
+    result.rmsResidual = (float)sqrt(sumSquares / n);
+    result.maxResidual = (float)maxResidual;
+    result.rSquared = totalSquares > 0 ? (float)(1.0 - sumSquares / totalSquares) : 1.0f;
+    result.ok = true;
+    return result;
+}
@@ -0,0 +1,30 @@
+#ifndef POLYNOMIALFIT_H
+#define POLYNOMIALFIT_H
+
+#include "Polynomial.h"
+
+/**
+ * Least-squares polynomial fitting
+ * x is scaled to [-1, 1] before forming the normal equations, which are solved by Cholesky in double precision;
+ * the result is expanded back to coefficients of the raw x
+ */
+class PolynomialFit {
+public:
+    struct Result {
+        bool ok;
+        int degree;
+        int points;
+        float coefficients[Polynomial::MAX_DEGREE + 1];
+        float rmsResidual;
+        float maxResidual;
+        float rSquared;
+    };
+
+    // degree 0 picks the degree in 1..maxDegree by corrected AIC, preferring the lower degree unless it loses by more than 2
+    static Result fit(const float* x, const float* y, int n, int degree, int maxDegree = Polynomial::MAX_DEGREE);
+
+private:
+    static Result fitDegree(const float* x, const float* y, int n, int degree);
+};
+
+#endif
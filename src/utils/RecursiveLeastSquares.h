@@ -0,0 +1,92 @@
+#ifndef RECURSIVELEASTSQUARES_H
+#define RECURSIVELEASTSQUARES_H
+
+#include <stdint.h>
+
+/**
+ * Recursive least squares with exponential forgetting for y = phi . theta
+ * Covariance inflation from forgetting is paused while the trace is above its initial value,
+ * so poorly excited directions do not blow up while the input sits at one operating point
+ */
+template<int N>
+class RecursiveLeastSquares {
+public:
+    explicit RecursiveLeastSquares(float forgettingFactor = 0.998f, float initialCovariance = 1000.0f)
+        : lambda(forgettingFactor), initialCovariance(initialCovariance) {
+        reset();
+    }
+
+    void reset() {
+        for (int i = 0; i < N; i++) {
+            theta[i] = 0;
+            for (int j = 0; j < N; j++) {
+                P[i][j] = (i == j) ? initialCovariance : 0;
+            }
+        }
+        samples = 0;
+    }
+
+    void setForgettingFactor(float forgettingFactor) { lambda = forgettingFactor; }
+
+    float predict(const float (&phi)[N]) const {
+        float y = 0;
+        for (int i = 0; i < N; i++) {
+            y += phi[i] * theta[i];
+        }
+        return y;
+    }
+
+    // Returns the a-priori prediction error
+    float update(const float (&phi)[N], float y) {
+        float Pphi[N];
+        for (int i = 0; i < N; i++) {
+            Pphi[i] = 0;
+            for (int j = 0; j < N; j++) {
+                Pphi[i] += P[i][j] * phi[j];
+            }
+        }
+
+        float effectiveLambda = (getCovarianceTrace() < initialCovariance * N) ? lambda : 1.0f;
+        float denominator = effectiveLambda;
+        for (int i = 0; i < N; i++) {
+            denominator += phi[i] * Pphi[i];
+        }
+
+        float error = y - predict(phi);
+        for (int i = 0; i < N; i++) {
+            theta[i] += Pphi[i] / denominator * error;
+        }
+
+        // P = (P - Pphi Pphi^T / denominator) / lambda, kept symmetric
+        for (int i = 0; i < N; i++) {
+            for (int j = i; j < N; j++) {
+                float value = (P[i][j] - Pphi[i] * Pphi[j] / denominator) / effectiveLambda;
+                P[i][j] = value;
+                P[j][i] = value;
+            }
+        }
+
+        samples++;
+        return error;
+    }
+
+    const float* getParameters() const { return theta; }
+    uint32_t getSampleCount() const { return samples; }
+
+    float getCovarianceTrace() const {
+        float trace = 0;
+        for (int i = 0; i < N; i++) {
+            trace += P[i][i];
+        }
+        return trace;
+    }
+
+private:
+    float lambda;
+    float initialCovariance;
+    float theta[N];
+    float P[N][N];
+    uint32_t samples;
+};
+
+#endif
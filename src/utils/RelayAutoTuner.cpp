@@ -0,0 +1,129 @@
+#include "RelayAutoTuner.h"
+#include <math.h>
+#include <string.h>
+
+RelayAutoTuner::RelayAutoTuner()
+    : config{0, 0, 0, 0, 0}, outputHigh(true), finished(false), elapsed(0), lastRiseTime(0), haveRise(false),
+      cycleMax(0), cycleMin(0), completedCycles(0), periods(), amplitudes() {}
+
+void RelayAutoTuner::begin(const Config& cfg) {
+    config = cfg;
+    if (config.settleCycles < 0) config.settleCycles = 0;
+    if (config.cycles < 1) config.cycles = 1;
+    if (config.settleCycles + config.cycles > MAX_CYCLES) {
+        config.cycles = MAX_CYCLES - config.settleCycles;
+    }
+    
+    outputHigh = true;
+    finished = false;
+    elapsed = 0;
+    lastRiseTime = 0;
+    haveRise = false;
+    cycleMax = -INFINITY;
+    cycleMin = INFINITY;
+    completedCycles = 0;
+}
+
+float RelayAutoTuner::update(float measurement, float dt) {
+    if (finished) return 0;
+    
+    elapsed += dt;
+    if (measurement > cycleMax) cycleMax = measurement;
+    if (measurement < cycleMin) cycleMin = measurement;
+    
+    float error = config.setpoint - measurement;
+    if (outputHigh && error < -config.hysteresis) {
+        outputHigh = false;
+    } else if (!outputHigh && error > config.hysteresis) {
+        outputHigh = true;
+        // One full period runs from rising switch to rising switch
+        if (haveRise) {
+            completeCycle();
+        }
+        haveRise = true;
+        lastRiseTime = elapsed;
+        cycleMax = measurement;
+        cycleMin = measurement;
+    }
+    
+    return outputHigh ? config.amplitude : -config.amplitude;
+}
+
+void RelayAutoTuner::completeCycle() {
+    periods[completedCycles] = elapsed - lastRiseTime;
+    amplitudes[completedCycles] = (cycleMax - cycleMin) / 2.0f;
+    completedCycles++;
+    if (completedCycles >= getTargetCycles()) {
+        finished = true;
+    }
+}
+
+RelayAutoTuner::Result RelayAutoTuner::getResult() const {
+    Result result = {false, 0, 0, 0, 0};
+    int first = config.settleCycles;
+    int count = completedCycles - first;
+    if (count <= 0) return result;
+    
+    float periodSum = 0;
+    float amplitudeSum = 0;
+    float periodMin = periods[first];
+    float periodMax = periods[first];
+    for (int i = first; i < completedCycles; i++) {
+        periodSum += periods[i];
+        amplitudeSum += amplitudes[i];
+        if (periods[i] < periodMin) periodMin = periods[i];
+        if (periods[i] > periodMax) periodMax = periods[i];
+    }
+    
+    result.ultimatePeriod = periodSum / count;
+    result.oscillationAmplitude = amplitudeSum / count;
+    result.periodSpread = (periodMax - periodMin) / result.ultimatePeriod;
+    
+    float a = result.oscillationAmplitude;
+    float eps = config.hysteresis;
+    if (a <= eps || result.ultimatePeriod <= 0) return result;
+    
+    result.ultimateGain = 4.0f * config.amplitude / ((float)M_PI * sqrtf(a * a - eps * eps));
+    result.ok = result.periodSpread <= MAX_PERIOD_SPREAD;
+    return result;
+}
+
+void RelayAutoTuner::computeGains(Rule rule, float ku, float tu, float& kp, float& ki, float& kd) {
+    // Kp as a fraction of Ku, Ti and Td as fractions of Tu
+    float kpRatio;
+    float tiRatio;
+    float tdRatio;
+    switch (rule) {
+        case Rule::ZieglerNicholsPI: kpRatio = 0.45f; tiRatio = 1.0f / 1.2f; tdRatio = 0; break;
+        case Rule::TyreusLuyben:     kpRatio = 0.45f; tiRatio = 2.2f; tdRatio = 1.0f / 6.3f; break;
+        case Rule::PessenIntegral:   kpRatio = 0.7f;  tiRatio = 0.4f; tdRatio = 0.15f; break;
+        case Rule::SomeOvershoot:    kpRatio = 0.33f; tiRatio = 0.5f; tdRatio = 0.33f; break;
+        case Rule::NoOvershoot:      kpRatio = 0.2f;  tiRatio = 0.5f; tdRatio = 0.33f; break;
+        case Rule::ZieglerNichols:
+        default:                     kpRatio = 0.6f;  tiRatio = 0.5f; tdRatio = 0.125f; break;
+    }
+    
+    kp = kpRatio * ku;
+    ki = kp / (tiRatio * tu);
+    kd = kp * tdRatio * tu;
+}
+
+namespace {
+const char* const RULE_NAMES[] = {"zn", "zn_pi", "tyreus_luyben", "pessen", "some_overshoot", "no_overshoot"};
+constexpr int RULE_COUNT = sizeof(RULE_NAMES) / sizeof(RULE_NAMES[0]);
+}
+
+bool RelayAutoTuner::parseRule(const char* name, Rule& rule) {
+    for (int i = 0; i < RULE_COUNT; i++) {
+        if (strcmp(name, RULE_NAMES[i]) == 0) {
+            rule = (Rule)i;
+            return true;
+        }
+    }
+    return false;
+}
+
+const char* RelayAutoTuner::ruleName(Rule rule) {
+    int index = (int)rule;
+    return (index >= 0 && index < RULE_COUNT) ? RULE_NAMES[index] : "";
+}
@@ -0,0 +1,72 @@
+#ifndef RELAYAUTOTUNER_H
+#define RELAYAUTOTUNER_H
+
+/**
+ * Relay feedback (Astrom-Hagglund) experiment for one loop
+ * The output switches between +amplitude and -amplitude around the caller's bias as the error changes sign,
+ * with hysteresis against measurement noise. The plant settles into a limit cycle at its ultimate period;
+ * the describing function gives the ultimate gain Ku = 4d / (pi * sqrt(a^2 - eps^2)).
+ */
+class RelayAutoTuner {
+public:
+    enum class Rule {
+        ZieglerNichols,
+        ZieglerNicholsPI,
+        TyreusLuyben,
+        PessenIntegral,
+        SomeOvershoot,
+        NoOvershoot
+    };
+    
+    struct Config {
+        float setpoint;
+        float amplitude;    // relay output step d
+        float hysteresis;   // error band eps, in measurement units
+        int cycles;         // limit cycles averaged once the transient is over
+        int settleCycles;   // cycles discarded first
+    };
+    
+    struct Result {
+        bool ok;
+        float ultimateGain;
+        float ultimatePeriod;   // seconds
+        float oscillationAmplitude;
+        float periodSpread;     // (max - min) / mean of the averaged periods
+    };
+    
+    static constexpr float MAX_PERIOD_SPREAD = 0.3f;  // wider than this and the cycle is not a clean limit cycle
+    
+    RelayAutoTuner();
+    
+    void begin(const Config& config);
+    // Returns the relay output (+/- amplitude) to add to the bias
+    float update(float measurement, float dt);
+    
+    bool isFinished() const { return finished; }
+    int getCompletedCycles() const { return completedCycles; }
+    int getTargetCycles() const { return config.settleCycles + config.cycles; }
+    Result getResult() const;
+    
+    static void computeGains(Rule rule, float ultimateGain, float ultimatePeriod, float& kp, float& ki, float& kd);
+    static bool parseRule(const char* name, Rule& rule);
+    static const char* ruleName(Rule rule);
+
+private:
+    static constexpr int MAX_CYCLES = 16;
+    
+    Config config;
+    bool outputHigh;
+    bool finished;
+    float elapsed;
+    float lastRiseTime;
+    bool haveRise;
+    float cycleMax;
+    float cycleMin;
+    int completedCycles;
+    float periods[MAX_CYCLES];
+    float amplitudes[MAX_CYCLES];
+    
+    void completeCycle();
+};
+
+#endif
@@ -0,0 +1,53 @@
+#ifndef ROLLINGSTATS_H
+#define ROLLINGSTATS_H
+
+/**
+ * Mean and variance over the last N samples
+ */
+template<int N>
+class RollingStats {
+public:
+    RollingStats() : next(0), size(0) {}
+
+    void add(float value) {
+        samples[next] = value;
+        next = (next + 1) % N;
+        if (size < N) size++;
+    }
+
+    void clear() {
+        next = 0;
+        size = 0;
+    }
+
+    int count() const { return size; }
+    bool isFull() const { return size == N; }
+
+    float mean() const {
+        if (size == 0) return 0;
+        float sum = 0;
+        for (int i = 0; i < size; i++) {
+            sum += samples[i];
+        }
+        return sum / size;
+    }
+
+    // Population variance of the window
+    float variance() const {
+        if (size < 2) return 0;
+        float m = mean();
+        float sum = 0;
+        for (int i = 0; i < size; i++) {
+            float d = samples[i] - m;
+            sum += d * d;
+        }
+        return sum / size;
+    }
+
+private:
+    float samples[N];
+    int next;
+    int size;
+};
+
+#endif
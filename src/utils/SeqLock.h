@@ -0,0 +1,47 @@
+#ifndef SEQLOCK_H
+#define SEQLOCK_H
+
+#include <stdint.h>
+#include <atomic>
+
+/**
+ * Single-writer sequence lock for publishing small structs across cores
+ * The writer never blocks; readers retry while a write is in progress (odd sequence)
+ * T must be trivially copyable
+ */
+template<typename T>
+class SeqLock {
+public:
+    SeqLock() : seq(0), value() {}
+
+    void write(const T& newValue) {
+        uint32_t s = seq.load(std::memory_order_relaxed);
+        seq.store(s + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        value = newValue;
+        std::atomic_thread_fence(std::memory_order_release);
+        seq.store(s + 2, std::memory_order_relaxed);
+    }
+
+    T read() const {
+        T copy;
+        uint32_t before;
+        uint32_t after;
+        do {
+            before = seq.load(std::memory_order_acquire);
+            copy = value;
+            std::atomic_thread_fence(std::memory_order_acquire);
+            after = seq.load(std::memory_order_relaxed);
+        } while ((before & 1) || before != after);
+        return copy;
+    }
+
+    // Number of completed writes
+    uint32_t version() const { return seq.load(std::memory_order_acquire) >> 1; }
+
+private:
+    std::atomic<uint32_t> seq;
+    T value;
+};
+
+#endif
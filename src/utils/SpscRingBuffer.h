@@ -0,0 +1,65 @@
+#ifndef SPSCRINGBUFFER_H
+#define SPSCRINGBUFFER_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <atomic>
+
+/**
+ * Lock-free single-producer/single-consumer ring buffer
+ * push() is safe to call from an ISR; pop()/drain() from one consumer task
+ * Capacity must be a power of two; indices run free so every slot is usable
+ */
+template<typename T, size_t Capacity>
+class SpscRingBuffer {
+    static_assert(Capacity > 0 && (Capacity & (Capacity - 1)) == 0, "Capacity must be a power of two");
+
+public:
+    SpscRingBuffer() : head(0), tail(0) {}
+
+    inline __attribute__((always_inline)) bool push(const T& item) {
+        uint32_t h = head.load(std::memory_order_relaxed);
+        if (h - tail.load(std::memory_order_acquire) >= Capacity) {
+            return false;
+        }
+        buffer[h & MASK] = item;
+        head.store(h + 1, std::memory_order_release);
+        return true;
+    }
+
+    bool pop(T& item) {
+        return drain(&item, 1) == 1;
+    }
+
+    size_t drain(T* out, size_t maxCount) {
+        uint32_t t = tail.load(std::memory_order_relaxed);
+        uint32_t available = head.load(std::memory_order_acquire) - t;
+        size_t n = available < maxCount ? available : maxCount;
+
+        for (size_t i = 0; i < n; i++) {
+            out[i] = buffer[(t + i) & MASK];
+        }
+        tail.store(t + n, std::memory_order_release);
+        return n;
+    }
+
+    // Consumer side only
+    void clear() {
+        tail.store(head.load(std::memory_order_acquire), std::memory_order_release);
+    }
+
+    size_t size() const {
+        return head.load(std::memory_order_acquire) - tail.load(std::memory_order_acquire);
+    }
+
+    static constexpr size_t capacity() { return Capacity; }
+
+private:
+    static constexpr uint32_t MASK = Capacity - 1;
+
+    T buffer[Capacity];
+    std::atomic<uint32_t> head;
+    std::atomic<uint32_t> tail;
+};
+
+#endif
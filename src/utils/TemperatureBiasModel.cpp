@@ -0,0 +1,41 @@
+#include "TemperatureBiasModel.h"
+#include <math.h>
+
+TemperatureBiasModel::TemperatureBiasModel(const Config& config)
+    : config(config), seedSlope(0), referenceTemperature(0),
+      weight(0), sumT(0), sumB(0), sumTT(0), sumTB(0),
+      meanTemperature(0), meanBias(0), slope(0) {}
+
+// The seed counts as one observation at its temperature
+void TemperatureBiasModel::reset(float bias, float temperature, float slope) {
+    seedSlope = fminf(fmaxf(slope, -config.slopeLimit), config.slopeLimit);
+    referenceTemperature = temperature;
+    weight = 1;
+    sumT = 0;
+    sumB = bias;
+    sumTT = 0;
+    sumTB = 0;
+    solve();
+}
+
+void TemperatureBiasModel::observe(float temperature, float bias) {
+    float t = temperature - referenceTemperature;
+    float lambda = config.forgetting;
+    weight = lambda * weight + 1;
+    sumT = lambda * sumT + t;
+    sumB = lambda * sumB + bias;
+    sumTT = lambda * sumTT + t * t;
+    sumTB = lambda * sumTB + t * bias;
+    solve();
+}
+
+void TemperatureBiasModel::solve() {
+    float meanT = sumT / weight;
+    meanBias = sumB / weight;
+    meanTemperature = referenceTemperature + meanT;
+
+    float sxx = fmaxf(sumTT - weight * meanT * meanT, 0.0f);
+    float sxy = sumTB - weight * meanT * meanBias;
+    slope = (sxy + config.slopePrior * seedSlope) / (sxx + config.slopePrior);
+    slope = fminf(fmaxf(slope, -config.slopeLimit), config.slopeLimit);
+}
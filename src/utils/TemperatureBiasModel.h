@@ -0,0 +1,44 @@
+#ifndef TEMPERATUREBIASMODEL_H
+#define TEMPERATUREBIASMODEL_H
+
+/**
+ * Sensor bias as a linear function of temperature, fitted from (temperature, bias) observations
+ * Exponentially weighted least squares; the slope is held near its seed until the observations
+ * spread over enough temperature to outweigh slopePrior, so a run at one temperature only moves the offset.
+ */
+class TemperatureBiasModel {
+public:
+    struct Config {
+        float forgetting;   // weight kept by the old observations per new one
+        float slopePrior;   // observations x °C^2 of spread the seeded slope is worth
+        float slopeLimit;   // |slope| clamp, bias units per °C
+    };
+
+    explicit TemperatureBiasModel(const Config& config);
+
+    void reset(float bias, float temperature, float slope = 0);
+    void observe(float temperature, float bias);
+    float predict(float temperature) const { return meanBias + slope * (temperature - meanTemperature); }
+
+    float getSlope() const { return slope; }
+    float getObservations() const { return weight; }
+
+private:
+    Config config;
+    float seedSlope;
+    float referenceTemperature;  // sums are kept relative to it
+
+    float weight;
+    float sumT;
+    float sumB;
+    float sumTT;
+    float sumTB;
+
+    float meanTemperature;
+    float meanBias;
+    float slope;
+
+    void solve();
+};
+
+#endif
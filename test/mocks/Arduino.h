@@ -0,0 +1,94 @@
+#ifndef ARDUINO_MOCK_H
+#define ARDUINO_MOCK_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include <algorithm>
+
+/**
+ * Host stand-in for the parts of the Arduino core used by the hardware-free sources
+ * Time only moves when a test advances it, so control code sees exactly the dt the test intends
+ */
+namespace mock {
+inline uint32_t& microsNow() {
+    static uint32_t now = 0;
+    return now;
+}
+inline void setMicros(uint32_t us) { microsNow() = us; }
+inline void advanceMicros(uint32_t us) { microsNow() += us; }
+
+// GPIO input banks 0 (pins 0-31) and 1 (32-63), as read through GPIO_IN_REG / GPIO_IN1_REG
+inline volatile uint32_t* gpioIn() {
+    static volatile uint32_t banks[2] = {0, 0};
+    return banks;
+}
+
+inline void (*&interruptHandler(int pin))() {
+    static void (*handlers[64])() = {};
+    return handlers[pin];
+}
+
+inline int readPin(int pin) { return (gpioIn()[pin / 32] >> (pin % 32)) & 1; }
+
+// Sets the input level without any interrupt, as if both pins of a pair changed before the ISR ran
+inline void writePin(int pin, int level) {
+    uint32_t bit = 1u << (pin % 32);
+    gpioIn()[pin / 32] = level ? (gpioIn()[pin / 32] | bit) : (gpioIn()[pin / 32] & ~bit);
+}
+
+inline void fireInterrupt(int pin) {
+    if (interruptHandler(pin)) interruptHandler(pin)();
+}
+
+// A CHANGE interrupt fires if the level actually changes
+inline void setPin(int pin, int level) {
+    if (readPin(pin) == level) return;
+    writePin(pin, level);
+    fireInterrupt(pin);
+}
+}
+
+#define IRAM_ATTR
+#define DRAM_ATTR
+
+#define PI 3.1415926535897932384626433832795
+#define DEG_TO_RAD 0.017453292519943295769236907684886
+#define RAD_TO_DEG 57.295779513082320876798154814105
+
+#define HIGH 1
+#define LOW 0
+#define INPUT 0x01
+#define INPUT_PULLUP 0x05
+#define OUTPUT 0x03
+#define CHANGE 0x03
+
+#define constrain(amt, low, high) ((amt) < (low) ? (low) : ((amt) > (high) ? (high) : (amt)))
+using std::abs;
+using std::max;
+using std::min;
+
+inline unsigned long micros() { return mock::microsNow(); }
+inline unsigned long millis() { return mock::microsNow() / 1000; }
+inline void delay(unsigned long ms) { mock::advanceMicros(ms * 1000); }
+inline void yield() {}
+
+inline void pinMode(int, int) {}
+// Out of line like the core's, which goes through the GPIO driver
+__attribute__((noinline)) inline int digitalRead(int pin) { return mock::readPin(pin); }
+inline int digitalPinToInterrupt(int pin) { return pin; }
+inline void attachInterrupt(int pin, void (*handler)(), int) { mock::interruptHandler(pin) = handler; }
+inline void detachInterrupt(int pin) { mock::interruptHandler(pin) = nullptr; }
+
+struct MockSerial {
+    void begin(unsigned long) {}
+    void print(const char*) {}
+    void println(const char* = "") {}
+    void println(unsigned long) {}
+    void printf(const char*, ...) {}
+};
+static MockSerial Serial __attribute__((unused));
+
+#endif
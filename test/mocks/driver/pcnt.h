@@ -0,0 +1,47 @@
+#ifndef PCNT_MOCK_H
+#define PCNT_MOCK_H
+
+#include <stdint.h>
+
+// Pulse counter API as declared by ESP-IDF 4.4; the unit reports whatever count the test sets
+typedef int esp_err_t;
+
+typedef enum { PCNT_UNIT_0, PCNT_UNIT_1, PCNT_UNIT_2, PCNT_UNIT_3, PCNT_UNIT_MAX } pcnt_unit_t;
+typedef enum { PCNT_CHANNEL_0, PCNT_CHANNEL_1 } pcnt_channel_t;
+typedef enum { PCNT_COUNT_DIS, PCNT_COUNT_INC, PCNT_COUNT_DEC } pcnt_count_mode_t;
+typedef enum { PCNT_MODE_KEEP, PCNT_MODE_REVERSE, PCNT_MODE_DISABLE } pcnt_ctrl_mode_t;
+typedef enum { PCNT_EVT_L_LIM = 0x10, PCNT_EVT_H_LIM = 0x20 } pcnt_evt_type_t;
+
+typedef struct {
+    int pulse_gpio_num;
+    int ctrl_gpio_num;
+    pcnt_ctrl_mode_t lctrl_mode;
+    pcnt_ctrl_mode_t hctrl_mode;
+    pcnt_count_mode_t pos_mode;
+    pcnt_count_mode_t neg_mode;
+    int16_t counter_h_lim;
+    int16_t counter_l_lim;
+    pcnt_unit_t unit;
+    pcnt_channel_t channel;
+} pcnt_config_t;
+
+namespace mock {
+inline int16_t& pcntCount() {
+    static int16_t count = 0;
+    return count;
+}
+}
+
+inline esp_err_t pcnt_unit_config(const pcnt_config_t*) { return 0; }
+inline esp_err_t pcnt_set_filter_value(pcnt_unit_t, uint16_t) { return 0; }
+inline esp_err_t pcnt_filter_enable(pcnt_unit_t) { return 0; }
+inline esp_err_t pcnt_event_enable(pcnt_unit_t, pcnt_evt_type_t) { return 0; }
+inline esp_err_t pcnt_counter_pause(pcnt_unit_t) { return 0; }
+inline esp_err_t pcnt_counter_clear(pcnt_unit_t) { mock::pcntCount() = 0; return 0; }
+inline esp_err_t pcnt_counter_resume(pcnt_unit_t) { return 0; }
+inline esp_err_t pcnt_isr_service_install(int) { return 0; }
+inline esp_err_t pcnt_isr_handler_add(pcnt_unit_t, void (*)(void*), void*) { return 0; }
+inline esp_err_t pcnt_get_counter_value(pcnt_unit_t, int16_t* count) { *count = mock::pcntCount(); return 0; }
+inline esp_err_t pcnt_get_event_status(pcnt_unit_t, uint32_t* status) { *status = 0; return 0; }
+
+#endif
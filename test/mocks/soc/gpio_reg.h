@@ -0,0 +1,9 @@
+#ifndef GPIO_REG_MOCK_H
+#define GPIO_REG_MOCK_H
+
+#include <Arduino.h>
+
+#define GPIO_IN_REG (mock::gpioIn())
+#define GPIO_IN1_REG (mock::gpioIn() + 1)
+
+#endif
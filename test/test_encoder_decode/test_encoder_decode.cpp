@@ -0,0 +1,202 @@
+#include <unity.h>
+#include "hardware/Encoder.h"
+#include "hardware/PulseCounterAccumulator.h"
+#include "hardware/EdgeCaptureStats.h"
+
+// One encoder per GPIO input bank; the right one is wired reversed like on the car
+static constexpr int LEFT_A = 43;
+static constexpr int LEFT_B = 44;
+static constexpr int RIGHT_A = 4;
+static constexpr int RIGHT_B = 5;
+
+static Encoder left(LEFT_A, LEFT_B, 960, 5.0f);
+static Encoder right(RIGHT_A, RIGHT_B, 960, 5.0f, true);
+
+// Forward quadrature order, state = A << 1 | B
+static const uint8_t FORWARD[4] = {0b00, 0b10, 0b11, 0b01};
+
+static int forwardIndex(uint8_t state) {
+    for (int i = 0; i < 4; i++) {
+        if (FORWARD[i] == state) return i;
+    }
+    return -1;
+}
+
+static uint8_t pinState(int pinA, int pinB) {
+    return (mock::readPin(pinA) << 1) | mock::readPin(pinB);
+}
+
+// One legal edge at a time, each through the pin's interrupt
+static void stepForward(int pinA, int pinB) {
+    uint8_t next = FORWARD[(forwardIndex(pinState(pinA, pinB)) + 1) % 4];
+    mock::setPin(pinA, next >> 1);
+    mock::setPin(pinB, next & 1);
+}
+
+static void stepBackward(int pinA, int pinB) {
+    uint8_t next = FORWARD[(forwardIndex(pinState(pinA, pinB)) + 3) % 4];
+    mock::setPin(pinA, next >> 1);
+    mock::setPin(pinB, next & 1);
+}
+
+static void walkTo(int pinA, int pinB, uint8_t state) {
+    while (pinState(pinA, pinB) != state) {
+        stepForward(pinA, pinB);
+    }
+}
+
+void setUp() {
+    static bool started = false;
+    if (!started) {
+        left.begin();
+        right.begin();
+        started = true;
+    }
+    left.reset();
+    right.reset();
+}
+
+void tearDown() {}
+
+void test_accumulator_folds_limit_events() {
+    PulseCounterAccumulator accumulator(30000);
+    TEST_ASSERT_EQUAL_INT64(100, accumulator.read([] { return (int16_t)100; }));
+
+    accumulator.onHighLimit();
+    TEST_ASSERT_EQUAL_INT64(30050, accumulator.read([] { return (int16_t)50; }));
+
+    accumulator.onLowLimit();
+    accumulator.onLowLimit();
+    TEST_ASSERT_EQUAL_INT64(-30020, accumulator.read([] { return (int16_t)-20; }));
+
+    accumulator.reset();
+    TEST_ASSERT_EQUAL_INT64(7, accumulator.read([] { return (int16_t)7; }));
+}
+
+void test_accumulator_counts_past_32_bits() {
+    PulseCounterAccumulator accumulator(30000);
+    for (int i = 0; i < 100000; i++) {
+        accumulator.onHighLimit();
+    }
+    TEST_ASSERT_EQUAL_INT64(3000000123LL, accumulator.read([] { return (int16_t)123; }));
+}
+
+void test_accumulator_retries_when_limit_lands_mid_read() {
+    PulseCounterAccumulator accumulator(30000);
+    int reads = 0;
+
+    // The first raw value is from just before the counter hit its limit and cleared;
+    // the limit interrupt then runs before the wrap count is re-read
+    int64_t total = accumulator.read([&] {
+        reads++;
+        if (reads == 1) {
+            accumulator.onHighLimit();
+            return (int16_t)29999;
+        }
+        return (int16_t)3;
+    });
+
+    TEST_ASSERT_EQUAL_INT(2, reads);
+    TEST_ASSERT_EQUAL_INT64(30003, total);
+}
+
+void test_quadrature_forward_and_back() {
+    for (int i = 0; i < 4 * 25; i++) {
+        stepForward(LEFT_A, LEFT_B);
+    }
+    TEST_ASSERT_EQUAL_INT(100, left.getCount());
+
+    for (int i = 0; i < 4 * 40; i++) {
+        stepBackward(LEFT_A, LEFT_B);
+    }
+    TEST_ASSERT_EQUAL_INT(-60, left.getCount());
+    TEST_ASSERT_EQUAL_UINT32(0, left.getIllegalTransitions());
+}
+
+void test_quadrature_table_every_transition() {
+    for (uint8_t previous = 0; previous < 4; previous++) {
+        for (uint8_t current = 0; current < 4; current++) {
+            walkTo(LEFT_A, LEFT_B, previous);
+            long count = left.getCount();
+            unsigned long illegal = left.getIllegalTransitions();
+
+            // Both pins are set before the single interrupt runs, as when the ISR is late
+            mock::writePin(LEFT_A, current >> 1);
+            mock::writePin(LEFT_B, current & 1);
+            mock::fireInterrupt(LEFT_A);
+
+            int distance = (forwardIndex(current) - forwardIndex(previous) + 4) % 4;
+            char message[48];
+            snprintf(message, sizeof(message), "transition %d -> %d", previous, current);
+            if (distance == 2) {
+                TEST_ASSERT_EQUAL_INT_MESSAGE(count, left.getCount(), message);
+                TEST_ASSERT_EQUAL_INT_MESSAGE(illegal + 1, left.getIllegalTransitions(), message);
+            } else {
+                int expected = distance == 1 ? 1 : (distance == 3 ? -1 : 0);
+                TEST_ASSERT_EQUAL_INT_MESSAGE(count + expected, left.getCount(), message);
+                TEST_ASSERT_EQUAL_INT_MESSAGE(illegal, left.getIllegalTransitions(), message);
+            }
+        }
+    }
+}
+
+void test_reversed_encoder_counts_down() {
+    for (int i = 0; i < 12; i++) {
+        stepForward(RIGHT_A, RIGHT_B);
+    }
+    TEST_ASSERT_EQUAL_INT(-12, right.getCount());
+    TEST_ASSERT_EQUAL_INT(0, left.getCount());
+    TEST_ASSERT_FLOAT_WITHIN(1e-5f, -12 * PI * 5.0f / 960, right.getDistance());
+}
+
+void test_edge_capture_drain_and_overrun() {
+    EdgeCaptureStats stats;
+    stats.drain(left);
+    TEST_ASSERT_FALSE(stats.active);
+
+    left.enableEdgeCapture(true);
+    for (int i = 0; i < 12; i++) {
+        mock::advanceMicros(100 + 10 * i);
+        stepForward(LEFT_A, LEFT_B);
+    }
+    mock::advanceMicros(500);
+    stepBackward(LEFT_A, LEFT_B);
+    stats.drain(left);
+    TEST_ASSERT_TRUE(stats.active);
+    TEST_ASSERT_EQUAL_INT(13, stats.edges);
+    TEST_ASSERT_EQUAL_INT(11, stats.net);
+    TEST_ASSERT_EQUAL_INT(stats.edges, stats.channelA + stats.channelB);
+    TEST_ASSERT_LESS_OR_EQUAL(1, labs((long)stats.channelA - (long)stats.channelB));
+    TEST_ASSERT_EQUAL_UINT32(110, stats.minIntervalUs);
+
+    // A consumer that falls behind loses the newest edges and counts them
+    for (size_t i = 0; i < ENCODER_EDGE_BUFFER_SIZE + 20; i++) {
+        mock::advanceMicros(50);
+        stepForward(LEFT_A, LEFT_B);
+    }
+    TEST_ASSERT_EQUAL_UINT32(20, left.getEdgeOverruns());
+    stats.drain(left);
+    TEST_ASSERT_EQUAL_INT(13 + ENCODER_EDGE_BUFFER_SIZE, stats.edges);
+
+    // Switching capture off and on again starts a fresh summary
+    left.enableEdgeCapture(false);
+    stats.drain(left);
+    left.enableEdgeCapture(true);
+    stepForward(LEFT_A, LEFT_B);
+    stats.drain(left);
+    TEST_ASSERT_EQUAL_INT(1, stats.edges);
+    TEST_ASSERT_EQUAL_UINT32(0, left.getEdgeOverruns());
+    left.enableEdgeCapture(false);
+}
+
+int main(int argc, char** argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_accumulator_folds_limit_events);
+    RUN_TEST(test_accumulator_counts_past_32_bits);
+    RUN_TEST(test_accumulator_retries_when_limit_lands_mid_read);
+    RUN_TEST(test_quadrature_forward_and_back);
+    RUN_TEST(test_quadrature_table_every_transition);
+    RUN_TEST(test_reversed_encoder_counts_down);
+    RUN_TEST(test_edge_capture_drain_and_overrun);
+    return UNITY_END();
+}
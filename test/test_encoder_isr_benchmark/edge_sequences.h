@@ -0,0 +1,72 @@
+#ifndef EDGE_SEQUENCES_H
+#define EDGE_SEQUENCES_H
+
+// Quadrature states (A << 1 | B) recorded from the host wheel simulation, one per interrupt-raising change.
+// A skipped state (both pins changed before the ISR ran) is a single entry two steps on.
+// Displacements are the simulated wheel's true travel in counts.
+
+// Crawling forward with 0-2 bounces of the contact being crossed
+// 1500 states, true displacement 603 counts
+static const char CRAWL_WITH_BOUNCE[] =
+    "0202323101020232310202310101020232310231010231310102020232323101010202323231020232313101010231010102"
+    "3232310102020232310101020202323102313101023131023131010202023102023231010102023102023231313101010202"
+    "0231010231313101010231310232323131020202323131310202313102313102020231310102020232310202023232313101"
+    "0232323102023231020202323231310202023232310231310202323101010202023102020231020231313101023131310102"
+    "3131010102310202313102023232313101020232310202023231010232323131010102313131010102023231310202023232"
+    "3131310102023231023102020231310101023231310231010102313102323231310232323131020202323231310101023232"
+    "3131310102020231313102023131310102023231310232323131310202023231313102323231020231023232310101023101"
+    "0231313101010232313101010231023232313101023232313102323102023231020202323102020231313101023131010102"
+    "3102020232323131010102023102020231313102020231310202023232310202023131310232310232310202023231010102"
+    "3231310101023101010231313101010202023131010202023131010231020231010202313101010202023101023232313131"
+    "0102020232310232313131010102313102020231310232310102310102323231010202323231310102023232313131010202"
+    "0231010102020231310102313102020231313101010232313131010102020232313101023232313131020202310232310102"
+    "0232310202023131310202023131023131010102323102323101020202323231020231310202023101023131310102023231"
+    "0232310101023101023231010102023232313102310232310232310202023231020202310102323131310232323102323231"
+    "0102020231010202310231023231310101020231310102023232310231310102323101020202313131020202310232313101";
+static constexpr long CRAWL_WITH_BOUNCE_DISPLACEMENT = 603;
+
+// Rocking +/-120 counts around the start, one edge at a time
+// 1044 states, true displacement 83 counts
+static const char OSCILLATING[] =
+    "0231023102310231023102310231023102310231023102310231023102310231023102310231023102310231023102310231"
+    "0231023102310231023101320132013201320132013201320132013201320132013201320132013201320132013201320132"
+    "0132013201320132013201320132013201320132013201320132013201320132013201320132013201320132013201320132"
+    "0132013201320132013201320132013201320132013201320132013201320231023102310231023102310231023102310231"
+    "0231023102310231023102310231023102310231023102310231023102310231023102310231023102310231023102310231"
+    "0231023102310231023102310231023102310231023102310231023102310231023102310231023102310231023102310231"
+    "0132013201320132013201320132013201320132013201320132013201320132013201320132013201320132013201320132"
+    "0132013201320132013201320132013201320132013201320132013201320132013201320132013201320132013201320132"
+    "0132013201320132013201320132013201320132023102310231023102310231023102310231023102310231023102310231"
+    "0231023102310231023102310231023102310231023102310231023102310231023102310231023102310231023102310231"
+    "02310231023102310231023102310231023102310231";
+static constexpr long OSCILLATING_DISPLACEMENT = 83;
+
+// Fast forward then back; about 3% of steps skip a state (both pins change before the ISR runs)
+// 2001 states, true displacement -2 counts
+static const char FAST_WITH_SKIPS[] =
+    "0231021023102310231023102310231023102310231023102310231031023103102310231023102310231023102310310231"
+    "0231021023102310231021023102310231023102310231023102102310231023102310231023102310231023102310231023"
+    "1023102310231023102310231023102302310231023102310231023102310231023102310231023102310231023102310231"
+    "0231031023102310210231023102310231023102102310231021023102310231023102310231023102310231023102102310"
+    "2310231023102310230231023102312310231023102310231023102310231023102302310231021023102310231023102310"
+    "2310231023102310231023103102310231023102310231023102310231023102310231023102310231023102102310231023"
+    "0231023102310231023102310231023102310231023102310231023102310231023102310231031231023102310231023102"
+    "1023102310231023102310231023102310231023102310231023102310231023102310231023102310231023023102310310"
+    "2310231023102102310231023102310231023102310231023102310231023102310231023102310231023102102302310231"
+    "0230231023102310231023102310231023102310231023102310231023102310231023121023102310231023102310231023"
+    "1320132013201320132013201320132013203201320132013203201320132013201320132013201301320320132013201320"
+    "1320132013201320132013201320132013201320132013201321320132013201320132013201320132013201320320320132"
+    "0132013201320132013201320132013201320132013201320132013201320132013201320132013201320132132013201320"
+    "1320132013203201320132013203201320132032013201320132013201320132012013201320132013203201320132132132"
+    "0132013201320132013201320132013201320132012012013201320132013201320132013201320132013201320132013201"
+    "3201320132013201320132013201320132013201320132013201301320132013201320132013013201320132013201320132"
+    "0132013201320132013201320132013201213201320132013201320132013201320132013201320132012013201320132013"
+    "2013203201320132013201320132013201320132013201320132013201320132013201320132013201320132013201320132"
+    "0132013201301320132013201201320132013201320132013201320132012013013203201320132013201320132013201320"
+    "1320132013201320132013201320132013212013201320320132013201320132013201320320320132013201320132013201"
+    "3";
+static constexpr long FAST_WITH_SKIPS_DISPLACEMENT = -2;
+static constexpr int FAST_WITH_SKIPS_FORWARD_SKIPS = 31;
+static constexpr int FAST_WITH_SKIPS_BACKWARD_SKIPS = 33;
+
+#endif
@@ -0,0 +1,210 @@
+#include <unity.h>
+#include <chrono>
+#include "hardware/Encoder.h"
+#include "edge_sequences.h"
+
+static constexpr int PIN_A = 4;
+static constexpr int PIN_B = 5;
+static constexpr int REPEATS = 200;
+
+static Encoder encoder(PIN_A, PIN_B, 960, 5.0f);
+
+/**
+ * The decoder Encoder had before the transition table: one ISR per pin, two digitalRead()s,
+ * direction from nested if/else. Kept here verbatim as the benchmark baseline.
+ */
+class LegacyDecoder {
+public:
+    volatile long count = 0;
+
+    void begin() {
+        lastA = digitalRead(PIN_A);
+        lastB = digitalRead(PIN_B);
+    }
+
+    void handleInterruptA() {
+        int A = digitalRead(PIN_A);
+        int B = digitalRead(PIN_B);
+        
+        if (A != lastA) {
+            int direction = 0;
+            if (A == HIGH) {
+                if (B == LOW) {
+                    direction = 1;
+                } else {
+                    direction = -1;
+                }
+            } else {
+                if (B == HIGH) {
+                    direction = 1;
+                } else {
+                    direction = -1;
+                }
+            }
+        
+            count += direction;
+            lastA = A;
+        }
+    }
+
+    void handleInterruptB() {
+        int A = digitalRead(PIN_A);
+        int B = digitalRead(PIN_B);
+        
+        if (B != lastB) {
+            int direction = 0;
+            if (B == HIGH) {
+                if (A == HIGH) {
+                    direction = 1;
+                } else {
+                    direction = -1;
+                }
+            } else {
+                if (A == LOW) {
+                    direction = 1;
+                } else {
+                    direction = -1;
+                }
+            }
+            
+            count += direction;
+            lastB = B;
+        }
+    }
+
+private:
+    volatile int lastA = 0;
+    volatile int lastB = 0;
+};
+
+static LegacyDecoder legacy;
+
+static void legacyIsrA() { legacy.handleInterruptA(); }
+static void legacyIsrB() { legacy.handleInterruptB(); }
+
+static void (*tableIsr)() = nullptr;
+static void tableIsrForBothPins() { tableIsr(); }
+
+// Applies each recorded state and raises the interrupt of every pin that changed, A first; returns edges raised
+static size_t replay(const char* states, void (*isrA)(), void (*isrB)()) {
+    size_t edges = 0;
+    for (const char* s = states; *s; s++) {
+        int a = (*s - '0') >> 1;
+        int b = (*s - '0') & 1;
+        bool changedA = mock::readPin(PIN_A) != a;
+        bool changedB = mock::readPin(PIN_B) != b;
+        mock::writePin(PIN_A, a);
+        mock::writePin(PIN_B, b);
+        if (changedA) isrA();
+        if (changedB) isrB();
+        edges += changedA + changedB;
+    }
+    return edges;
+}
+
+// Back to 00 one legal edge at a time, so the next replay starts where the recording did
+static size_t rewind(void (*isrA)(), void (*isrB)()) {
+    size_t edges = 0;
+    while (mock::readPin(PIN_A) || mock::readPin(PIN_B)) {
+        if (mock::readPin(PIN_A)) {
+            mock::writePin(PIN_A, 0);
+            isrA();
+        } else {
+            mock::writePin(PIN_B, 0);
+            isrB();
+        }
+        edges++;
+    }
+    return edges;
+}
+
+static double nsPerEdge(const char* states, void (*isrA)(), void (*isrB)()) {
+    size_t edges = 0;
+    auto begin = std::chrono::steady_clock::now();
+    for (int i = 0; i < REPEATS; i++) {
+        edges += replay(states, isrA, isrB);
+        edges += rewind(isrA, isrB);
+    }
+    auto elapsed = std::chrono::steady_clock::now() - begin;
+    return std::chrono::duration<double, std::nano>(elapsed).count() / edges;
+}
+
+struct Result {
+    long tableCount;
+    long legacyCount;
+    unsigned long illegal;
+};
+
+static Result run(const char* name, const char* states) {
+    Result result;
+    encoder.reset();
+    legacy.count = 0;
+    legacy.begin();
+
+    replay(states, tableIsrForBothPins, tableIsrForBothPins);
+    result.tableCount = encoder.getCount();
+    result.illegal = encoder.getIllegalTransitions();
+    replay(states, legacyIsrA, legacyIsrB);
+    result.legacyCount = legacy.count;
+    rewind(tableIsrForBothPins, tableIsrForBothPins);
+    rewind(legacyIsrA, legacyIsrB);
+
+    double tableNs = nsPerEdge(states, tableIsrForBothPins, tableIsrForBothPins);
+    double legacyNs = nsPerEdge(states, legacyIsrA, legacyIsrB);
+
+    char message[192];
+    snprintf(message, sizeof(message), "%s: table %.1f ns/edge, count %ld, %lu illegal | legacy %.1f ns/edge, count %ld",
+             name, tableNs, result.tableCount, result.illegal, legacyNs, result.legacyCount);
+    TEST_MESSAGE(message);
+    return result;
+}
+
+void setUp() {
+    static bool started = false;
+    if (!started) {
+        mock::writePin(PIN_A, 0);
+        mock::writePin(PIN_B, 0);
+        encoder.begin();
+        tableIsr = mock::interruptHandler(PIN_A);
+        started = true;
+    }
+}
+
+void tearDown() {}
+
+void test_crawl_with_bounce() {
+    Result result = run("crawl with bounce", CRAWL_WITH_BOUNCE);
+    TEST_ASSERT_EQUAL_INT(CRAWL_WITH_BOUNCE_DISPLACEMENT, result.tableCount);
+    TEST_ASSERT_EQUAL_INT(CRAWL_WITH_BOUNCE_DISPLACEMENT, result.legacyCount);
+    TEST_ASSERT_EQUAL_UINT32(0, result.illegal);
+}
+
+void test_oscillating() {
+    Result result = run("oscillating", OSCILLATING);
+    TEST_ASSERT_EQUAL_INT(OSCILLATING_DISPLACEMENT, result.tableCount);
+    TEST_ASSERT_EQUAL_INT(OSCILLATING_DISPLACEMENT, result.legacyCount);
+    TEST_ASSERT_EQUAL_UINT32(0, result.illegal);
+}
+
+void test_fast_with_skips() {
+    Result result = run("fast with skips", FAST_WITH_SKIPS);
+
+    // Every skip is reported and costs exactly its two uncounted steps
+    TEST_ASSERT_EQUAL_UINT32(FAST_WITH_SKIPS_FORWARD_SKIPS + FAST_WITH_SKIPS_BACKWARD_SKIPS, result.illegal);
+    TEST_ASSERT_EQUAL_INT(FAST_WITH_SKIPS_DISPLACEMENT - 2 * FAST_WITH_SKIPS_FORWARD_SKIPS + 2 * FAST_WITH_SKIPS_BACKWARD_SKIPS,
+                          result.tableCount);
+
+    // The legacy decoder miscounts the same skips silently
+    char message[96];
+    snprintf(message, sizeof(message), "legacy error %ld counts, unreported",
+             result.legacyCount - FAST_WITH_SKIPS_DISPLACEMENT);
+    TEST_MESSAGE(message);
+}
+
+int main(int argc, char** argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_crawl_with_bounce);
+    RUN_TEST(test_oscillating);
+    RUN_TEST(test_fast_with_skips);
+    return UNITY_END();
+}
@@ -0,0 +1,85 @@
+#include <unity.h>
+#include "hardware/Encoder.h"
+
+// ENCODER_COUNT slots; the third encoder has nowhere to go
+static Encoder first(4, 5, 960, 5.0f);
+static Encoder second(43, 44, 960, 5.0f, true);
+static Encoder extra(10, 11, 960, 5.0f);
+
+static const uint8_t FORWARD[4] = {0b00, 0b10, 0b11, 0b01};
+
+// Four forward edges, each delivered through whatever handler the pin has attached
+static void turnOneCycle(int pinA, int pinB) {
+    for (int i = 1; i <= 4; i++) {
+        uint8_t state = FORWARD[i % 4];
+        mock::setPin(pinA, state >> 1);
+        mock::setPin(pinB, state & 1);
+    }
+}
+
+void setUp() {
+    static bool started = false;
+    if (!started) {
+        first.begin();
+        second.begin();
+        extra.begin();
+        started = true;
+    }
+    first.reset();
+    second.reset();
+    extra.reset();
+}
+
+void tearDown() {}
+
+void test_slots_follow_begin_order() {
+    TEST_ASSERT_EQUAL_INT(0, first.getSlot());
+    TEST_ASSERT_EQUAL_INT(1, second.getSlot());
+    TEST_ASSERT_EQUAL_INT(-1, extra.getSlot());
+}
+
+void test_one_trampoline_per_slot_on_both_pins() {
+    TEST_ASSERT_TRUE(mock::interruptHandler(4) != nullptr);
+    TEST_ASSERT_TRUE(mock::interruptHandler(43) != nullptr);
+    TEST_ASSERT_TRUE(mock::interruptHandler(4) == mock::interruptHandler(5));
+    TEST_ASSERT_TRUE(mock::interruptHandler(43) == mock::interruptHandler(44));
+    TEST_ASSERT_TRUE(mock::interruptHandler(4) != mock::interruptHandler(43));
+
+    // No slot, no interrupt
+    TEST_ASSERT_TRUE(mock::interruptHandler(10) == nullptr);
+    TEST_ASSERT_TRUE(mock::interruptHandler(11) == nullptr);
+}
+
+void test_each_trampoline_reaches_only_its_encoder() {
+    turnOneCycle(4, 5);
+    TEST_ASSERT_EQUAL_INT(4, first.getCount());
+    TEST_ASSERT_EQUAL_INT(0, second.getCount());
+
+    turnOneCycle(43, 44);
+    turnOneCycle(43, 44);
+    TEST_ASSERT_EQUAL_INT(4, first.getCount());
+    TEST_ASSERT_EQUAL_INT(-8, second.getCount());
+
+    turnOneCycle(10, 11);
+    TEST_ASSERT_EQUAL_INT(0, extra.getCount());
+}
+
+void test_begin_again_keeps_slot_and_handler() {
+    void (*handler)() = mock::interruptHandler(43);
+    second.begin();
+    TEST_ASSERT_EQUAL_INT(1, second.getSlot());
+    TEST_ASSERT_TRUE(handler == mock::interruptHandler(43));
+
+    turnOneCycle(43, 44);
+    TEST_ASSERT_EQUAL_INT(-4, second.getCount());
+    TEST_ASSERT_EQUAL_INT(0, first.getCount());
+}
+
+int main(int argc, char** argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_slots_follow_begin_order);
+    RUN_TEST(test_one_trampoline_per_slot_on_both_pins);
+    RUN_TEST(test_each_trampoline_reaches_only_its_encoder);
+    RUN_TEST(test_begin_again_keeps_slot_and_handler);
+    return UNITY_END();
+}
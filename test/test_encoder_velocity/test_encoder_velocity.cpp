@@ -0,0 +1,193 @@
+#include <unity.h>
+#include "hardware/Encoder.h"
+
+// Both encoders see the same synthetic edge stream; one per velocity mode
+static constexpr int EDGE_A = 4;
+static constexpr int EDGE_B = 5;
+static constexpr int WINDOW_A = 6;
+static constexpr int WINDOW_B = 7;
+static constexpr uint32_t TICK_US = 2000;  // control rate
+static constexpr uint32_t SIM_STEP_US = 10;
+
+static Encoder edgeTimed(EDGE_A, EDGE_B, 960, 5.0f);
+static Encoder windowed(WINDOW_A, WINDOW_B, 960, 5.0f);
+static const float COUNT_CM = PI * 5.0f / 960;
+
+static const uint8_t FORWARD[4] = {0b00, 0b10, 0b11, 0b01};
+static long wheelCount = 0;  // carried across scenarios so the pins never jump
+
+static void edge(int pinA, int pinB, long count) {
+    uint8_t state = FORWARD[((count % 4) + 4) % 4];
+    mock::setPin(pinA, state >> 1);
+    mock::setPin(pinB, state & 1);
+}
+
+/**
+ * Wheel driven along a velocity profile; every count it crosses raises one edge on both encoders at that microsecond
+ */
+struct WheelSim {
+    double position = wheelCount;  // counts
+
+    void advance(float velocity, uint32_t us) {
+        for (uint32_t t = 0; t < us; t += SIM_STEP_US) {
+            mock::advanceMicros(SIM_STEP_US);
+            position += velocity * SIM_STEP_US * 1e-6 / COUNT_CM;
+            while ((long)floor(position) > wheelCount) {
+                wheelCount++;
+                edge(EDGE_A, EDGE_B, wheelCount);
+                edge(WINDOW_A, WINDOW_B, wheelCount);
+            }
+        }
+    }
+
+    void tick(float velocity) {
+        advance(velocity, TICK_US);
+        edgeTimed.update();
+        windowed.update();
+    }
+};
+
+struct ErrorStats {
+    double sumSquares = 0;
+    int samples = 0;
+
+    void add(float estimate, float truth) {
+        sumSquares += (estimate - truth) * (estimate - truth);
+        samples++;
+    }
+    float rms() const { return samples ? sqrt(sumSquares / samples) : 0; }
+};
+
+static void report(const char* name, const ErrorStats& edgeStats, const ErrorStats& windowStats, float truth) {
+    char message[128];
+    snprintf(message, sizeof(message), "%s: RMS error edge-timed %.3f cm/s (%.1f%%), windowed %.3f cm/s (%.1f%%)",
+             name, edgeStats.rms(), 100 * edgeStats.rms() / truth, windowStats.rms(), 100 * windowStats.rms() / truth);
+    TEST_MESSAGE(message);
+}
+
+void setUp() {
+    static bool started = false;
+    if (!started) {
+        edgeTimed.begin();
+        windowed.begin();
+        edgeTimed.setVelocityMode(Encoder::VelocityMode::EdgeTimed);
+        windowed.setVelocityMode(Encoder::VelocityMode::Windowed);
+        started = true;
+    }
+
+    // Let both estimators see the wheel at rest before each scenario
+    WheelSim rest;
+    for (int i = 0; i < 200; i++) rest.tick(0);
+}
+
+void tearDown() {}
+
+void test_cruise_noise() {
+    WheelSim wheel;
+    ErrorStats edgeStats;
+    ErrorStats windowStats;
+    for (int i = 0; i < 500; i++) {
+        wheel.tick(20.0f);
+        if (i >= 100) {
+            edgeStats.add(edgeTimed.getVelocity(), 20.0f);
+            windowStats.add(windowed.getVelocity(), 20.0f);
+        }
+    }
+    report("20 cm/s", edgeStats, windowStats, 20.0f);
+    TEST_ASSERT_LESS_THAN(0.02f * 20.0f, edgeStats.rms());
+}
+
+void test_speed_step_latency() {
+    WheelSim wheel;
+    for (int i = 0; i < 250; i++) wheel.tick(10.0f);
+
+    // Latency: time after the step until the estimate last left 5% of the new speed
+    float edgeLatency = 0;
+    float windowLatency = 0;
+    for (int i = 1; i <= 250; i++) {
+        wheel.tick(30.0f);
+        if (fabsf(edgeTimed.getVelocity() - 30.0f) > 1.5f) edgeLatency = i * TICK_US * 1e-3f;
+        if (fabsf(windowed.getVelocity() - 30.0f) > 1.5f) windowLatency = i * TICK_US * 1e-3f;
+    }
+
+    char message[96];
+    snprintf(message, sizeof(message), "10 -> 30 cm/s: latency edge-timed %.0f ms, windowed %.0f ms", edgeLatency, windowLatency);
+    TEST_MESSAGE(message);
+    TEST_ASSERT_LESS_OR_EQUAL(10.0f, edgeLatency);
+    TEST_ASSERT_GREATER_OR_EQUAL(90.0f, windowLatency);
+}
+
+void test_crawl_speed() {
+    // 0.3 cm/s is one count every 55 ms, about two per 100 ms window
+    WheelSim wheel;
+    ErrorStats edgeStats;
+    ErrorStats windowStats;
+    for (int i = 0; i < 2000; i++) {
+        wheel.tick(0.3f);
+        if (i >= 250) {
+            edgeStats.add(edgeTimed.getVelocity(), 0.3f);
+            windowStats.add(windowed.getVelocity(), 0.3f);
+        }
+    }
+    report("0.3 cm/s", edgeStats, windowStats, 0.3f);
+    TEST_ASSERT_LESS_THAN(0.05f * 0.3f, edgeStats.rms());
+    TEST_ASSERT_LESS_THAN(windowStats.rms(), edgeStats.rms());
+}
+
+void test_decays_to_zero_after_stop() {
+    WheelSim wheel;
+    for (int i = 0; i < 100; i++) wheel.tick(20.0f);
+
+    // Between edges the estimate may not exceed one count over the time since the last one
+    for (int i = 1; i <= 200; i++) {
+        wheel.tick(0);
+        float sinceEdge = i * TICK_US * 1e-6f;
+        TEST_ASSERT_LESS_OR_EQUAL(COUNT_CM / sinceEdge + 1e-3f, edgeTimed.getVelocity());
+    }
+    TEST_ASSERT_EQUAL_FLOAT(0.0f, edgeTimed.getVelocity());
+}
+
+void test_restart_after_stall_measures_from_last_edge() {
+    auto nextEdge = [&]() {
+        wheelCount++;
+        edge(EDGE_A, EDGE_B, wheelCount);
+        edge(WINDOW_A, WINDOW_B, wheelCount);
+    };
+
+    // 1 ms edges with an update after every fourth, then two more edges the estimator has not yet consumed
+    for (int i = 0; i < 12; i++) {
+        mock::advanceMicros(1000);
+        nextEdge();
+        if (i % 4 == 3) edgeTimed.update();
+    }
+    mock::advanceMicros(1000);
+    nextEdge();
+    mock::advanceMicros(1000);
+    nextEdge();
+    uint32_t lastEdgeUs = micros();
+
+    // Stalled well past the timeout
+    for (int i = 0; i < 200; i++) {
+        mock::advanceMicros(TICK_US);
+        edgeTimed.update();
+    }
+    TEST_ASSERT_EQUAL_FLOAT(0.0f, edgeTimed.getVelocity());
+
+    // The first edge after the stall is one count over the span from the last edge before it
+    mock::advanceMicros(700);
+    nextEdge();
+    uint32_t span = micros() - lastEdgeUs;
+    mock::advanceMicros(5);
+    edgeTimed.update();
+    TEST_ASSERT_FLOAT_WITHIN(1e-6f, COUNT_CM / (span * 1e-6f), edgeTimed.getVelocity());
+}
+
+int main(int argc, char** argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_cruise_noise);
+    RUN_TEST(test_speed_step_latency);
+    RUN_TEST(test_crawl_speed);
+    RUN_TEST(test_decays_to_zero_after_stop);
+    RUN_TEST(test_restart_after_stall_measures_from_last_edge);
+    return UNITY_END();
+}
@@ -0,0 +1,119 @@
+#include <unity.h>
+#include <vector>
+#include "config.h"
+#include "utils/FopdtFit.h"
+#include "utils/ExcitationSignal.h"
+
+// Motor as SystemIdCommand captures it: 500 Hz, velocity in 0.01 cm/s fixed point
+static constexpr float DT = 0.002f;
+static constexpr float PLANT_GAIN = 0.4f;     // cm/s per PWM
+static constexpr float PLANT_TAU = 0.15f;     // s
+static constexpr int DELAY_TICKS = 10;        // 20 ms
+static constexpr float PLANT_OFFSET = -6.0f;  // cm/s at zero PWM, a deadband seen through a linear model
+static constexpr int MAX_DELAY_TICKS = 50;    // SYSTEM_ID_MAX_DELAY_MS at the control rate
+
+struct Capture {
+    std::vector<float> pwm;
+    std::vector<float> velocity;
+};
+
+// Drives the plant with the excitation and records what the command would: each tick's PWM next to the velocity
+// measured before it was applied, with uniform noise on the measurement
+static Capture simulate(const ExcitationSignal::Config& config, float noiseAmplitude) {
+    ExcitationSignal excitation;
+    excitation.begin(config);
+    Capture capture;
+    float velocity = PLANT_GAIN * config.bias + PLANT_OFFSET;
+    float pending[DELAY_TICKS];
+    for (float& pwm : pending) pwm = config.bias;
+    int head = 0;
+    uint32_t noiseState = 7;
+
+    while (!excitation.isFinished()) {
+        noiseState = noiseState * 1664525u + 1013904223u;
+        float noise = ((noiseState >> 8) / 16777216.0f * 2.0f - 1.0f) * noiseAmplitude;
+        capture.velocity.push_back(lroundf((velocity + noise) * 100.0f) / 100.0f);
+
+        float pwm = excitation.next(DT);
+        capture.pwm.push_back(pwm);
+        float delayed = pending[head];
+        pending[head] = pwm;
+        head = (head + 1) % DELAY_TICKS;
+        velocity += (PLANT_GAIN * delayed + PLANT_OFFSET - velocity) * DT / PLANT_TAU;
+    }
+    return capture;
+}
+
+static FopdtFit::Result fit(const Capture& capture) {
+    const Capture* c = &capture;
+    return FopdtFit::fit([c](int i) { return c->pwm[i]; }, [c](int i) { return c->velocity[i]; },
+                         (int)capture.pwm.size(), DT, MAX_DELAY_TICKS);
+}
+
+static void report(const char* name, const FopdtFit::Result& result) {
+    char message[160];
+    snprintf(message, sizeof(message), "%s: K %.4f tau %.4f s L %.3f s offset %.2f fit %.1f%% (%d points)",
+             name, result.gain, result.timeConstant, result.deadTime, result.offset, result.fitPercent, result.points);
+    TEST_MESSAGE(message);
+}
+
+static ExcitationSignal::Config prbs(float duration) {
+    return {ExcitationSignal::Type::Prbs, 120.0f, 40.0f, duration, 0, 0.05f, 0, 0};
+}
+
+void setUp() {}
+
+void tearDown() {}
+
+void test_recovers_clean_step() {
+    Capture capture = simulate({ExcitationSignal::Type::Step, 100.0f, 60.0f, 1.5f, 0.3f, 0, 0, 0}, 0);
+    FopdtFit::Result result = fit(capture);
+    report("step", result);
+
+    TEST_ASSERT_TRUE(result.ok);
+    TEST_ASSERT_FLOAT_WITHIN(0.01f * PLANT_GAIN, PLANT_GAIN, result.gain);
+    TEST_ASSERT_FLOAT_WITHIN(0.02f * PLANT_TAU, PLANT_TAU, result.timeConstant);
+    TEST_ASSERT_FLOAT_WITHIN(DT / 2, DELAY_TICKS * DT, result.deadTime);
+    TEST_ASSERT_FLOAT_WITHIN(0.5f, PLANT_OFFSET, result.offset);
+    TEST_ASSERT_GREATER_OR_EQUAL(99.0f, result.fitPercent);
+}
+
+void test_recovers_noisy_prbs() {
+    // 1 cm/s of noise biases plain least squares towards a faster, lower-gain plant
+    Capture capture = simulate(prbs(8.0f), 1.0f);
+    FopdtFit::Result result = fit(capture);
+    report("prbs, 1 cm/s noise", result);
+
+    TEST_ASSERT_TRUE(result.ok);
+    TEST_ASSERT_FLOAT_WITHIN(0.05f * PLANT_GAIN, PLANT_GAIN, result.gain);
+    TEST_ASSERT_FLOAT_WITHIN(0.1f * PLANT_TAU, PLANT_TAU, result.timeConstant);
+    TEST_ASSERT_FLOAT_WITHIN(2 * DT, DELAY_TICKS * DT, result.deadTime);
+}
+
+void test_single_precision_holds_over_full_capture() {
+    // The longest capture the command keeps; the sums are all float, as on the target
+    Capture capture = simulate(prbs((SYSTEM_ID_MAX_SAMPLES - 0.5f) * DT), 0.2f);
+    TEST_ASSERT_EQUAL_INT(SYSTEM_ID_MAX_SAMPLES, (int)capture.pwm.size());
+    FopdtFit::Result result = fit(capture);
+    report("prbs, full capture", result);
+
+    TEST_ASSERT_TRUE(result.ok);
+    TEST_ASSERT_FLOAT_WITHIN(0.02f * PLANT_GAIN, PLANT_GAIN, result.gain);
+    TEST_ASSERT_FLOAT_WITHIN(0.05f * PLANT_TAU, PLANT_TAU, result.timeConstant);
+    TEST_ASSERT_FLOAT_WITHIN(DT / 2, DELAY_TICKS * DT, result.deadTime);
+    TEST_ASSERT_GREATER_OR_EQUAL(95.0f, result.fitPercent);
+}
+
+void test_constant_input_is_not_a_fit() {
+    Capture capture = simulate({ExcitationSignal::Type::Step, 100.0f, 0, 1.0f, 0.3f, 0, 0, 0}, 0.5f);
+    TEST_ASSERT_FALSE(fit(capture).ok);
+}
+
+int main(int argc, char** argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_recovers_clean_step);
+    RUN_TEST(test_recovers_noisy_prbs);
+    RUN_TEST(test_single_precision_holds_over_full_capture);
+    RUN_TEST(test_constant_input_is_not_a_fit);
+    return UNITY_END();
+}
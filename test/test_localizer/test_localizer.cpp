@@ -0,0 +1,202 @@
+#include <unity.h>
+#include <chrono>
+#include "config.h"
+#include "drive/Localizer.h"
+
+static constexpr float DT = 0.002f;  // control rate
+static constexpr float NOISE = 0.01f;
+static constexpr double PI_D = 3.14159265358979323846;
+
+/**
+ * Differential-drive car integrated at 100x the control rate in double precision as ground truth
+ * Wheel speeds come from a caller-supplied profile so each scenario is one function of time
+ */
+struct Car {
+    double x = 0, y = 0, theta = 0;
+    double leftDistance = 0, rightDistance = 0;
+    float leftVelocity = 0, rightVelocity = 0;
+
+    template<typename Profile>
+    void tick(double t, Profile profile) {
+        const int substeps = 100;
+        double h = DT / substeps;
+        for (int i = 0; i < substeps; i++) {
+            float vl, vr;
+            profile(t + (i + 0.5) * h, vl, vr);
+            double v = 0.5 * (vl + vr);
+            double w = (vr - vl) / TRACK_WIDTH;
+            x += v * cos(theta + 0.5 * w * h) * h;
+            y += v * sin(theta + 0.5 * w * h) * h;
+            theta += w * h;
+            leftDistance += vl * h;
+            rightDistance += vr * h;
+            leftVelocity = vl;
+            rightVelocity = vr;
+        }
+    }
+};
+
+static double wrap(double angle) {
+    return atan2(sin(angle), cos(angle));
+}
+
+template<typename Profile>
+static float runTrajectory(Localizer& localizer, Car& car, float duration, Profile profile) {
+    float worst = 0;
+    localizer.update(0, 0, 0, 0);
+    int steps = (int)(duration / DT + 0.5f);
+    for (int i = 0; i < steps; i++) {
+        car.tick(i * DT, profile);
+        localizer.update(car.leftDistance, car.rightDistance, car.leftVelocity, car.rightVelocity);
+        LocalizerState state = localizer.getState();
+        worst = fmaxf(worst, hypot(state.pose.x - car.x, state.pose.y - car.y));
+    }
+    return worst;
+}
+
+void setUp() {}
+
+void tearDown() {}
+
+void test_straight_line() {
+    Localizer localizer(TRACK_WIDTH, NOISE);
+    localizer.update(5.0f, 7.0f, 0, 0);  // first update is the origin, whatever the encoders read
+    for (int i = 1; i <= 100; i++) {
+        localizer.update(5.0f + i, 7.0f + i, 50.0f, 50.0f);
+    }
+    LocalizerState state = localizer.getState();
+    TEST_ASSERT_FLOAT_WITHIN(1e-4f, 100.0f, state.pose.x);
+    TEST_ASSERT_FLOAT_WITHIN(1e-4f, 0.0f, state.pose.y);
+    TEST_ASSERT_FLOAT_WITHIN(1e-6f, 0.0f, state.pose.theta);
+    TEST_ASSERT_FLOAT_WITHIN(1e-4f, 50.0f, state.twist.linear);
+    TEST_ASSERT_FLOAT_WITHIN(1e-6f, 0.0f, state.twist.angular);
+    TEST_ASSERT_EQUAL_UINT32(101, state.updates);
+
+    // Heading variance straight ahead is the two wheels' variance over the track width squared
+    TEST_ASSERT_FLOAT_WITHIN(1e-6f, 2 * NOISE * 100.0f / (TRACK_WIDTH * TRACK_WIDTH), state.covariance[5]);
+    TEST_ASSERT_FLOAT_WITHIN(1e-4f, NOISE * 100.0f / 2, state.covariance[0]);
+}
+
+void test_arc_is_exact_for_large_steps() {
+    // Constant wheel speeds trace a circle; a quarter turn in only 4 updates still lands on it
+    Localizer localizer(TRACK_WIDTH, NOISE);
+    float radius = 30.0f;
+    float quarter = PI_D / 2;
+    float dl = (radius - TRACK_WIDTH / 2) * quarter / 4;
+    float dr = (radius + TRACK_WIDTH / 2) * quarter / 4;
+    localizer.update(0, 0, 0, 0);
+    for (int i = 1; i <= 4; i++) {
+        localizer.update(i * dl, i * dr, 0, 0);
+    }
+    LocalizerState state = localizer.getState();
+    TEST_ASSERT_FLOAT_WITHIN(1e-3f, radius, state.pose.x);
+    TEST_ASSERT_FLOAT_WITHIN(1e-3f, radius, state.pose.y);
+    TEST_ASSERT_FLOAT_WITHIN(1e-5f, quarter, state.pose.theta);
+}
+
+void test_spin_in_place_wraps_heading() {
+    Localizer localizer(TRACK_WIDTH, NOISE);
+    localizer.update(0, 0, 0, 0);
+    float halfTurn = PI_D * TRACK_WIDTH / 2;
+    for (int i = 1; i <= 30; i++) {
+        float d = halfTurn * 3 * i / 30;  // one and a half turns counter-clockwise
+        localizer.update(-d, d, 0, 0);
+    }
+    LocalizerState state = localizer.getState();
+    TEST_ASSERT_FLOAT_WITHIN(1e-4f, 0.0f, state.pose.x);
+    TEST_ASSERT_FLOAT_WITHIN(1e-4f, 0.0f, state.pose.y);
+    TEST_ASSERT_FLOAT_WITHIN(1e-4f, PI_D, fabsf(state.pose.theta));
+}
+
+void test_reset_takes_next_update_as_origin() {
+    Localizer localizer(TRACK_WIDTH, NOISE);
+    localizer.update(0, 0, 0, 0);
+    localizer.update(10.0f, 20.0f, 0, 0);
+    localizer.requestReset();
+    localizer.update(40.0f, 40.0f, 0, 0);
+    LocalizerState state = localizer.getState();
+    TEST_ASSERT_FLOAT_WITHIN(1e-6f, 0.0f, state.pose.x);
+    TEST_ASSERT_FLOAT_WITHIN(1e-6f, 0.0f, state.covariance[0]);
+
+    localizer.update(45.0f, 45.0f, 0, 0);
+    TEST_ASSERT_FLOAT_WITHIN(1e-5f, 5.0f, localizer.getState().pose.x);
+}
+
+void test_tracks_synthetic_trajectories() {
+    struct Scenario {
+        const char* name;
+        float duration;
+        void (*profile)(double t, float& vl, float& vr);
+    };
+    const Scenario scenarios[] = {
+        {"figure eight", 20.0f, [](double t, float& vl, float& vr) {
+            // Turn rate follows a sine, so the car alternates loops
+            float w = 0.8f * sin(2 * PI_D * t / 10.0);
+            vl = 30.0f - w * TRACK_WIDTH / 2;
+            vr = 30.0f + w * TRACK_WIDTH / 2;
+        }},
+        {"stop and go slalom", 20.0f, [](double t, float& vl, float& vr) {
+            float v = 40.0f * fmax(0.0, sin(2 * PI_D * t / 4.0));
+            float w = 1.5f * sin(2 * PI_D * t / 1.3);
+            vl = v - w * TRACK_WIDTH / 2;
+            vr = v + w * TRACK_WIDTH / 2;
+        }},
+        {"pivot and sprint", 10.0f, [](double t, float& vl, float& vr) {
+            float phase = fmod(t, 2.0);
+            float spin = phase < 0.5 ? 20.0f : 0.0f;
+            float v = phase < 0.5 ? 0.0f : 60.0f;
+            vl = v - spin;
+            vr = v + spin;
+        }},
+    };
+
+    for (const Scenario& scenario : scenarios) {
+        Localizer localizer(TRACK_WIDTH, NOISE);
+        Car car;
+        float worst = runTrajectory(localizer, car, scenario.duration, scenario.profile);
+        LocalizerState state = localizer.getState();
+        float headingError = wrap(state.pose.theta - car.theta);
+
+        char message[160];
+        snprintf(message, sizeof(message), "%s: %.0f cm travelled, worst position error %.4f cm, final heading error %.2e rad",
+                 scenario.name, 0.5 * (car.leftDistance + car.rightDistance), worst, headingError);
+        TEST_MESSAGE(message);
+        TEST_ASSERT_LESS_THAN(0.05f, worst);
+        TEST_ASSERT_FLOAT_WITHIN(1e-3f, 0.0f, headingError);
+        TEST_ASSERT_TRUE(state.covariance[0] > 0 && state.covariance[3] > 0 && state.covariance[5] > 0);
+        TEST_ASSERT_TRUE(state.covariance[1] * state.covariance[1] <= state.covariance[0] * state.covariance[3]);
+    }
+}
+
+void test_update_benchmark() {
+    Localizer localizer(TRACK_WIDTH, NOISE);
+    const int iterations = 1000000;
+    float left = 0;
+    float right = 0;
+
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; i++) {
+        left += 0.06f;
+        right += 0.07f;
+        localizer.update(left, right, 30.0f, 35.0f);
+    }
+    auto elapsed = std::chrono::steady_clock::now() - start;
+
+    double ns = std::chrono::duration<double, std::nano>(elapsed).count() / iterations;
+    char message[64];
+    snprintf(message, sizeof(message), "update(): %.1f ns per call", ns);
+    TEST_MESSAGE(message);
+    TEST_ASSERT_EQUAL_UINT32(iterations, localizer.getState().updates);
+    TEST_ASSERT_LESS_THAN(2000.0, ns);
+}
+
+int main(int argc, char** argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_straight_line);
+    RUN_TEST(test_arc_is_exact_for_large_steps);
+    RUN_TEST(test_spin_in_place_wraps_heading);
+    RUN_TEST(test_reset_takes_next_update_as_origin);
+    RUN_TEST(test_tracks_synthetic_trajectories);
+    RUN_TEST(test_update_benchmark);
+    return UNITY_END();
+}
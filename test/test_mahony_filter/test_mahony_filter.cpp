@@ -0,0 +1,111 @@
+#include <unity.h>
+#include <Arduino.h>
+#include <chrono>
+#include "config.h"
+#include "utils/MahonyFilter.h"
+
+// 500 Hz, the control rate, well above the IMU's own sample rate so the cost has headroom
+static constexpr float DT = 0.002f;
+static constexpr float DEG = PI / 180.0f;
+
+static const MahonyFilter::Config CONFIG = {
+    IMU_ATTITUDE_KP, IMU_ATTITUDE_KI, IMU_ATTITUDE_INTEGRAL_LIMIT, IMU_ATTITUDE_ACCEL_TOLERANCE
+};
+
+// Gravity in the body frame of a car rolled by roll and pitched by pitch, in g
+static void gravity(float roll, float pitch, float& ax, float& ay, float& az) {
+    ax = -sinf(pitch);
+    ay = sinf(roll) * cosf(pitch);
+    az = cosf(roll) * cosf(pitch);
+}
+
+void setUp() {}
+
+void tearDown() {}
+
+void test_reset_takes_tilt_from_accelerometer() {
+    MahonyFilter filter(CONFIG);
+    float ax, ay, az;
+    gravity(10 * DEG, -20 * DEG, ax, ay, az);
+    filter.reset(9.81f * ax, 9.81f * ay, 9.81f * az);  // any units
+    TEST_ASSERT_FLOAT_WITHIN(1e-4f, 10 * DEG, filter.getRoll());
+    TEST_ASSERT_FLOAT_WITHIN(1e-4f, -20 * DEG, filter.getPitch());
+    TEST_ASSERT_FLOAT_WITHIN(1e-4f, 0.0f, filter.getYaw());
+    TEST_ASSERT_FLOAT_WITHIN(1e-4f, cosf(10 * DEG) * cosf(20 * DEG), filter.getUpright());
+}
+
+void test_yaw_integrates_gyro() {
+    MahonyFilter filter(CONFIG);
+    filter.reset(0, 0, 1);
+    for (int i = 0; i < 1000; i++) {
+        filter.update(0, 0, 1.0f, 0, 0, 1, DT);
+    }
+    TEST_ASSERT_FLOAT_WITHIN(1e-3f, 2.0f, filter.getYaw());
+    TEST_ASSERT_FLOAT_WITHIN(1e-3f, 0.0f, filter.getRoll());
+}
+
+void test_accelerometer_pulls_out_gyro_bias() {
+    // A 1 deg/s roll bias would tip the estimate over within minutes; the PI correction holds it and learns the bias
+    MahonyFilter filter(CONFIG);
+    float ax, ay, az;
+    gravity(5 * DEG, 0, ax, ay, az);
+    filter.reset(ax, ay, az);
+    float bias = 1.0f * DEG;
+    for (int i = 0; i < 300 * 500; i++) {
+        filter.update(bias, 0, 0, ax, ay, az, DT);
+    }
+
+    char message[96];
+    snprintf(message, sizeof(message), "roll error %.4f deg, learned bias %.4f deg/s", (filter.getRoll() - 5 * DEG) / DEG, -filter.getIntegral()[0] / DEG);
+    TEST_MESSAGE(message);
+    TEST_ASSERT_FLOAT_WITHIN(0.05f * DEG, 5 * DEG, filter.getRoll());
+    TEST_ASSERT_FLOAT_WITHIN(0.05f * bias, -bias, filter.getIntegral()[0]);
+}
+
+void test_ignores_accelerometer_under_acceleration() {
+    // Braking at 0.7 g reads as a pitched gravity vector; outside the tolerance it must not tilt the estimate
+    MahonyFilter filter(CONFIG);
+    filter.reset(0, 0, 1);
+    for (int i = 0; i < 500; i++) {
+        filter.update(0, 0, 0, 0.7f, 0, 1.0f, DT);
+    }
+    TEST_ASSERT_FLOAT_WITHIN(1e-5f, 0.0f, filter.getPitch());
+
+    // Within the tolerance the same direction is taken as tilt
+    for (int i = 0; i < 500; i++) {
+        filter.update(0, 0, 0, 0.3f, 0, 0.95f, DT);
+    }
+    TEST_ASSERT_LESS_THAN(-5 * DEG, filter.getPitch());
+}
+
+void test_update_benchmark() {
+    MahonyFilter filter(CONFIG);
+    filter.reset(0, 0, 1);
+    const int iterations = 1000000;
+    float ax, ay, az;
+    gravity(3 * DEG, -2 * DEG, ax, ay, az);
+
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; i++) {
+        filter.update(0.01f, -0.02f, 0.3f, ax, ay, az, DT);
+    }
+    auto elapsed = std::chrono::steady_clock::now() - start;
+    volatile float sink = filter.getYaw();
+    (void)sink;
+
+    double ns = std::chrono::duration<double, std::nano>(elapsed).count() / iterations;
+    char message[96];
+    snprintf(message, sizeof(message), "update(): %.1f ns per call, %.3f%% of a 500 Hz tick", ns, 100 * ns / (DT * 1e9));
+    TEST_MESSAGE(message);
+    TEST_ASSERT_LESS_THAN(2000.0, ns);
+}
+
+int main(int argc, char** argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_reset_takes_tilt_from_accelerometer);
+    RUN_TEST(test_yaw_integrates_gyro);
+    RUN_TEST(test_accelerometer_pulls_out_gyro_bias);
+    RUN_TEST(test_ignores_accelerometer_under_acceleration);
+    RUN_TEST(test_update_benchmark);
+    return UNITY_END();
+}
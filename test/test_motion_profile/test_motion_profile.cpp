@@ -0,0 +1,165 @@
+#include <unity.h>
+#include <Arduino.h>
+#include "config.h"
+#include "drive/MotionProfile.h"
+#include "drive/ProfileFollower.h"
+
+static constexpr float DT = 0.002f;  // control rate
+static constexpr float LOOP_TAU = 0.075f;  // closed velocity loop, as test_pid tunes it
+static constexpr int LOOP_DELAY_TICKS = 5;
+
+static const ProfileFollower::Config CONFIG = {MOTION_POSITION_GAIN, MOTION_CATCH_UP_MARGIN, MOTION_SETTLE_TIMEOUT_MS * 1e-3f};
+
+/**
+ * The velocity loop seen from the follower: the command reaches the wheels after a delay and a first-order lag,
+ * scaled by gain (a feedforward that is short, or a turn that scrubs). Progress is the integrated wheel speed.
+ */
+struct VelocityLoop {
+    float gain = 1.0f;
+    float velocity = 0;
+    float progress = 0;
+    float pending[LOOP_DELAY_TICKS] = {};
+    int head = 0;
+    bool stalled = false;
+
+    void step(float command) {
+        float delayed = pending[head];
+        pending[head] = command;
+        head = (head + 1) % LOOP_DELAY_TICKS;
+        velocity += (gain * delayed - velocity) * DT / LOOP_TAU;
+        if (stalled) velocity = 0;
+        progress += velocity * DT;
+    }
+};
+
+struct Move {
+    float endpointError;  // as the follower reported it
+    float restError;      // once the wheels have stopped
+    float duration;       // s until the follower finished
+    float peakCommand;
+};
+
+static Move follow(ProfileFollower& follower, VelocityLoop& loop, float distance, const MotionProfile::Limits& limits, float tolerance) {
+    TEST_ASSERT_TRUE(follower.start(distance, limits, tolerance));
+    Move move = {0, 0, 0, 0};
+    int tick = 0;
+    while (!follower.isDone() && tick < 20000) {
+        float command = follower.update(tick * DT, loop.progress);
+        move.peakCommand = fmaxf(move.peakCommand, fabsf(command));
+        loop.step(command);
+        tick++;
+    }
+    TEST_ASSERT_TRUE(follower.isDone());
+    move.duration = tick * DT;
+    move.endpointError = follower.getEndpointError();
+    for (int i = 0; i < 500; i++) loop.step(0);
+    move.restError = distance - loop.progress;
+    return move;
+}
+
+void setUp() {}
+
+void tearDown() {}
+
+void test_profile_ends_on_distance_within_limits() {
+    const struct {
+        float distance;
+        MotionProfile::Limits limits;
+    } cases[] = {
+        {100.0f, {30.0f, MOTION_MAX_ACCELERATION, MOTION_MAX_JERK}},  // cruises
+        {10.0f, {30.0f, MOTION_MAX_ACCELERATION, MOTION_MAX_JERK}},   // acceleration limit reached, no cruise
+        {1.0f, {30.0f, MOTION_MAX_ACCELERATION, MOTION_MAX_JERK}},    // neither limit reached
+        {-50.0f, {20.0f, MOTION_MAX_ACCELERATION, 0}},                 // trapezoid, backwards
+        {90.0f, {60.0f, MOTION_MAX_ANGULAR_ACCELERATION, MOTION_MAX_ANGULAR_JERK}},
+    };
+
+    for (const auto& c : cases) {
+        MotionProfile profile;
+        TEST_ASSERT_TRUE(profile.plan(c.distance, c.limits));
+        float previous = 0;
+        for (float t = 0; t <= profile.getDuration(); t += 0.001f) {
+            MotionProfile::State state = profile.sample(t);
+            TEST_ASSERT_LESS_OR_EQUAL(c.limits.maxVelocity * 1.001f, fabsf(state.velocity));
+            TEST_ASSERT_LESS_OR_EQUAL(c.limits.maxAcceleration * 1.001f, fabsf(state.acceleration));
+            // Monotonic towards the target
+            TEST_ASSERT_TRUE((state.position - previous) * c.distance >= -1e-4f);
+            previous = state.position;
+        }
+        MotionProfile::State end = profile.sample(profile.getDuration());
+        TEST_ASSERT_FLOAT_WITHIN(1e-3f * fabsf(c.distance), c.distance, end.position);
+        TEST_ASSERT_FLOAT_WITHIN(1e-3f, 0.0f, end.velocity);
+    }
+}
+
+void test_zero_velocity_limit_is_no_profile() {
+    ProfileFollower follower(CONFIG);
+    TEST_ASSERT_FALSE(follower.start(10.0f, {0, MOTION_MAX_ACCELERATION, MOTION_MAX_JERK}, MOTION_DISTANCE_TOLERANCE));
+    TEST_ASSERT_TRUE(follower.isDone());
+    TEST_ASSERT_EQUAL_FLOAT(0.0f, follower.update(0, 0));
+}
+
+void test_drive_stops_on_target_despite_short_feedforward() {
+    // The wheels only reach 85% of each command; the profile alone would stop 15 cm short
+    MotionProfile::Limits limits = {30.0f, MOTION_MAX_ACCELERATION, MOTION_MAX_JERK};
+
+    ProfileFollower follower(CONFIG);
+    VelocityLoop loop;
+    loop.gain = 0.85f;
+    Move tracked = follow(follower, loop, 100.0f, limits, MOTION_DISTANCE_TOLERANCE);
+
+    ProfileFollower openLoop({0, CONFIG.catchUpMargin, CONFIG.settleTimeout});
+    VelocityLoop reference;
+    reference.gain = 0.85f;
+    Move untracked = follow(openLoop, reference, 100.0f, limits, MOTION_DISTANCE_TOLERANCE);
+
+    char message[160];
+    snprintf(message, sizeof(message), "100 cm at 85%% gain: endpoint %.3f cm, at rest %.3f cm in %.2f s (profile %.2f s); open loop %.2f cm",
+             tracked.endpointError, tracked.restError, tracked.duration, follower.getProfile().getDuration(), untracked.restError);
+    TEST_MESSAGE(message);
+    TEST_ASSERT_FLOAT_WITHIN(MOTION_DISTANCE_TOLERANCE, 0.0f, tracked.endpointError);
+    TEST_ASSERT_FLOAT_WITHIN(1.0f, 0.0f, tracked.restError);
+    TEST_ASSERT_LESS_THAN(follower.getProfile().getDuration() + 0.5f, tracked.duration);
+    TEST_ASSERT_LESS_OR_EQUAL(CONFIG.catchUpMargin * 30.0f + 1e-3f, tracked.peakCommand);
+    TEST_ASSERT_GREATER_OR_EQUAL(10.0f, untracked.restError);
+}
+
+void test_turn_stops_on_target_with_scrub() {
+    // Planned and tracked in radians like the sequence command; scrub leaves the turn at 80% of the wheel command
+    MotionProfile::Limits limits = {
+        60.0f * DEG_TO_RAD, MOTION_MAX_ANGULAR_ACCELERATION * DEG_TO_RAD, MOTION_MAX_ANGULAR_JERK * DEG_TO_RAD
+    };
+    ProfileFollower follower(CONFIG);
+    VelocityLoop loop;
+    loop.gain = 0.8f;
+    Move move = follow(follower, loop, 90.0f * DEG_TO_RAD, limits, MOTION_ANGLE_TOLERANCE * DEG_TO_RAD);
+
+    char message[128];
+    snprintf(message, sizeof(message), "90 deg at 80%% gain: endpoint %.3f deg, at rest %.3f deg in %.2f s",
+             move.endpointError * RAD_TO_DEG, move.restError * RAD_TO_DEG, move.duration);
+    TEST_MESSAGE(message);
+    TEST_ASSERT_FLOAT_WITHIN(MOTION_ANGLE_TOLERANCE, 0.0f, move.endpointError * RAD_TO_DEG);
+    TEST_ASSERT_FLOAT_WITHIN(2 * MOTION_ANGLE_TOLERANCE, 0.0f, move.restError * RAD_TO_DEG);
+}
+
+void test_stalled_wheels_finish_on_timeout() {
+    MotionProfile::Limits limits = {30.0f, MOTION_MAX_ACCELERATION, MOTION_MAX_JERK};
+    ProfileFollower follower(CONFIG);
+    VelocityLoop loop;
+    loop.stalled = true;
+    Move move = follow(follower, loop, 20.0f, limits, MOTION_DISTANCE_TOLERANCE);
+
+    float expected = follower.getProfile().getDuration() + CONFIG.settleTimeout;
+    TEST_ASSERT_FLOAT_WITHIN(2 * DT, expected, move.duration);
+    TEST_ASSERT_FLOAT_WITHIN(1e-3f, 20.0f, move.endpointError);
+    TEST_ASSERT_LESS_OR_EQUAL(CONFIG.catchUpMargin * follower.getProfile().getPeakVelocity() + 1e-3f, move.peakCommand);
+}
+
+int main(int argc, char** argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_profile_ends_on_distance_within_limits);
+    RUN_TEST(test_zero_velocity_limit_is_no_profile);
+    RUN_TEST(test_drive_stops_on_target_despite_short_feedforward);
+    RUN_TEST(test_turn_stops_on_target_with_scrub);
+    RUN_TEST(test_stalled_wheels_finish_on_timeout);
+    return UNITY_END();
+}
@@ -0,0 +1,117 @@
+#include <unity.h>
+#include <Arduino.h>
+#include "drive/MotorModelEstimator.h"
+
+// One wheel that is noticeably weaker in reverse, as gearboxes often are
+static constexpr float DT = 0.002f;
+static constexpr float TAU = 0.05f;
+
+static float forwardSpeed(float pwm) { return 0.5f * (pwm - 50) - 5e-4f * (pwm - 50) * (pwm - 50); }
+static float reverseSpeed(float pwm) { return 0.4f * (pwm - 60) - 4e-4f * (pwm - 60) * (pwm - 60); }
+
+static float steadyVelocity(float pwm) {
+    return pwm >= 0 ? forwardSpeed(pwm) : -reverseSpeed(-pwm);
+}
+
+struct Wheel {
+    float velocity = 0;
+    uint32_t noise = 1;
+
+    // First-order lag plus +/-0.02 cm/s of measurement noise, about what the edge-timed estimate shows
+    float step(float pwm) {
+        velocity += (steadyVelocity(pwm) - velocity) * DT / TAU;
+        noise = noise * 1664525u + 1013904223u;
+        return velocity + ((noise >> 8) / 16777216.0f - 0.5f) * 0.04f;
+    }
+};
+
+/**
+ * Alternates forward and reverse PWM holds so both directions see the same number of operating points
+ * The observer gets every tick, the way VelocityController feeds its estimators
+ */
+template<typename Fn>
+static void drive(int holds, Fn observe) {
+    Wheel wheel;
+    for (int h = 0; h < holds; h++) {
+        float magnitude = 70 + (h * 37) % 180;
+        float pwm = (h % 2) ? -magnitude : magnitude;
+        for (int i = 0; i < (int)(1.5f / DT); i++) {
+            observe(pwm, wheel.step(pwm));
+        }
+    }
+}
+
+void setUp() {}
+
+void tearDown() {}
+
+void test_each_direction_learns_its_own_curve() {
+    MotorModelEstimator forward(MotorMapping::LeftForward);
+    MotorModelEstimator reverse(MotorMapping::LeftReverse);
+    drive(150, [&](float pwm, float measured) {
+        forward.observe(pwm, measured, DT);
+        reverse.observe(pwm, measured, DT);
+    });
+
+    TEST_ASSERT_TRUE(forward.isConfident());
+    TEST_ASSERT_TRUE(reverse.isConfident());
+
+    float worstForward = 0;
+    float worstReverse = 0;
+    for (float pwm = 110; pwm <= 240; pwm += 10) {
+        worstForward = fmaxf(worstForward, fabsf(forward.pwmForVelocity(forwardSpeed(pwm)) - pwm));
+        worstReverse = fmaxf(worstReverse, fabsf(reverse.pwmForVelocity(reverseSpeed(pwm)) - pwm));
+    }
+
+    char message[96];
+    snprintf(message, sizeof(message), "worst PWM error: forward %.2f, reverse %.2f", worstForward, worstReverse);
+    TEST_MESSAGE(message);
+    TEST_ASSERT_LESS_THAN(3.0f, worstForward);
+    TEST_ASSERT_LESS_THAN(3.0f, worstReverse);
+
+    // The same speed costs more PWM in reverse
+    TEST_ASSERT_GREATER_OR_EQUAL(forward.pwmForVelocity(30.0f) + 10.0f, reverse.pwmForVelocity(30.0f));
+}
+
+void test_other_direction_never_samples() {
+    MotorModelEstimator forward(MotorMapping::RightForward);
+    Wheel wheel;
+    for (int i = 0; i < (int)(60.0f / DT); i++) {
+        forward.observe(-180.0f, wheel.step(-180.0f), DT);
+    }
+    TEST_ASSERT_EQUAL_UINT32(0, forward.getSampleCount());
+}
+
+void test_mixing_directions_biases_both() {
+    MotorModelEstimator forward(MotorMapping::LeftForward);
+    MotorModelEstimator reverse(MotorMapping::LeftReverse);
+    MotorModelEstimator mixed(MotorMapping::LeftForward);
+    drive(150, [&](float pwm, float measured) {
+        forward.observe(pwm, measured, DT);
+        reverse.observe(pwm, measured, DT);
+        // What the single estimator per wheel used to do: fit |pwm| -> |velocity| across both directions
+        mixed.observe(fabsf(pwm), fabsf(measured), DT);
+    });
+
+    float splitError = 0;
+    float mixedError = 0;
+    for (float pwm = 110; pwm <= 240; pwm += 10) {
+        splitError = fmaxf(splitError, fabsf(forward.pwmForVelocity(forwardSpeed(pwm)) - pwm));
+        splitError = fmaxf(splitError, fabsf(reverse.pwmForVelocity(reverseSpeed(pwm)) - pwm));
+        mixedError = fmaxf(mixedError, fabsf(mixed.pwmForVelocity(forwardSpeed(pwm)) - pwm));
+        mixedError = fmaxf(mixedError, fabsf(mixed.pwmForVelocity(reverseSpeed(pwm)) - pwm));
+    }
+
+    char message[96];
+    snprintf(message, sizeof(message), "worst PWM error: per direction %.2f, mixed %.2f", splitError, mixedError);
+    TEST_MESSAGE(message);
+    TEST_ASSERT_LESS_THAN(mixedError / 3, splitError);
+}
+
+int main(int argc, char** argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_each_direction_learns_its_own_curve);
+    RUN_TEST(test_other_direction_never_samples);
+    RUN_TEST(test_mixing_directions_biases_both);
+    return UNITY_END();
+}
@@ -0,0 +1,225 @@
+#include <unity.h>
+#include <chrono>
+#include "utils/PIDController.h"
+
+// First-order motor: PWM to cm/s with a 150 ms time constant, integrated at the 500 Hz control rate
+static constexpr float PLANT_GAIN = 0.4f;
+static constexpr float PLANT_TAU = 0.15f;
+static constexpr float DT = 0.002f;
+
+// PI zero on the plant pole: a first-order closed loop with a 75 ms time constant
+static constexpr float KP = 5.0f;
+static constexpr float KI = KP / PLANT_TAU;
+
+struct Motor {
+    float velocity = 0;
+
+    void step(float pwm, float dt) {
+        velocity += (PLANT_GAIN * pwm - velocity) * dt / PLANT_TAU;
+    }
+};
+
+struct StepResponse {
+    float overshoot;      // cm/s above the setpoint
+    float settlingTime;   // s, last time outside 2% of the setpoint
+    float finalError;     // cm/s
+};
+
+static StepResponse runStep(PIDController& pid, float setpoint, float duration) {
+    Motor motor;
+    StepResponse response = {0, 0, 0};
+    int steps = (int)(duration / DT);
+    for (int i = 0; i < steps; i++) {
+        float pwm = pid.compute(setpoint, motor.velocity, DT);
+        motor.step(pwm, DT);
+        response.overshoot = fmaxf(response.overshoot, motor.velocity - setpoint);
+        if (fabsf(motor.velocity - setpoint) > 0.02f * setpoint) {
+            response.settlingTime = (i + 1) * DT;
+        }
+    }
+    response.finalError = setpoint - motor.velocity;
+    return response;
+}
+
+void setUp() {
+    mock::setMicros(1000000);
+}
+
+void tearDown() {}
+
+void test_step_response_settles_without_overshoot() {
+    PIDController pid(KP, KI, 0.0f);
+    StepResponse response = runStep(pid, 30.0f, 2.0f);
+
+    TEST_ASSERT_FLOAT_WITHIN(0.05f, 0.0f, response.finalError);
+    TEST_ASSERT_LESS_THAN(0.02f * 30.0f, response.overshoot);
+    TEST_ASSERT_LESS_THAN(0.5f, response.settlingTime);
+}
+
+void test_saturated_step_recovers_without_windup() {
+    // 120 cm/s needs 300 PWM, so the output sits on its limit for the whole run
+    PIDController pid(KP, KI, 0.0f);
+    StepResponse saturated = runStep(pid, 120.0f, 2.0f);
+    TEST_ASSERT_FLOAT_WITHIN(0.5f, 120.0f - PLANT_GAIN * 255.0f, saturated.finalError);
+    TEST_ASSERT_LESS_OR_EQUAL(255.0f, pid.getIntegral());
+
+    // The integral stopped where the output saturated, so a reachable target settles promptly
+    Motor motor;
+    motor.velocity = PLANT_GAIN * 255.0f;
+    float settlingTime = 0;
+    for (int i = 0; i < 1000; i++) {
+        float pwm = pid.compute(30.0f, motor.velocity, DT);
+        motor.step(pwm, DT);
+        if (fabsf(motor.velocity - 30.0f) > 0.02f * 30.0f) settlingTime = (i + 1) * DT;
+    }
+    TEST_ASSERT_LESS_THAN(1.0f, settlingTime);
+}
+
+void test_integral_limits_are_error_seconds() {
+    // 50 cm/s needs 125 PWM from the integral, past the default +/-100 error x seconds only if read as PWM
+    PIDController pid(KP, KI, 0.0f);
+    StepResponse response = runStep(pid, 50.0f, 2.0f);
+    TEST_ASSERT_FLOAT_WITHIN(0.05f, 0.0f, response.finalError);
+    TEST_ASSERT_FLOAT_WITHIN(1.0f, 125.0f, pid.getIntegral());
+
+    // A limit of 2 error x seconds holds the integral term to 2 * ki PWM
+    pid.reset();
+    pid.setIntegralLimits(-2.0f, 2.0f);
+    runStep(pid, 50.0f, 2.0f);
+    TEST_ASSERT_FLOAT_WITHIN(1e-3f, 2.0f * KI, pid.getIntegral());
+}
+
+void test_integral_stops_when_feedforward_saturates_motor() {
+    // VelocityController adds the correction to the feedforward and clamps the sum to +/-255
+    PIDController pid(KP, KI, 0.0f);
+    Motor motor;
+    auto drive = [&](float target, float feedforward, int steps) {
+        for (int i = 0; i < steps; i++) {
+            pid.setOutputLimits(fmaxf(-100.0f, -255.0f - feedforward), fminf(100.0f, 255.0f - feedforward));
+            float correction = pid.compute(target, motor.velocity, DT);
+            motor.step(constrain(feedforward + correction, -255.0f, 255.0f), DT);
+        }
+    };
+
+    // The feedforward underestimates a 110 cm/s target that needs 275 PWM, so the motor stays pinned at 255
+    drive(110.0f, 230.0f, 1000);
+    TEST_ASSERT_FLOAT_WITHIN(0.5f, PLANT_GAIN * 255.0f, motor.velocity);
+    TEST_ASSERT_LESS_OR_EQUAL(25.0f, pid.getIntegral());
+
+    // With nothing wound up the next target settles on the feedforward's own time constant
+    float settlingTime = 0;
+    for (int i = 0; i < 1000; i++) {
+        drive(60.0f, 150.0f, 1);
+        if (fabsf(motor.velocity - 60.0f) > 0.02f * 60.0f) settlingTime = (i + 1) * DT;
+    }
+    TEST_ASSERT_LESS_THAN(0.5f, settlingTime);
+}
+
+void test_micros_dt_matches_caller_dt() {
+    PIDController timed(KP, KI, 0.05f);
+    PIDController explicitDt(KP, KI, 0.05f);
+    Motor motor;
+
+    for (int i = 0; i < 500; i++) {
+        mock::advanceMicros(2000);
+        float a = timed.compute(30.0f, motor.velocity);
+        float b = explicitDt.compute(30.0f, motor.velocity, i == 0 ? 0.0f : DT);
+        TEST_ASSERT_FLOAT_WITHIN(1e-3f, b, a);
+        motor.step(a, DT);
+    }
+}
+
+void test_gap_longer_than_max_dt_restarts() {
+    PIDController pid(1.0f, 10.0f, 0.5f);
+    pid.compute(10.0f, 0.0f, DT);
+    pid.compute(10.0f, 0.0f, DT);
+    float integral = pid.getIntegral();
+
+    // A 5 s gap must neither integrate 5 s of error nor differentiate across it
+    float output = pid.compute(10.0f, 8.0f, 5.0f);
+    TEST_ASSERT_FLOAT_WITHIN(1e-6f, integral, pid.getIntegral());
+    TEST_ASSERT_FLOAT_WITHIN(1e-4f, 1.0f * 2.0f + integral, output);
+}
+
+void test_setpoint_step_does_not_kick_derivative() {
+    PIDController pid(1.0f, 0.0f, 2.0f);
+    pid.compute(0.0f, 5.0f, DT);
+    pid.compute(0.0f, 5.0f, DT);
+
+    // Only the proportional term sees a setpoint jump when the measurement holds still
+    float output = pid.compute(40.0f, 5.0f, DT);
+    TEST_ASSERT_FLOAT_WITHIN(1e-4f, 35.0f, output);
+}
+
+void test_measurement_derivative_is_filtered() {
+    PIDController pid(0.0f, 0.0f, 1.0f);
+    pid.setDerivativeFilter(0.01f);
+    pid.compute(0.0f, 0.0f, DT);
+
+    // A 1 cm/s jump in one tick is 500 cm/s^2 raw; the first-order filter passes dt / (tau + dt) of it
+    float output = pid.compute(0.0f, 1.0f, DT);
+    float alpha = DT / (0.01f + DT);
+    TEST_ASSERT_FLOAT_WITHIN(1e-3f, -alpha * 500.0f, output);
+
+    // and decays once the measurement stops moving
+    float previous = fabsf(output);
+    for (int i = 0; i < 10; i++) {
+        float next = fabsf(pid.compute(0.0f, 1.0f, DT));
+        TEST_ASSERT_LESS_THAN(previous, next);
+        previous = next;
+    }
+}
+
+void test_gain_change_is_bumpless() {
+    PIDController pid(KP, KI, 0.05f);
+    Motor motor;
+    for (int i = 0; i < 1000; i++) {
+        motor.step(pid.compute(30.0f, motor.velocity, DT), DT);
+    }
+
+    // Hold the plant off its setpoint so P carries real weight and D has settled, then retune
+    motor.velocity -= 5.0f;
+    float before = 0;
+    for (int i = 0; i < 50; i++) {
+        before = pid.compute(30.0f, motor.velocity, DT);
+    }
+    pid.setGains(3 * KP, KI, 0.05f);
+    float after = pid.compute(30.0f, motor.velocity, DT);
+    TEST_ASSERT_FLOAT_WITHIN(KI * 5.0f * DT + 0.01f, before, after);
+}
+
+void test_compute_benchmark() {
+    PIDController pid(KP, KI, 0.05f);
+    const int iterations = 1000000;
+    volatile float sink = 0;
+    float measurement = 0;
+
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; i++) {
+        measurement += 0.001f;
+        sink = pid.compute(30.0f, measurement, DT);
+    }
+    auto elapsed = std::chrono::steady_clock::now() - start;
+    (void)sink;
+
+    double ns = std::chrono::duration<double, std::nano>(elapsed).count() / iterations;
+    char message[64];
+    snprintf(message, sizeof(message), "compute(): %.1f ns per call", ns);
+    TEST_MESSAGE(message);
+    TEST_ASSERT_LESS_THAN(1000.0, ns);
+}
+
+int main(int argc, char** argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_step_response_settles_without_overshoot);
+    RUN_TEST(test_saturated_step_recovers_without_windup);
+    RUN_TEST(test_integral_limits_are_error_seconds);
+    RUN_TEST(test_integral_stops_when_feedforward_saturates_motor);
+    RUN_TEST(test_micros_dt_matches_caller_dt);
+    RUN_TEST(test_gap_longer_than_max_dt_restarts);
+    RUN_TEST(test_setpoint_step_does_not_kick_derivative);
+    RUN_TEST(test_measurement_derivative_is_filtered);
+    RUN_TEST(test_gain_change_is_bumpless);
+    RUN_TEST(test_compute_benchmark);
+    return UNITY_END();
+}
@@ -0,0 +1,142 @@
+#include <unity.h>
+#include <Arduino.h>
+#include "utils/PolynomialFit.h"
+
+// Calibration-shaped data: PWM steps over the driven range against cm/s, or the reverse
+static constexpr int N = 40;
+static float pwm[N];
+static float velocity[N];
+
+static uint32_t noiseState;
+
+// Uniform in [-amplitude, amplitude], reproducible per test
+static float noise(float amplitude) {
+    noiseState = noiseState * 1664525u + 1013904223u;
+    return ((noiseState >> 8) / 16777216.0f * 2.0f - 1.0f) * amplitude;
+}
+
+static void sample(const float* coeffs, int degree, float noiseAmplitude) {
+    Polynomial truth(coeffs, degree);
+    for (int i = 0; i < N; i++) {
+        pwm[i] = 60.0f + i * 5.0f;
+        velocity[i] = truth.evaluate(pwm[i]) + noise(noiseAmplitude);
+    }
+}
+
+static float maxDeviation(const PolynomialFit::Result& result, const float* coeffs, int degree) {
+    Polynomial fitted(result.coefficients, result.degree);
+    Polynomial truth(coeffs, degree);
+    float worst = 0;
+    for (float x = 60.0f; x <= 255.0f; x += 0.5f) {
+        worst = fmaxf(worst, fabsf(fitted.evaluate(x) - truth.evaluate(x)));
+    }
+    return worst;
+}
+
+void setUp() {
+    noiseState = 2024;
+}
+
+void tearDown() {}
+
+void test_exact_cubic_recovers_coefficients() {
+    const float cubic[] = {-25.0f, 0.55f, -1.2e-3f, 1.5e-6f};
+    sample(cubic, 3, 0);
+    PolynomialFit::Result result = PolynomialFit::fit(pwm, velocity, N, 3);
+
+    TEST_ASSERT_TRUE(result.ok);
+    TEST_ASSERT_EQUAL_INT(3, result.degree);
+    TEST_ASSERT_EQUAL_INT(N, result.points);
+    for (int i = 0; i <= 3; i++) {
+        TEST_ASSERT_FLOAT_WITHIN(fabsf(cubic[i]) * 1e-3f, cubic[i], result.coefficients[i]);
+    }
+    TEST_ASSERT_LESS_THAN(1e-3f, result.rmsResidual);
+    TEST_ASSERT_FLOAT_WITHIN(1e-6f, 1.0f, result.rSquared);
+}
+
+void test_exact_quintic_is_well_conditioned() {
+    // Raw x^5 reaches 1e12 at full PWM; the scaled normal equations must still reproduce the curve
+    const float quintic[] = {-30.0f, 0.9f, -6e-3f, 3e-5f, -7e-8f, 6e-11f};
+    sample(quintic, 5, 0);
+    PolynomialFit::Result result = PolynomialFit::fit(pwm, velocity, N, 5);
+
+    TEST_ASSERT_TRUE(result.ok);
+    float deviation = maxDeviation(result, quintic, 5);
+    char message[64];
+    snprintf(message, sizeof(message), "quintic: max deviation %.5f cm/s", deviation);
+    TEST_MESSAGE(message);
+    TEST_ASSERT_LESS_THAN(0.01f, deviation);
+}
+
+void test_noisy_line_matches_closed_form() {
+    const float line[] = {-20.0f, 0.4f};
+    sample(line, 1, 1.0f);
+    PolynomialFit::Result result = PolynomialFit::fit(pwm, velocity, N, 1);
+
+    double meanX = 0;
+    double meanY = 0;
+    for (int i = 0; i < N; i++) {
+        meanX += pwm[i];
+        meanY += velocity[i];
+    }
+    meanX /= N;
+    meanY /= N;
+    double sxy = 0;
+    double sxx = 0;
+    for (int i = 0; i < N; i++) {
+        sxy += (pwm[i] - meanX) * (velocity[i] - meanY);
+        sxx += (pwm[i] - meanX) * (pwm[i] - meanX);
+    }
+    double slope = sxy / sxx;
+
+    TEST_ASSERT_TRUE(result.ok);
+    TEST_ASSERT_FLOAT_WITHIN(1e-5f, (float)slope, result.coefficients[1]);
+    TEST_ASSERT_FLOAT_WITHIN(1e-3f, (float)(meanY - slope * meanX), result.coefficients[0]);
+    TEST_ASSERT_LESS_THAN(1.5f, result.maxResidual);
+    TEST_ASSERT_GREATER_OR_EQUAL(result.rmsResidual, result.maxResidual);
+}
+
+void test_auto_degree_picks_the_generating_degree() {
+    const float line[] = {-20.0f, 0.4f};
+    sample(line, 1, 0.5f);
+    TEST_ASSERT_EQUAL_INT(1, PolynomialFit::fit(pwm, velocity, N, 0).degree);
+
+    const float quadratic[] = {-25.0f, 0.5f, -5e-4f};
+    sample(quadratic, 2, 0.3f);
+    TEST_ASSERT_EQUAL_INT(2, PolynomialFit::fit(pwm, velocity, N, 0).degree);
+
+    const float cubic[] = {-25.0f, 0.55f, -1.2e-3f, 1.5e-6f};
+    sample(cubic, 3, 0.1f);
+    PolynomialFit::Result result = PolynomialFit::fit(pwm, velocity, N, 0);
+    TEST_ASSERT_EQUAL_INT(3, result.degree);
+    TEST_ASSERT_LESS_THAN(0.1f, maxDeviation(result, cubic, 3));
+}
+
+void test_degree_is_capped() {
+    const float quadratic[] = {-25.0f, 0.5f, -5e-4f};
+    sample(quadratic, 2, 0);
+    TEST_ASSERT_EQUAL_INT(4, PolynomialFit::fit(pwm, velocity, N, 6, 4).degree);
+    TEST_ASSERT_EQUAL_INT(Polynomial::MAX_DEGREE, PolynomialFit::fit(pwm, velocity, N, 9, 9).degree);
+}
+
+void test_degenerate_inputs_fail() {
+    const float x[] = {100, 100, 100, 100, 100};
+    const float y[] = {10, 11, 12, 13, 14};
+    TEST_ASSERT_FALSE(PolynomialFit::fit(x, y, 5, 2).ok);
+
+    const float fewX[] = {80, 120, 160};
+    const float fewY[] = {10, 20, 28};
+    TEST_ASSERT_FALSE(PolynomialFit::fit(fewX, fewY, 3, 3).ok);
+    TEST_ASSERT_TRUE(PolynomialFit::fit(fewX, fewY, 3, 2).ok);
+}
+
+int main(int argc, char** argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_exact_cubic_recovers_coefficients);
+    RUN_TEST(test_exact_quintic_is_well_conditioned);
+    RUN_TEST(test_noisy_line_matches_closed_form);
+    RUN_TEST(test_auto_degree_picks_the_generating_degree);
+    RUN_TEST(test_degree_is_capped);
+    RUN_TEST(test_degenerate_inputs_fail);
+    return UNITY_END();
+}
@@ -0,0 +1,206 @@
+#include <unity.h>
+#include <Arduino.h>
+#include "config.h"
+#include "drive/PoseEstimator.h"
+
+static constexpr float DT = POSE_UPDATE_MS * 1e-3f;
+static constexpr float COUNT_CM = PI * WHEEL_DIAMETER / ENCODER_PPR;
+
+static const PoseEstimator::Config CONFIG = {
+    TRACK_WIDTH, POSE_TRACK_WIDTH_UNCERTAINTY, POSE_WHEEL_NOISE, COUNT_CM,
+    POSE_GYRO_NOISE, POSE_GYRO_BIAS_DRIFT, POSE_GYRO_BIAS_SIGMA, POSE_YAW_GATE
+};
+
+/**
+ * Car driven at the pose update rate: true pose integrated finely, encoders quantised to counts,
+ * gyro with a bias and white noise. Slip adds distance to one encoder without moving the car.
+ */
+struct Car {
+    double x = 0, y = 0, theta = 0;
+    double leftDistance = 0, rightDistance = 0;
+    float gyroBias = 0;
+    float gyroNoise = 0.002f;  // rad/s per sample, uniform
+    uint32_t noiseState = 11;
+    float gyroRate = 0;
+
+    void tick(float vl, float vr, float leftSlip = 0) {
+        const int substeps = 20;
+        double h = DT / substeps;
+        for (int i = 0; i < substeps; i++) {
+            double w = (vr - vl) / TRACK_WIDTH;
+            double v = 0.5 * (vl + vr);
+            x += v * cos(theta + 0.5 * w * h) * h;
+            y += v * sin(theta + 0.5 * w * h) * h;
+            theta += w * h;
+        }
+        leftDistance += vl * DT + leftSlip;
+        rightDistance += vr * DT;
+
+        noiseState = noiseState * 1664525u + 1013904223u;
+        float noise = ((noiseState >> 8) / 16777216.0f * 2.0f - 1.0f) * gyroNoise;
+        gyroRate = (vr - vl) / TRACK_WIDTH + gyroBias + noise;
+    }
+
+    float leftCounts() const { return floor(leftDistance / COUNT_CM) * COUNT_CM; }
+    float rightCounts() const { return floor(rightDistance / COUNT_CM) * COUNT_CM; }
+
+    void feed(PoseEstimator& estimator) const {
+        estimator.update(leftCounts(), rightCounts(), gyroRate, DT);
+    }
+};
+
+static double headingError(const PoseEstimate& estimate, const Car& car) {
+    double e = estimate.pose.theta - car.theta;
+    return atan2(sin(e), cos(e));
+}
+
+// Gentle S-curves at 25 cm/s, so the encoders and the gyro both see real turning
+static void driveSCurves(int tick, float& vl, float& vr) {
+    float w = 0.5f * sinf(2 * PI * tick * DT / 8.0f);
+    vl = 25.0f - w * TRACK_WIDTH / 2;
+    vr = 25.0f + w * TRACK_WIDTH / 2;
+}
+
+void setUp() {}
+
+void tearDown() {}
+
+void test_odometry_only_follows_the_wheels() {
+    PoseEstimator estimator(CONFIG);
+    Car car;
+    estimator.updateOdometryOnly(0, 0, DT);
+    for (int i = 0; i < 1000; i++) {
+        float vl, vr;
+        driveSCurves(i, vl, vr);
+        car.tick(vl, vr);
+        estimator.updateOdometryOnly(car.leftCounts(), car.rightCounts(), DT);
+    }
+    PoseEstimate estimate = estimator.getState();
+    TEST_ASSERT_FALSE(estimate.gyroActive);
+    TEST_ASSERT_FLOAT_WITHIN(0.5f, car.x, estimate.pose.x);
+    TEST_ASSERT_FLOAT_WITHIN(0.5f, car.y, estimate.pose.y);
+    TEST_ASSERT_FLOAT_WITHIN(0.01f, 0.0f, headingError(estimate, car));
+    TEST_ASSERT_EQUAL_FLOAT(0.0f, estimate.gyroBias);
+}
+
+void test_learns_constant_gyro_bias() {
+    // 0.01 rad/s is 34 degrees a minute if the gyro were integrated on its own
+    PoseEstimator estimator(CONFIG);
+    Car car;
+    car.gyroBias = 0.01f;
+    car.feed(estimator);
+    for (int i = 0; i < 6000; i++) {
+        float vl, vr;
+        driveSCurves(i, vl, vr);
+        car.tick(vl, vr);
+        car.feed(estimator);
+    }
+    PoseEstimate estimate = estimator.getState();
+
+    char message[128];
+    snprintf(message, sizeof(message), "60 s, bias 0.0100 rad/s: estimated %.4f rad/s, heading error %.4f rad, sigma %.4f rad",
+             estimate.gyroBias, headingError(estimate, car), sqrtf(estimate.variance[2]));
+    TEST_MESSAGE(message);
+    TEST_ASSERT_TRUE(estimate.gyroActive);
+    TEST_ASSERT_FLOAT_WITHIN(0.002f, 0.01f, estimate.gyroBias);
+    TEST_ASSERT_FLOAT_WITHIN(0.02f, 0.0f, headingError(estimate, car));
+    TEST_ASSERT_EQUAL_UINT32(0, estimate.slipEvents);
+    TEST_ASSERT_LESS_THAN(POSE_GYRO_BIAS_SIGMA * POSE_GYRO_BIAS_SIGMA / 25, estimate.variance[3]);
+}
+
+void test_heading_holds_while_gyro_bias_drifts() {
+    // The bias wanders from -0.01 to 0.01 rad/s over two minutes, as it does while the sensor warms up.
+    // POSE_GYRO_BIAS_DRIFT lets the estimate follow only slowly; the encoder yaw keeps the heading meanwhile
+    PoseEstimator estimator(CONFIG);
+    Car car;
+    car.gyroBias = -0.01f;
+    car.feed(estimator);
+    float worstHeadingError = 0;
+    float worstBiasError = 0;
+    for (int i = 0; i < 12000; i++) {
+        car.gyroBias = -0.01f + 0.02f * i / 12000;
+        float vl, vr;
+        driveSCurves(i, vl, vr);
+        car.tick(vl, vr);
+        car.feed(estimator);
+        PoseEstimate estimate = estimator.getState();
+        worstHeadingError = fmaxf(worstHeadingError, fabsf(headingError(estimate, car)));
+        if (i >= 3000) worstBiasError = fmaxf(worstBiasError, fabsf(estimate.gyroBias - car.gyroBias));
+    }
+    PoseEstimate estimate = estimator.getState();
+
+    char message[128];
+    snprintf(message, sizeof(message), "drifting bias: worst heading error %.4f rad, bias lag up to %.4f rad/s, final %.4f vs %.4f",
+             worstHeadingError, worstBiasError, estimate.gyroBias, car.gyroBias);
+    TEST_MESSAGE(message);
+    TEST_ASSERT_LESS_THAN(0.05f, worstHeadingError);
+    TEST_ASSERT_LESS_THAN(0.01f, worstBiasError);
+    TEST_ASSERT_GREATER_OR_EQUAL(0.0f, estimate.gyroBias);
+}
+
+void test_rejects_wheel_slip() {
+    // Driving straight, the left wheel spins 4 cm in 100 ms without moving the car
+    PoseEstimator withGyro(CONFIG);
+    PoseEstimator odometryOnly(CONFIG);
+    Car car;
+    car.gyroBias = 0.002f;
+    car.feed(withGyro);
+    odometryOnly.updateOdometryOnly(0, 0, DT);
+
+    // Long enough first to pin the bias down
+    float positionVariance = 0;
+    for (int i = 0; i < 3000; i++) {
+        float slip = (i >= 2000 && i < 2010) ? 0.4f : 0.0f;
+        car.tick(20.0f, 20.0f, slip);
+        car.feed(withGyro);
+        odometryOnly.updateOdometryOnly(car.leftCounts(), car.rightCounts(), DT);
+        if (i == 1999) positionVariance = withGyro.getState().variance[0] + withGyro.getState().variance[1];
+    }
+    PoseEstimate fused = withGyro.getState();
+    PoseEstimate encoders = odometryOnly.getState();
+
+    char message[160];
+    snprintf(message, sizeof(message), "4 cm slip: heading error fused %.4f rad (%u slips), odometry only %.4f rad; lateral error %.2f vs %.2f cm",
+             headingError(fused, car), (unsigned)fused.slipEvents, headingError(encoders, car), fused.pose.y - car.y, encoders.pose.y - car.y);
+    TEST_MESSAGE(message);
+    TEST_ASSERT_GREATER_OR_EQUAL(1, (int)fused.slipEvents);
+    TEST_ASSERT_FLOAT_WITHIN(0.01f, 0.0f, headingError(fused, car));
+    TEST_ASSERT_GREATER_OR_EQUAL(0.25f, fabsf(headingError(encoders, car)));
+    TEST_ASSERT_LESS_THAN(fabsf(encoders.pose.y - car.y) / 10, fabsf(fused.pose.y - car.y));
+    TEST_ASSERT_FLOAT_WITHIN(0.002f, car.gyroBias, fused.gyroBias);
+
+    // The slipped distance is reflected in the position uncertainty
+    float afterSlip = fused.variance[0] + fused.variance[1];
+    TEST_ASSERT_GREATER_OR_EQUAL(positionVariance + 1.0f, afterSlip);
+}
+
+void test_reset_keeps_the_bias() {
+    PoseEstimator estimator(CONFIG);
+    Car car;
+    car.gyroBias = 0.01f;
+    car.feed(estimator);
+    for (int i = 0; i < 3000; i++) {
+        float vl, vr;
+        driveSCurves(i, vl, vr);
+        car.tick(vl, vr);
+        car.feed(estimator);
+    }
+    float bias = estimator.getState().gyroBias;
+
+    estimator.requestReset();
+    car.feed(estimator);
+    PoseEstimate estimate = estimator.getState();
+    TEST_ASSERT_FLOAT_WITHIN(1e-3f, 0.0f, estimate.pose.x);
+    TEST_ASSERT_FLOAT_WITHIN(1e-3f, 0.0f, estimate.pose.y);
+    TEST_ASSERT_FLOAT_WITHIN(5e-4f, bias, estimate.gyroBias);
+}
+
+int main(int argc, char** argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_odometry_only_follows_the_wheels);
+    RUN_TEST(test_learns_constant_gyro_bias);
+    RUN_TEST(test_heading_holds_while_gyro_bias_drifts);
+    RUN_TEST(test_rejects_wheel_slip);
+    RUN_TEST(test_reset_keeps_the_bias);
+    return UNITY_END();
+}
@@ -0,0 +1,183 @@
+#include <unity.h>
+#include <Arduino.h>
+#include "utils/RelayAutoTuner.h"
+#include "utils/PIDController.h"
+
+// Motor as first order plus dead time: PWM to cm/s, 150 ms lag, 20 ms of transport and filtering delay
+static constexpr float DT = 0.002f;
+static constexpr float PLANT_GAIN = 0.4f;
+static constexpr float PLANT_TAU = 0.15f;
+static constexpr int DELAY_TICKS = 10;
+static constexpr float PLANT_DELAY = DELAY_TICKS * DT;
+// The relay sees the output one tick after the plant moves, so the loop carries one more tick of dead time
+static constexpr float LOOP_DELAY = PLANT_DELAY + DT;
+
+static constexpr float BIAS_PWM = 100.0f;
+static constexpr float RELAY_PWM = 40.0f;
+
+struct Plant {
+    float velocity = PLANT_GAIN * BIAS_PWM;
+    float pending[DELAY_TICKS];
+    int head = 0;
+    uint32_t noiseState = 99;
+    float noiseAmplitude = 0;
+
+    Plant() {
+        for (float& pwm : pending) pwm = BIAS_PWM;
+    }
+
+    // Returns the measured velocity after one tick
+    float step(float pwm) {
+        float delayed = pending[head];
+        pending[head] = pwm;
+        head = (head + 1) % DELAY_TICKS;
+        velocity += (PLANT_GAIN * delayed - velocity) * DT / PLANT_TAU;
+        noiseState = noiseState * 1664525u + 1013904223u;
+        return velocity + ((noiseState >> 8) / 16777216.0f * 2.0f - 1.0f) * noiseAmplitude;
+    }
+};
+
+static RelayAutoTuner::Result runExperiment(Plant& plant, float hysteresis, int cycles, int settleCycles) {
+    RelayAutoTuner tuner;
+    tuner.begin({PLANT_GAIN * BIAS_PWM, RELAY_PWM, hysteresis, cycles, settleCycles});
+    float measured = plant.velocity;
+    for (int i = 0; i < 20000 && !tuner.isFinished(); i++) {
+        measured = plant.step(BIAS_PWM + tuner.update(measured, DT));
+    }
+    TEST_ASSERT_TRUE(tuner.isFinished());
+    return tuner.getResult();
+}
+
+// Ultimate frequency of K e^(-Ls) / (tau s + 1): phase lag atan(w tau) + w L reaches pi
+static void analyticUltimate(float& ku, float& tu) {
+    double lo = 0;
+    double hi = M_PI / LOOP_DELAY;
+    for (int i = 0; i < 100; i++) {
+        double w = (lo + hi) / 2;
+        if (atan(w * PLANT_TAU) + w * LOOP_DELAY < M_PI) lo = w; else hi = w;
+    }
+    ku = sqrt(1 + lo * PLANT_TAU * lo * PLANT_TAU) / PLANT_GAIN;
+    tu = 2 * M_PI / lo;
+}
+
+void setUp() {}
+
+void tearDown() {}
+
+void test_limit_cycle_matches_exact_relay_oscillation() {
+    // For first order plus dead time under an ideal relay the cycle is known in closed form
+    Plant plant;
+    RelayAutoTuner::Result result = runExperiment(plant, 0, 6, 2);
+    float expectedAmplitude = PLANT_GAIN * RELAY_PWM * (1 - expf(-LOOP_DELAY / PLANT_TAU));
+    float expectedPeriod = 2 * LOOP_DELAY + 2 * PLANT_TAU * logf(2 - expf(-LOOP_DELAY / PLANT_TAU));
+
+    char message[128];
+    snprintf(message, sizeof(message), "period %.4f s (exact %.4f), amplitude %.3f cm/s (exact %.3f), spread %.3f",
+             result.ultimatePeriod, expectedPeriod, result.oscillationAmplitude, expectedAmplitude, result.periodSpread);
+    TEST_MESSAGE(message);
+
+    TEST_ASSERT_TRUE(result.ok);
+    TEST_ASSERT_FLOAT_WITHIN(0.05f * expectedPeriod, expectedPeriod, result.ultimatePeriod);
+    TEST_ASSERT_FLOAT_WITHIN(0.05f * expectedAmplitude, expectedAmplitude, result.oscillationAmplitude);
+    TEST_ASSERT_LESS_THAN(0.05f, result.periodSpread);
+}
+
+void test_ultimate_point_close_to_analytic() {
+    // The describing function ignores the harmonics of the square wave and reads Ku low; for this delay ratio by under 25%
+    Plant plant;
+    RelayAutoTuner::Result result = runExperiment(plant, 0, 6, 2);
+    float ku;
+    float tu;
+    analyticUltimate(ku, tu);
+
+    char message[96];
+    snprintf(message, sizeof(message), "Ku %.2f (analytic %.2f), Tu %.4f s (analytic %.4f)", result.ultimateGain, ku, result.ultimatePeriod, tu);
+    TEST_MESSAGE(message);
+    TEST_ASSERT_LESS_THAN(ku, result.ultimateGain);
+    TEST_ASSERT_FLOAT_WITHIN(0.25f * ku, ku, result.ultimateGain);
+    TEST_ASSERT_FLOAT_WITHIN(0.1f * tu, tu, result.ultimatePeriod);
+}
+
+void test_hysteresis_rides_out_measurement_noise() {
+    // 0.3 cm/s of noise chatters an ideal relay; a band just above it keeps the cycle clean
+    Plant noisy;
+    noisy.noiseAmplitude = 0.3f;
+    RelayAutoTuner::Result result = runExperiment(noisy, 0.4f, 8, 2);
+    TEST_ASSERT_TRUE(result.ok);
+    TEST_ASSERT_GREATER_OR_EQUAL(0.4f, result.oscillationAmplitude);
+
+    Plant clean;
+    RelayAutoTuner::Result reference = runExperiment(clean, 0.4f, 8, 2);
+    TEST_ASSERT_FLOAT_WITHIN(0.1f * reference.ultimateGain, reference.ultimateGain, result.ultimateGain);
+}
+
+struct LoopResponse {
+    float overshoot;  // cm/s above the target
+    float lateError;  // worst error over the last second, cm/s
+};
+
+// Correction on top of a feedforward that is 20% short, clamped as VelocityController runs it
+static LoopResponse closeLoop(RelayAutoTuner::Rule rule, const RelayAutoTuner::Result& result, float target) {
+    float kp, ki, kd;
+    RelayAutoTuner::computeGains(rule, result.ultimateGain, result.ultimatePeriod, kp, ki, kd);
+    PIDController pid(kp, ki, kd);
+
+    Plant loop;
+    float feedforward = 0.8f * target / PLANT_GAIN;
+    float measured = loop.velocity;
+    LoopResponse response = {0, 0};
+    const int steps = (int)(4.0f / DT);
+    for (int i = 0; i < steps; i++) {
+        pid.setOutputLimits(fmaxf(-100.0f, -255.0f - feedforward), fminf(100.0f, 255.0f - feedforward));
+        float correction = pid.compute(target, measured, DT);
+        measured = loop.step(constrain(feedforward + correction, -255.0f, 255.0f));
+        response.overshoot = fmaxf(response.overshoot, measured - target);
+        if (i >= steps - (int)(1.0f / DT)) response.lateError = fmaxf(response.lateError, fabsf(target - measured));
+    }
+
+    char message[128];
+    snprintf(message, sizeof(message), "%s: kp %.2f ki %.1f kd %.3f, overshoot %.1f%%, late error %.3f cm/s",
+             RelayAutoTuner::ruleName(rule), kp, ki, kd, 100 * response.overshoot / target, response.lateError);
+    TEST_MESSAGE(message);
+    return response;
+}
+
+void test_every_rule_settles() {
+    Plant plant;
+    RelayAutoTuner::Result result = runExperiment(plant, 0, 6, 2);
+
+    const RelayAutoTuner::Rule rules[] = {
+        RelayAutoTuner::Rule::ZieglerNichols, RelayAutoTuner::Rule::ZieglerNicholsPI,
+        RelayAutoTuner::Rule::TyreusLuyben, RelayAutoTuner::Rule::PessenIntegral,
+        RelayAutoTuner::Rule::SomeOvershoot, RelayAutoTuner::Rule::NoOvershoot
+    };
+
+    for (RelayAutoTuner::Rule rule : rules) {
+        LoopResponse response = closeLoop(rule, result, 60.0f);
+        TEST_ASSERT_LESS_THAN(0.01f * 60.0f, response.lateError);
+        TEST_ASSERT_LESS_THAN(0.2f * 60.0f, response.overshoot);
+    }
+}
+
+void test_too_few_cycles_is_not_a_result() {
+    RelayAutoTuner tuner;
+    tuner.begin({40.0f, RELAY_PWM, 0, 4, 2});
+    Plant plant;
+    float measured = plant.velocity;
+    // Long enough for the settle cycles but not the averaged ones
+    for (int i = 0; i < 120; i++) {
+        measured = plant.step(BIAS_PWM + tuner.update(measured, DT));
+    }
+    TEST_ASSERT_FALSE(tuner.isFinished());
+    TEST_ASSERT_FALSE(tuner.getResult().ok);
+}
+
+int main(int argc, char** argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_limit_cycle_matches_exact_relay_oscillation);
+    RUN_TEST(test_ultimate_point_close_to_analytic);
+    RUN_TEST(test_hysteresis_rides_out_measurement_noise);
+    RUN_TEST(test_every_rule_settles);
+    RUN_TEST(test_too_few_cycles_is_not_a_result);
+    return UNITY_END();
+}
@@ -0,0 +1,105 @@
+#include <unity.h>
+#include <atomic>
+#include <thread>
+#include <vector>
+#include "drive/SetpointMailbox.h"
+
+// Every field of a publish is derived from (producer, k), so a torn copy cannot satisfy all of them at once
+static constexpr int PRODUCERS = 3;
+static constexpr uint32_t PUBLISHES_PER_PRODUCER = 200000;
+
+static uint32_t stamp(int producer, uint32_t k) { return ((uint32_t)producer << 24) | k; }
+
+void setUp() {}
+
+void tearDown() {}
+
+void test_empty_mailbox_reads_idle() {
+    SetpointMailbox mailbox;
+    Setpoint setpoint = mailbox.read();
+    TEST_ASSERT_EQUAL_UINT32(0, setpoint.seq);
+    TEST_ASSERT_TRUE(setpoint.mode == Setpoint::Mode::Idle);
+}
+
+void test_latest_publish_wins() {
+    SetpointMailbox mailbox;
+    mailbox.publish(Setpoint::Mode::Velocity, 10, 12, 100);
+    uint32_t seq = mailbox.publish(Setpoint::Mode::Power, 0.5f, -0.5f, 200);
+    Setpoint setpoint = mailbox.read();
+    TEST_ASSERT_EQUAL_UINT32(seq, setpoint.seq);
+    TEST_ASSERT_TRUE(setpoint.mode == Setpoint::Mode::Power);
+    TEST_ASSERT_EQUAL_FLOAT(0.5f, setpoint.left);
+    TEST_ASSERT_EQUAL_FLOAT(-0.5f, setpoint.right);
+    TEST_ASSERT_EQUAL_UINT32(200, setpoint.timestampUs);
+}
+
+void test_concurrent_producers_never_tear_a_read() {
+    SetpointMailbox mailbox;
+    std::atomic<bool> done(false);
+    std::atomic<int> ready(0);
+
+    std::vector<std::thread> producers;
+    for (int p = 0; p < PRODUCERS; p++) {
+        producers.emplace_back([&mailbox, &ready, p] {
+            ready++;
+            while (ready.load() < PRODUCERS + 1) {}
+            Setpoint::Mode mode = p % 2 ? Setpoint::Mode::Power : Setpoint::Mode::Velocity;
+            for (uint32_t k = 1; k <= PUBLISHES_PER_PRODUCER; k++) {
+                mailbox.publish(mode, (float)k, -(float)k, stamp(p, k));
+            }
+        });
+    }
+
+    // The control loop side: every read must be one whole publish, and never older than the previous read
+    uint32_t reads = 0;
+    uint32_t torn = 0;
+    uint32_t backwards = 0;
+    uint32_t lastSeq = 0;
+    uint32_t lastK[PRODUCERS] = {};
+    ready++;
+    while (ready.load() < PRODUCERS + 1) {}
+
+    std::thread reader([&] {
+        while (!done.load()) {
+            Setpoint setpoint = mailbox.read();
+            reads++;
+            if (setpoint.seq == 0) continue;
+
+            int producer = setpoint.timestampUs >> 24;
+            uint32_t k = setpoint.timestampUs & 0xFFFFFF;
+            Setpoint::Mode mode = producer % 2 ? Setpoint::Mode::Power : Setpoint::Mode::Velocity;
+            if (producer >= PRODUCERS || setpoint.left != (float)k || setpoint.right != -(float)k || setpoint.mode != mode) {
+                torn++;
+                continue;
+            }
+            if (setpoint.seq < lastSeq || k < lastK[producer]) backwards++;
+            lastSeq = setpoint.seq;
+            lastK[producer] = k;
+        }
+    });
+
+    for (std::thread& producer : producers) {
+        producer.join();
+    }
+    done = true;
+    reader.join();
+
+    char message[96];
+    snprintf(message, sizeof(message), "%u reads against %u publishes", reads, PRODUCERS * PUBLISHES_PER_PRODUCER);
+    TEST_MESSAGE(message);
+    TEST_ASSERT_EQUAL_UINT32(0, torn);
+    TEST_ASSERT_EQUAL_UINT32(0, backwards);
+
+    // Once everyone is done the mailbox holds the publish with the highest sequence number
+    Setpoint last = mailbox.read();
+    TEST_ASSERT_EQUAL_UINT32(PRODUCERS * PUBLISHES_PER_PRODUCER, last.seq);
+    TEST_ASSERT_EQUAL_UINT32(PRODUCERS * PUBLISHES_PER_PRODUCER, mailbox.getLatestSeq());
+}
+
+int main(int argc, char** argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_empty_mailbox_reads_idle);
+    RUN_TEST(test_latest_publish_wins);
+    RUN_TEST(test_concurrent_producers_never_tear_a_read);
+    return UNITY_END();
+}
@@ -0,0 +1,147 @@
+#include <unity.h>
+#include <Arduino.h>
+#include "config.h"
+#include "drive/MotorMapping.h"
+#include "utils/PolynomialFit.h"
+
+// Four mismatched wheel/direction curves: deadzone, gain and bend all differ, as on the car
+struct MotorCurve {
+    float deadzone;  // PWM
+    float gain;      // cm/s per PWM just past the deadzone
+};
+
+static const MotorCurve CURVES[MOTOR_MAPPING_COUNT] = {
+    {50.0f, 0.500f},  // left forward
+    {54.0f, 0.480f},  // left reverse
+    {52.0f, 0.485f},  // right forward
+    {57.0f, 0.470f},  // right reverse
+};
+
+static float steadySpeed(MotorMapping mapping, float pwm) {
+    const MotorCurve& curve = CURVES[(int)mapping];
+    float driven = fmaxf(pwm - curve.deadzone, 0.0f);
+    return curve.gain * driven - 5e-4f * curve.gain * driven * driven;
+}
+
+static constexpr float DT = 0.002f;
+static constexpr float TAU = 0.08f;
+static constexpr int STEPS = 20;
+
+struct Sweep {
+    float pwm[STEPS];
+    float velocity[STEPS];
+};
+
+static uint32_t noiseState;
+
+static float noise(float amplitude) {
+    noiseState = noiseState * 1664525u + 1013904223u;
+    return ((noiseState >> 8) / 16777216.0f * 2.0f - 1.0f) * amplitude;
+}
+
+// The calibration sweep: hold each PWM step, record the settled speed with a little measurement noise
+static Sweep sweep(MotorMapping mapping) {
+    Sweep result;
+    for (int i = 0; i < STEPS; i++) {
+        result.pwm[i] = 70.0f + i * 9.0f;
+        result.velocity[i] = steadySpeed(mapping, result.pwm[i]) + noise(0.2f);
+    }
+    return result;
+}
+
+// Velocity->PWM feedforward, as the calibration command fits it
+static Polynomial fitFeedforward(const float* velocity, const float* pwm, int n) {
+    PolynomialFit::Result result = PolynomialFit::fit(velocity, pwm, n, 3);
+    TEST_ASSERT_TRUE(result.ok);
+    return Polynomial(result.coefficients, result.degree);
+}
+
+struct Drift {
+    float heading;  // rad
+    float lateral;  // cm, off the commanded line
+};
+
+/**
+ * Open-loop run along a straight line: each wheel gets its feedforward PWM, lags to its own steady speed,
+ * and the unicycle pose integrates the difference
+ */
+static Drift driveStraight(const Polynomial* maps, float speed, float seconds) {
+    bool reverse = speed < 0;
+    MotorMapping leftMapping = motorMappingFor(true, reverse);
+    MotorMapping rightMapping = motorMappingFor(false, reverse);
+    float leftPWM = constrain(maps[(int)leftMapping].evaluate(fabsf(speed)), 0.0f, 255.0f);
+    float rightPWM = constrain(maps[(int)rightMapping].evaluate(fabsf(speed)), 0.0f, 255.0f);
+    float sign = reverse ? -1.0f : 1.0f;
+
+    float leftVelocity = 0;
+    float rightVelocity = 0;
+    float heading = 0;
+    float lateral = 0;
+    for (int i = 0; i < (int)(seconds / DT); i++) {
+        leftVelocity += (sign * steadySpeed(leftMapping, leftPWM) - leftVelocity) * DT / TAU;
+        rightVelocity += (sign * steadySpeed(rightMapping, rightPWM) - rightVelocity) * DT / TAU;
+        float linear = (leftVelocity + rightVelocity) / 2;
+        heading += (rightVelocity - leftVelocity) / TRACK_WIDTH * DT;
+        lateral += linear * sinf(heading) * DT;
+    }
+    return {heading, lateral};
+}
+
+static Sweep sweeps[MOTOR_MAPPING_COUNT];
+static Polynomial perMapping[MOTOR_MAPPING_COUNT];
+static Polynomial shared[MOTOR_MAPPING_COUNT];
+
+void setUp() {
+    noiseState = 77;
+    for (int i = 0; i < MOTOR_MAPPING_COUNT; i++) {
+        sweeps[i] = sweep((MotorMapping)i);
+        perMapping[i] = fitFeedforward(sweeps[i].velocity, sweeps[i].pwm, STEPS);
+    }
+
+    // The old calibration: a forward sweep on both wheels at once, fitted on the averaged wheel speed,
+    // then mirrored onto every wheel and direction
+    float averaged[STEPS];
+    for (int i = 0; i < STEPS; i++) {
+        averaged[i] = (sweeps[(int)MotorMapping::LeftForward].velocity[i] + sweeps[(int)MotorMapping::RightForward].velocity[i]) / 2;
+    }
+    Polynomial common = fitFeedforward(averaged, sweeps[(int)MotorMapping::LeftForward].pwm, STEPS);
+    for (int i = 0; i < MOTOR_MAPPING_COUNT; i++) {
+        shared[i] = common;
+    }
+}
+
+void tearDown() {}
+
+void test_per_mapping_fits_drive_straighter() {
+    const float speeds[] = {15.0f, 30.0f, 45.0f, -15.0f, -30.0f, -45.0f};
+    for (float speed : speeds) {
+        Drift sharedDrift = driveStraight(shared, speed, 5.0f);
+        Drift mappedDrift = driveStraight(perMapping, speed, 5.0f);
+
+        char message[128];
+        snprintf(message, sizeof(message), "%+.0f cm/s for 5 s: heading %.1f deg / lateral %.1f cm shared, %.1f deg / %.1f cm per mapping",
+                 speed, sharedDrift.heading * RAD_TO_DEG, sharedDrift.lateral,
+                 mappedDrift.heading * RAD_TO_DEG, mappedDrift.lateral);
+        TEST_MESSAGE(message);
+
+        TEST_ASSERT_LESS_THAN(fabsf(sharedDrift.heading) / 3, fabsf(mappedDrift.heading));
+        TEST_ASSERT_LESS_THAN(3.0f, fabsf(mappedDrift.heading * RAD_TO_DEG));
+    }
+}
+
+void test_per_mapping_fit_hits_each_wheel_speed() {
+    // Feedforward alone lands each wheel/direction within 0.5 cm/s of its target across the range
+    for (int i = 0; i < MOTOR_MAPPING_COUNT; i++) {
+        for (float speed = 10.0f; speed <= 50.0f; speed += 5.0f) {
+            float pwm = perMapping[i].evaluate(speed);
+            TEST_ASSERT_FLOAT_WITHIN_MESSAGE(0.5f, speed, steadySpeed((MotorMapping)i, pwm), motorMappingName((MotorMapping)i));
+        }
+    }
+}
+
+int main(int argc, char** argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_per_mapping_fits_drive_straighter);
+    RUN_TEST(test_per_mapping_fit_hits_each_wheel_speed);
+    return UNITY_END();
+}
@@ -0,0 +1,93 @@
+#include <unity.h>
+#include "config.h"
+#include "utils/TemperatureBiasModel.h"
+
+// In °/s, as the tests read; the IMU runs the same model in raw gyro counts
+static const TemperatureBiasModel::Config CONFIG = {IMU_BIAS_FORGETTING, IMU_BIAS_SLOPE_PRIOR, IMU_BIAS_SLOPE_LIMIT};
+
+static uint32_t noiseState = 5;
+
+// Uniform in [-amplitude, amplitude]
+static float noise(float amplitude) {
+    noiseState = noiseState * 1664525u + 1013904223u;
+    return ((noiseState >> 8) / 16777216.0f * 2.0f - 1.0f) * amplitude;
+}
+
+void setUp() {
+    noiseState = 5;
+}
+
+void tearDown() {}
+
+void test_seed_predicts_along_its_slope() {
+    TemperatureBiasModel model(CONFIG);
+    model.reset(0.8f, 30.0f, 0.02f);
+    TEST_ASSERT_FLOAT_WITHIN(1e-6f, 0.8f, model.predict(30.0f));
+    TEST_ASSERT_FLOAT_WITHIN(1e-5f, 0.9f, model.predict(35.0f));
+    TEST_ASSERT_FLOAT_WITHIN(1e-6f, 1.0f, model.getObservations());
+}
+
+void test_one_temperature_moves_only_the_offset() {
+    // A still car at a steady temperature says nothing about the slope
+    TemperatureBiasModel model(CONFIG);
+    model.reset(0.8f, 30.0f, 0.02f);
+    for (int i = 0; i < 500; i++) {
+        model.observe(30.0f + noise(0.05f), 0.5f + noise(0.02f));
+    }
+    TEST_ASSERT_FLOAT_WITHIN(0.005f, 0.5f, model.predict(30.0f));
+    TEST_ASSERT_FLOAT_WITHIN(0.002f, 0.02f, model.getSlope());
+}
+
+void test_warm_up_ramp_learns_the_slope() {
+    // Bias 0.4 °/s at 25 °C rising 0.03 °/s per °C while the die warms to 45 °C
+    TemperatureBiasModel model(CONFIG);
+    model.reset(0.4f, 25.0f, 0);
+    for (int i = 0; i < 400; i++) {
+        float temperature = 25.0f + 20.0f * i / 400;
+        model.observe(temperature + noise(0.1f), 0.4f + 0.03f * (temperature - 25.0f) + noise(0.02f));
+    }
+
+    char message[96];
+    snprintf(message, sizeof(message), "slope %.4f °/s/°C (true 0.0300), bias at 50 °C %.3f (true 1.150)", model.getSlope(), model.predict(50.0f));
+    TEST_MESSAGE(message);
+    TEST_ASSERT_FLOAT_WITHIN(0.003f, 0.03f, model.getSlope());
+    TEST_ASSERT_FLOAT_WITHIN(0.05f, 1.15f, model.predict(50.0f));
+}
+
+void test_old_observations_fade() {
+    // After a remount the bias jumps; forgetting lets the new value take over within a few time constants
+    TemperatureBiasModel model(CONFIG);
+    model.reset(0.4f, 30.0f, 0);
+    for (int i = 0; i < 2000; i++) model.observe(30.0f, 0.4f);
+    int windows = 0;
+    while (fabsf(model.predict(30.0f) - 0.7f) > 0.03f && windows < 10000) {
+        model.observe(30.0f, 0.7f);
+        windows++;
+    }
+
+    // 90% of the step takes ln(10) / (1 - forgetting) windows
+    float expected = logf(10.0f) / (1.0f - IMU_BIAS_FORGETTING);
+    TEST_ASSERT_FLOAT_WITHIN(0.1f * expected, expected, windows);
+}
+
+void test_slope_is_clamped() {
+    TemperatureBiasModel model(CONFIG);
+    model.reset(0, 20.0f, 10.0f);
+    TEST_ASSERT_FLOAT_WITHIN(1e-6f, IMU_BIAS_SLOPE_LIMIT, model.getSlope());
+
+    for (int i = 0; i < 400; i++) {
+        float temperature = 20.0f + 30.0f * i / 400;
+        model.observe(temperature, -1.0f * (temperature - 20.0f));
+    }
+    TEST_ASSERT_FLOAT_WITHIN(1e-6f, -IMU_BIAS_SLOPE_LIMIT, model.getSlope());
+}
+
+int main(int argc, char** argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_seed_predicts_along_its_slope);
+    RUN_TEST(test_one_temperature_moves_only_the_offset);
+    RUN_TEST(test_warm_up_ramp_learns_the_slope);
+    RUN_TEST(test_old_observations_fade);
+    RUN_TEST(test_slope_is_clamped);
+    return UNITY_END();
+}
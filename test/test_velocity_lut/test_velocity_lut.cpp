@@ -0,0 +1,121 @@
+#include <unity.h>
+#include <Arduino.h>
+#include <chrono>
+#include "config.h"
+#include "utils/Polynomial.h"
+#include "utils/LookupTable.h"
+
+// Velocity->PWM fits of the shape the calibration sweep produces: deadzone offset, bending over towards saturation
+static const float CUBIC[] = {55.0f, 2.2f, -0.01f, 0.0001f};
+static const float QUINTIC[] = {52.0f, 2.6f, -0.025f, 2.0e-4f, -1.0e-6f, 2.5e-9f};
+
+static constexpr int SAMPLES = 4096;
+static constexpr int REPEATS = 500;
+static float velocities[SAMPLES];
+
+static float clampedPWM(const Polynomial& poly, float velocity) {
+    return constrain(poly.evaluate(velocity), 0.0f, 255.0f);
+}
+
+// Built the way VelocityController builds its tables
+static LookupTable buildTable(const Polynomial& poly) {
+    LookupTable table;
+    table.build([&poly](float velocity) { return clampedPWM(poly, velocity); }, 0.0f, VELOCITY_LUT_MAX);
+    return table;
+}
+
+template<typename Fn>
+static double nsPerCall(Fn fn) {
+    volatile float sink = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (int r = 0; r < REPEATS; r++) {
+        for (int i = 0; i < SAMPLES; i++) {
+            sink = fn(velocities[i]);
+        }
+    }
+    auto elapsed = std::chrono::steady_clock::now() - start;
+    (void)sink;
+    return std::chrono::duration<double, std::nano>(elapsed).count() / ((double)REPEATS * SAMPLES);
+}
+
+void setUp() {
+    // Spread over the table in a scrambled order so neither path benefits from a predictable sequence
+    uint32_t state = 12345;
+    for (int i = 0; i < SAMPLES; i++) {
+        state = state * 1664525u + 1013904223u;
+        velocities[i] = (state >> 8) * (VELOCITY_LUT_MAX / 16777216.0f);
+    }
+}
+
+void tearDown() {}
+
+static void checkAccuracy(const char* name, const float* coeffs, int degree) {
+    Polynomial poly(coeffs, degree);
+    LookupTable table = buildTable(poly);
+
+    float maxError = 0;
+    float maxRoundTrip = 0;
+    for (float v = 0; v <= VELOCITY_LUT_MAX; v += 0.001f) {
+        float pwm = table.evaluate(v);
+        maxError = fmaxf(maxError, fabsf(pwm - clampedPWM(poly, v)));
+        if (pwm < 255.0f) maxRoundTrip = fmaxf(maxRoundTrip, fabsf(table.inverse(pwm) - v));
+    }
+
+    char message[128];
+    snprintf(message, sizeof(message), "%s: LUT vs Horner max error %.4f PWM, inverse round trip %.5f cm/s, %d monotonic fixes",
+             name, maxError, maxRoundTrip, table.getMonotonicFixes());
+    TEST_MESSAGE(message);
+    TEST_ASSERT_LESS_THAN(0.5f, maxError);
+    TEST_ASSERT_LESS_THAN(1e-3f, maxRoundTrip);
+}
+
+void test_cubic_accuracy() {
+    checkAccuracy("cubic", CUBIC, 3);
+}
+
+void test_quintic_accuracy() {
+    checkAccuracy("quintic", QUINTIC, 5);
+}
+
+void test_both_paths_hold_at_table_end() {
+    // VelocityController clamps the Horner input to VELOCITY_LUT_MAX; the table holds its last sample
+    Polynomial poly(QUINTIC, 5);
+    LookupTable table = buildTable(poly);
+    float atEnd = clampedPWM(poly, VELOCITY_LUT_MAX);
+    for (float v = VELOCITY_LUT_MAX; v <= 3 * VELOCITY_LUT_MAX; v += 10.0f) {
+        TEST_ASSERT_FLOAT_WITHIN(1e-3f, atEnd, table.evaluate(v));
+        TEST_ASSERT_FLOAT_WITHIN(1e-3f, atEnd, clampedPWM(poly, fminf(v, VELOCITY_LUT_MAX)));
+    }
+    TEST_ASSERT_EQUAL_FLOAT(VELOCITY_LUT_MAX, table.inverse(300.0f));
+}
+
+void test_lut_vs_horner_benchmark() {
+    Polynomial cubic(CUBIC, 3);
+    Polynomial quintic(QUINTIC, 5);
+    LookupTable cubicTable = buildTable(cubic);
+    LookupTable quinticTable = buildTable(quintic);
+
+    double hornerCubic = nsPerCall([&](float v) { return cubic.evaluate(v); });
+    double hornerQuintic = nsPerCall([&](float v) { return quintic.evaluate(v); });
+    double lutCubic = nsPerCall([&](float v) { return cubicTable.evaluate(v); });
+    double lutQuintic = nsPerCall([&](float v) { return quinticTable.evaluate(v); });
+    double inverse = nsPerCall([&](float pwm) { return cubicTable.inverse(pwm * 2.5f); });
+
+    char message[160];
+    snprintf(message, sizeof(message),
+             "ns per call: Horner cubic %.2f, quintic %.2f; LUT cubic %.2f, quintic %.2f; LUT inverse %.2f",
+             hornerCubic, hornerQuintic, lutCubic, lutQuintic, inverse);
+    TEST_MESSAGE(message);
+
+    // The table costs the same whatever the degree
+    TEST_ASSERT_LESS_THAN(2.0 * lutCubic + 1.0, lutQuintic);
+}
+
+int main(int argc, char** argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_cubic_accuracy);
+    RUN_TEST(test_quintic_accuracy);
+    RUN_TEST(test_both_paths_hold_at_table_end);
+    RUN_TEST(test_lut_vs_horner_benchmark);
+    return UNITY_END();
+}